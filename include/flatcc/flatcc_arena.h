@@ -0,0 +1,141 @@
+#ifndef FLATCC_ARENA_H
+#define FLATCC_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Arena allocator for the builder and the default emitter.
+ *
+ * The default builder allocator calls realloc for each of its stacks
+ * as they grow, and the default emitter allocates and frees pages with
+ * malloc and free. The arena instead carves all stacks and pages from
+ * one contiguous region, or a short chain of regions, so a builder
+ * that is reused for many buffers does not touch the system allocator
+ * once warm, and its working state is kept close together in memory.
+ *
+ * Blocks come in power of 2 size classes. Blocks released when a stack
+ * grows, or when a page is freed, go to a free list for their class
+ * and are reused before new space is taken from the region. Nothing is
+ * returned to the system before `flatcc_arena_clear`.
+ *
+ * `flatcc_arena_reset` releases all blocks in O(1) time by rewinding
+ * the region. It must only be called when no builder or emitter uses
+ * the arena, i.e. after `flatcc_builder_clear`. For per message reuse,
+ * it is usually better to keep the builder and call
+ * `flatcc_builder_reset` since the stacks then remain allocated.
+ *
+ * Example:
+ *
+ *     static uint8_t mem[65536];
+ *     flatcc_arena_t arena;
+ *     flatcc_builder_t builder, *B = &builder;
+ *
+ *     flatcc_arena_init(&arena, mem, sizeof(mem));
+ *     flatcc_builder_custom_init(B, 0, 0, flatcc_arena_alloc, &arena);
+ *     flatcc_emitter_set_alloc(flatcc_builder_get_emit_context(B),
+ *             flatcc_arena_emitter_alloc, &arena);
+ *
+ * Emitter pages include a small header, so a page size of
+ * 4096 - 128 bytes fits the 4096 byte size class better than the
+ * default page size. The arena is not thread safe.
+ */
+
+#include <stdlib.h>
+
+#include "flatcc/flatcc_types.h"
+#include "flatcc/flatcc_iov.h"
+
+/* The smallest block size is `1 << FLATCC_ARENA_MIN_CLASS_SHIFT`. */
+#ifndef FLATCC_ARENA_MIN_CLASS_SHIFT
+#define FLATCC_ARENA_MIN_CLASS_SHIFT 6
+#endif
+
+/* Enough classes for any buffer the builder can produce. */
+#ifndef FLATCC_ARENA_CLASS_COUNT
+#define FLATCC_ARENA_CLASS_COUNT 32
+#endif
+
+/* Minimum size of regions allocated when the arena runs out of space. */
+#ifndef FLATCC_ARENA_REGION_SIZE
+#define FLATCC_ARENA_REGION_SIZE 65536
+#endif
+
+typedef struct flatcc_arena_region flatcc_arena_region_t;
+typedef struct flatcc_arena flatcc_arena_t;
+
+struct flatcc_arena_region {
+    flatcc_arena_region_t *next;
+    uint8_t *base;
+    uint8_t *end;
+    /* Set if the region memory was allocated by the arena. */
+    int is_owned;
+};
+
+struct flatcc_arena {
+    /* The region currently being carved, and its free space. */
+    flatcc_arena_region_t *region;
+    uint8_t *cursor;
+    /* All regions, the first one possibly user provided. */
+    flatcc_arena_region_t *regions;
+    void *free_list[FLATCC_ARENA_CLASS_COUNT];
+    /* Bytes in all regions. */
+    size_t capacity;
+    /* If non-zero, no more than this number of bytes is ever allocated in regions. */
+    size_t limit;
+    /* The first region when user provided. */
+    flatcc_arena_region_t first;
+};
+
+/*
+ * Initializes the arena with an optional user provided memory block
+ * that must remain valid until the arena is cleared. If `mem` is null
+ * and `size` is non-zero, a region of `size` bytes is allocated now.
+ * More regions are allocated when the arena runs out of space unless a
+ * limit is set with `flatcc_arena_set_limit`.
+ *
+ * Returns 0 on success, -1 on allocation failure.
+ */
+int flatcc_arena_init(flatcc_arena_t *A, void *mem, size_t size);
+
+/*
+ * Limits the total size of all regions. With a user provided memory
+ * block, a limit of the same size (or 1) prevents any allocation
+ * outside that block. 0 means no limit.
+ */
+static inline void flatcc_arena_set_limit(flatcc_arena_t *A, size_t limit)
+{
+    A->limit = limit;
+}
+
+/*
+ * Releases all blocks in O(1) time, keeping all regions for reuse.
+ * No block previously handed out may be used afterwards.
+ */
+void flatcc_arena_reset(flatcc_arena_t *A);
+
+/* Frees all regions allocated by the arena. */
+void flatcc_arena_clear(flatcc_arena_t *A);
+
+/*
+ * Builder allocator compatible with `flatcc_builder_alloc_fun` for
+ * use with `flatcc_builder_custom_init` where `alloc_context` is the
+ * arena. Buffers never shrink, so `reduce_buffers` on reset has no
+ * effect.
+ */
+int flatcc_arena_alloc(void *alloc_context, flatcc_iovec_t *b,
+        size_t request, int zero_fill, int alloc_type);
+
+/*
+ * Emitter page allocator compatible with `flatcc_emitter_alloc_fun`
+ * for use with `flatcc_emitter_set_alloc` where `alloc_context` is
+ * the arena.
+ */
+int flatcc_arena_emitter_alloc(void *alloc_context, flatcc_iovec_t *b, size_t request);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLATCC_ARENA_H */
@@ -0,0 +1,98 @@
+/*
+ * Verifies buffers using a binary schema (.bfbs) loaded at runtime
+ * instead of generated verifier code.
+ *
+ * The binary schema is compiled once into the same type tables as
+ * generated `<table>_table_verifier_type` functions return, and buffers
+ * are then verified with the iterative verifier, see
+ * `flatcc_verify_table_as_root_iterative`. The schema buffer is not
+ * referenced after compilation and may be freed.
+ *
+ * A compiled schema is read only and can be used by any number of
+ * threads at the same time.
+ *
+ * Example:
+ *
+ *     flatcc_bfbs_verifier_t V;
+ *
+ *     if (flatcc_bfbs_verifier_init(&V, bfbs, bfbs_size)) {
+ *         ... invalid or unsupported schema ...
+ *     }
+ *     ... for each buffer:
+ *     ret = flatcc_bfbs_verify_as_root(&V, buf, bufsiz, 0);
+ *     ret = flatcc_bfbs_verify_as_root(&V, buf, bufsiz, "MyGame.Example.Monster");
+ *     ...
+ *     flatcc_bfbs_verifier_clear(&V);
+ */
+
+#ifndef FLATCC_BFBS_VERIFIER_H
+#define FLATCC_BFBS_VERIFIER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "flatcc/flatcc_verifier.h"
+
+typedef struct flatcc_bfbs_verifier flatcc_bfbs_verifier_t;
+
+/* All fields are private. */
+struct flatcc_bfbs_verifier {
+    /* Indexed by schema object and enum index. */
+    flatcc_verifier_table_type_t *table_types;
+    flatcc_verifier_union_type_t *union_types;
+    flatcc_verifier_field_t *fields;
+    flatcc_verifier_union_member_t *members;
+    /* Zero terminated object names, sorted as in the schema. */
+    char *names;
+    size_t *name_offsets;
+    size_t object_count;
+    /* -1 if the schema has no root type. */
+    int root_index;
+    /* Zero terminated, and empty if the schema has no identifier. */
+    char fid[FLATBUFFERS_IDENTIFIER_SIZE + 1];
+};
+
+/*
+ * Verifies and compiles the binary schema `bfbs` of `size` bytes.
+ *
+ * Returns 0 on success, and -1 on allocation failure, or if the schema
+ * is invalid or uses types that buffers cannot contain. `V` need not be
+ * cleared after failure.
+ */
+int flatcc_bfbs_verifier_init(flatcc_bfbs_verifier_t *V, const void *bfbs, size_t size);
+
+/* Releases all memory. */
+void flatcc_bfbs_verifier_clear(flatcc_bfbs_verifier_t *V);
+
+/*
+ * Returns the type of the table with the fully qualified `name`, e.g.
+ * "MyGame.Example.Monster", or the schema root type if `name` is null.
+ * Returns null if there is no such table.
+ *
+ * The result can be used with the `flatcc_verify_table_as_root_*`
+ * functions taking a `flatcc_verifier_table_type_t`, for example to
+ * verify with a memo or in parallel.
+ */
+const flatcc_verifier_table_type_t *flatcc_bfbs_verifier_table_type(
+        const flatcc_bfbs_verifier_t *V, const char *name);
+
+/*
+ * Verifies a buffer with a root table of type `name`, or the schema
+ * root type if `name` is null. The buffer identifier is checked against
+ * the schema file identifier, if any.
+ *
+ * Returns `flatcc_verify_error_runtime_schema_type_not_found` if there
+ * is no such table, otherwise as `flatcc_verify_table_as_root_iterative`.
+ */
+int flatcc_bfbs_verify_as_root(const flatcc_bfbs_verifier_t *V,
+        const void *buf, size_t bufsiz, const char *name);
+
+int flatcc_bfbs_verify_as_root_with_size(const flatcc_bfbs_verifier_t *V,
+        const void *buf, size_t bufsiz, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLATCC_BFBS_VERIFIER_H */
@@ -61,6 +61,7 @@ extern "C" {
  */
 
 #include <stdlib.h>
+#include <stddef.h>
 #ifndef UINT8_MAX
 #include <stdint.h>
 #endif
@@ -68,6 +69,7 @@ extern "C" {
 #include "flatcc_flatbuffers.h"
 #include "flatcc_emitter.h"
 #include "flatcc_refmap.h"
+#include "flatcc_vtable_dict.h"
 
 /* It is possible to enable logging here. */
 #ifndef FLATCC_BUILDER_ASSERT
@@ -179,6 +181,8 @@ enum flatcc_builder_alloc_type {
     flatcc_builder_alloc_vd,
     /* User stack frame for custom data. */
     flatcc_builder_alloc_us,
+    /* Where vtables from a shared vtable dictionary were emitted. */
+    flatcc_builder_alloc_vr,
 
     /* Number of allocation buffers. */
     flatcc_builder_alloc_buffer_count
@@ -403,6 +407,8 @@ struct flatcc_builder {
     flatbuffers_uoffset_t vb_end;
     /* Where to allocate next vtable descriptor for hash table. */
     flatbuffers_uoffset_t vd_end;
+    /* Incremented when the vtable cache is flushed, used by checkpoints. */
+    flatbuffers_uoffset_t vb_flush_count;
     /* Ensure final buffer is aligned to at least this. Nested buffers get their own `min_align`. */
     uint16_t min_align;
     /* The current active objects alignment isolated from nested activity. */
@@ -437,6 +443,10 @@ struct flatcc_builder {
     int max_level;
     /* If non-zero, do not cluster vtables at end, only emit negative offsets (0 by default). */
     int disable_vt_clustering;
+    /* If non-zero, reset keeps the vtable cache for the next buffer (0 by default). */
+    int retain_vtable_cache;
+    /* Optional frozen vtable dictionary consulted on vtable cache misses. */
+    const flatcc_vtable_dict_t *vt_dict;
 
     /* Set if the default emitter is being used. */
     int is_default_emitter;
@@ -534,6 +544,37 @@ int flatcc_builder_default_alloc(void *alloc_context,
  */
 void flatcc_builder_set_vtable_cache_limit(flatcc_builder_t *B, size_t size);
 
+/**
+ * If non-zero, `flatcc_builder_reset` and `flatcc_builder_custom_reset`
+ * keep the vtable cache instead of clearing it, unless buffers are
+ * being reduced. Vtables must still be emitted once per buffer, but a
+ * vtable already seen in an earlier buffer is found by hash lookup and
+ * needs no new cache entry. This helps builders that are reused for
+ * many similar buffers. The cache grows with the number of distinct
+ * vtables, so consider `flatcc_builder_set_vtable_cache_limit` as
+ * well. Cleared by reset when `set_defaults` is set.
+ */
+void flatcc_builder_set_vtable_cache_retention(flatcc_builder_t *B, int enable);
+
+/**
+ * Attaches a frozen vtable dictionary, or detaches with null. The
+ * dictionary is searched when a vtable is not in the vtable cache, and
+ * vtables found are emitted from the dictionary and then cached as
+ * usual. Only the top level buffer uses the dictionary,
+ * nested buffers always use the vtable cache. Must not be called while
+ * a buffer is being built. The dictionary must stay valid until
+ * detached or the builder is cleared. See also `flatcc_vtable_dict.h`.
+ *
+ * Returns -1 if the dictionary is not frozen, 0 on success.
+ */
+int flatcc_builder_set_vtable_dict(flatcc_builder_t *B, const flatcc_vtable_dict_t *D);
+
+/**
+ * Adds all vtables in the vtable cache to a dictionary that is not
+ * yet frozen. Returns 0 on success, -1 on failure.
+ */
+int flatcc_builder_export_vtable_cache(flatcc_builder_t *B, flatcc_vtable_dict_t *D);
+
 /**
  * Manual flushing of vtable for long running tasks. Mostly used
  * internally to deal with nested buffers.
@@ -597,6 +638,53 @@ int flatcc_builder_get_level(flatcc_builder_t *B);
  */
 void flatcc_builder_set_max_level(flatcc_builder_t *B, int level);
 
+/* All fields are private. */
+typedef struct flatcc_builder_checkpoint flatcc_builder_checkpoint_t;
+struct flatcc_builder_checkpoint {
+    flatcc_builder_ref_t emit_start;
+    flatcc_builder_ref_t emit_end;
+    flatbuffers_uoffset_t ds_offset;
+    flatbuffers_uoffset_t pl_offset;
+    flatbuffers_uoffset_t vector_count;
+    flatbuffers_uoffset_t vb_end;
+    flatbuffers_uoffset_t vd_end;
+    flatbuffers_uoffset_t vb_flush_count;
+    flatbuffers_uoffset_t nest_id;
+    uint32_t vt_hash;
+    flatbuffers_voffset_t id_end;
+    uint16_t align;
+    uint16_t min_align;
+    int level;
+    int type;
+};
+
+/**
+ * Records the builder state so objects created afterwards can be
+ * discarded with `flatcc_builder_rollback`, for example when a record
+ * turns out to be invalid halfway through encoding. The checkpoint
+ * covers the emitted data, the current frame content such as table
+ * fields or vector elements, and the vtable cache.
+ */
+void flatcc_builder_checkpoint(flatcc_builder_t *B, flatcc_builder_checkpoint_t *cp);
+
+/**
+ * Discards everything created since the checkpoint. All frames started
+ * after the checkpoint must have been ended, and the frame that was
+ * open at the checkpoint, if any, must still be open. References
+ * returned after the checkpoint become invalid, and a refmap is reset
+ * since it may hold such references. The work done is proportional to
+ * the discarded content and the size of the vtable cache, not to the
+ * content built before the checkpoint.
+ *
+ * Content that has been emitted after the checkpoint can only be
+ * discarded with the default emitter, and not if it has been flushed
+ * while streaming.
+ *
+ * Returns -1 on failure, leaving the builder unchanged, or 0 on
+ * success. The same checkpoint can be used for several rollbacks.
+ */
+int flatcc_builder_rollback(flatcc_builder_t *B, const flatcc_builder_checkpoint_t *cp);
+
 /**
  * By default ordinary data such as tables are placed in front of
  * earlier produced content and vtables are placed at the very end thus
@@ -1198,6 +1286,67 @@ flatcc_builder_ref_t flatcc_builder_create_table(flatcc_builder_t *B,
         flatbuffers_voffset_t *offsets, int offset_count,
         flatcc_builder_vt_ref_t vt_ref);
 
+typedef uint8_t flatcc_builder_row_flags_t;
+/* The field holds a `flatcc_builder_ref_t` rather than a scalar. */
+static const flatcc_builder_row_flags_t flatcc_builder_row_is_offset = 1;
+static const flatcc_builder_row_flags_t flatcc_builder_row_is_required = 2;
+
+typedef struct flatcc_builder_row_field flatcc_builder_row_field_t;
+typedef struct flatcc_builder_row_layout flatcc_builder_row_layout_t;
+
+struct flatcc_builder_row_field {
+    /* Offset of the field value in the row struct. */
+    uint32_t row_offset;
+    flatbuffers_voffset_t id;
+    /* 1, 2, 4, or 8 bytes, native endian. */
+    uint8_t size;
+    flatcc_builder_row_flags_t flags;
+};
+
+struct flatcc_builder_row_layout {
+    /* Must be ordered by decreasing size. */
+    const flatcc_builder_row_field_t *fields;
+    int field_count;
+    /* Largest field id + 1. */
+    int id_count;
+    size_t row_size;
+};
+
+/* Number of presence words per row. */
+#define flatcc_builder_row_present_words(id_count) (((size_t)(id_count) + 31) / 32)
+
+/* Marks field `id` present in the presence bitmap of a single row. */
+static inline void flatcc_builder_row_set_present(uint32_t *present, flatbuffers_voffset_t id)
+{
+    present[id / 32] |= (uint32_t)1 << (id % 32);
+}
+
+/**
+ * Creates an offset vector of `count` tables in one call, one table
+ * for each row in `rows`. Normally use the generated
+ * `<table>_vec_create_rows` call which provides the row struct and
+ * the layout.
+ *
+ * Each row is a C struct with a native endian scalar or a
+ * `flatcc_builder_ref_t` value for each field listed in `layout`.
+ * `present` holds `flatcc_builder_row_present_words(layout->id_count)`
+ * uint32_t words per row, where bit `id % 32` of word `id / 32` is set
+ * when field `id` is stored. Present fields are stored even if they
+ * hold the default value. If `present` is null, all fields are stored
+ * in all rows.
+ *
+ * Fields are packed by decreasing size, and the vtable is only looked
+ * up when the presence bits differ from the previous row, so bulk
+ * data with few distinct shapes avoids nearly all per table
+ * bookkeeping of `start_table` and `end_table`.
+ *
+ * Returns 0 on error, including a missing required field or a null
+ * reference in a present offset field.
+ */
+flatcc_builder_ref_t flatcc_builder_create_table_vector(flatcc_builder_t *B,
+        const flatcc_builder_row_layout_t *layout, const void *rows,
+        const uint32_t *present, size_t count);
+
 /**
  * Starts a table, typically following a start_buffer call as an
  * alternative to starting a struct, or to create table fields to be
@@ -1904,6 +2053,15 @@ void flatcc_builder_free(void *p);
  */
 void *flatcc_builder_copy_buffer(flatcc_builder_t *B, void *buffer, size_t size);
 
+/*
+ * Only for use with the default emitter.
+ *
+ * Fills `iov` with up to `iov_max` segments that together hold the
+ * buffer without copying it, and returns the number of segments needed,
+ * or 0 if the emitter is not default. See `flatcc_emitter_get_iov`.
+ */
+int flatcc_builder_get_buffer_iov(flatcc_builder_t *B, flatcc_iovec_t *iov, int iov_max);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,134 @@
+#ifndef FLATCC_BUILDER_POOL_H
+#define FLATCC_BUILDER_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Pool of builders for servers that build many buffers from several
+ * threads.
+ *
+ * A builder is cheap to reset but expensive to create: its stacks,
+ * emitter pages and vtable cache are all allocated on demand and must
+ * be grown again after `flatcc_builder_clear`. The pool hands out
+ * builders that have already been used, per request or for the lifetime
+ * of a thread, and takes them back with `flatcc_builder_reset` so the
+ * memory stays allocated. Pooled builders also retain their vtable
+ * cache across buffers (see `flatcc_builder_set_vtable_cache_retention`)
+ * up to a size limit.
+ *
+ * The most recently released builder is handed out first, so a thread
+ * that acquires and releases in a loop usually gets the same builder
+ * back while it is still in the CPU cache.
+ *
+ * Memory is trimmed adaptively:
+ *
+ * - A builder that holds more than `trim_size` bytes when released has
+ *   its buffers reduced (and its vtable cache cleared) so a single
+ *   large buffer does not pin memory in the pool.
+ * - No more than `max_idle` builders are kept idle, others are cleared.
+ * - `flatcc_builder_pool_trim` clears idle builders that were not
+ *   needed since the last trim. Call it periodically, or when memory is
+ *   low.
+ *
+ * The pool is thread safe when FLATCC_USE_THREADS is enabled (the
+ * default), but each builder must only be used by one thread at a time.
+ * Pooled builders use the default emitter and allocator, and must not
+ * be cleared by the user.
+ *
+ * Example:
+ *
+ *     flatcc_builder_pool_t pool;
+ *
+ *     flatcc_builder_pool_init(&pool, 0, 0);
+ *     ...
+ *     flatcc_builder_t *B = flatcc_builder_pool_acquire(&pool);
+ *     ... build and finalize buffer ...
+ *     flatcc_builder_pool_release(&pool, B);
+ *     ...
+ *     flatcc_builder_pool_clear(&pool);
+ */
+
+#include <stdlib.h>
+
+#include "flatcc/flatcc_builder.h"
+
+/* Used when `max_idle` is 0. */
+#ifndef FLATCC_BUILDER_POOL_MAX_IDLE
+#define FLATCC_BUILDER_POOL_MAX_IDLE 64
+#endif
+
+/* Used when `trim_size` is 0. */
+#ifndef FLATCC_BUILDER_POOL_TRIM_SIZE
+#define FLATCC_BUILDER_POOL_TRIM_SIZE (1024 * 1024)
+#endif
+
+/* The vtable cache limit of pooled builders. */
+#ifndef FLATCC_BUILDER_POOL_VTABLE_CACHE_LIMIT
+#define FLATCC_BUILDER_POOL_VTABLE_CACHE_LIMIT 65536
+#endif
+
+typedef struct flatcc_builder_pool_entry flatcc_builder_pool_entry_t;
+typedef struct flatcc_builder_pool flatcc_builder_pool_t;
+
+struct flatcc_builder_pool_entry {
+    /* Must be first so a builder pointer is also an entry pointer. */
+    flatcc_builder_t builder;
+    flatcc_builder_pool_entry_t *next;
+};
+
+/* All fields are private. */
+struct flatcc_builder_pool {
+    /* Idle builders, most recently released first. */
+    flatcc_builder_pool_entry_t *idle;
+    /* Lock protecting the fields below, or null without threads. */
+    void *lock;
+    size_t idle_count;
+    size_t in_use;
+    /* Highest `in_use` since the last trim. */
+    size_t peak_in_use;
+    size_t max_idle;
+    size_t trim_size;
+};
+
+/*
+ * Initializes an empty pool. `max_idle` and `trim_size` may be 0 for
+ * defaults. Returns 0 on success, -1 on failure.
+ */
+int flatcc_builder_pool_init(flatcc_builder_pool_t *P, size_t max_idle, size_t trim_size);
+
+/*
+ * Returns a reset builder ready for a new buffer, or null if a new
+ * builder could not be allocated. The builder must be returned with
+ * `flatcc_builder_pool_release`.
+ */
+flatcc_builder_t *flatcc_builder_pool_acquire(flatcc_builder_pool_t *P);
+
+/*
+ * Resets the builder and returns it to the pool. Any buffer still held
+ * by the default emitter is discarded, so it must be copied or
+ * finalized first. Builder settings and the flush, page allocator and
+ * page size settings of the default emitter are restored to the pool
+ * defaults. Pages from a user page allocator are freed first.
+ */
+void flatcc_builder_pool_release(flatcc_builder_pool_t *P, flatcc_builder_t *B);
+
+/*
+ * Clears idle builders beyond the largest number that was in use at
+ * the same time since the last trim, then starts a new trim period.
+ * Returns the number of builders cleared.
+ */
+size_t flatcc_builder_pool_trim(flatcc_builder_pool_t *P);
+
+/*
+ * Clears all idle builders and releases the pool. All builders must
+ * have been released.
+ */
+void flatcc_builder_pool_clear(flatcc_builder_pool_t *P);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLATCC_BUILDER_POOL_H */
@@ -47,10 +47,17 @@ extern "C" {
  */
 
 /*
- * Memory is allocated in fixed length page units - the first page is
- * split between front and back so each get half the page size. If the
- * size is a multiple of 128 then each page offset will be a multiple of
- * 64, which may be useful for sequencing etc.
+ * Memory is allocated in page units - the first page is split between
+ * front and back so each get half the page size. If the size is a
+ * multiple of 128 then each page offset will be a multiple of 64, which
+ * may be useful for sequencing etc.
+ *
+ * `FLATCC_EMITTER_PAGE_SIZE` is the size of the first page and the
+ * minimum page size. Later pages are sized to the current total
+ * capacity so capacity grows geometrically, but pages never exceed
+ * `FLATCC_EMITTER_PAGE_SIZE_LIMIT`. Setting the limit equal to the
+ * page size gives fixed size pages. Both can also be set at runtime
+ * with `flatcc_emitter_set_page_size`.
  */
 #ifndef FLATCC_EMITTER_PAGE_SIZE
 #define FLATCC_EMITTER_MAX_PAGE_SIZE 3000
@@ -59,6 +66,14 @@ extern "C" {
     ~(2 * (FLATCC_EMITTER_PAGE_MULTIPLE) - 1))
 #endif
 
+#ifndef FLATCC_EMITTER_PAGE_MULTIPLE
+#define FLATCC_EMITTER_PAGE_MULTIPLE 64
+#endif
+
+#ifndef FLATCC_EMITTER_PAGE_SIZE_LIMIT
+#define FLATCC_EMITTER_PAGE_SIZE_LIMIT (1024 * 1024)
+#endif
+
 #ifndef FLATCC_EMITTER_ALLOC
 #ifdef FLATCC_EMITTER_USE_ALIGNED_ALLOC
 /*
@@ -83,8 +98,28 @@ extern "C" {
 typedef struct flatcc_emitter_page flatcc_emitter_page_t;
 typedef struct flatcc_emitter flatcc_emitter_t;
 
+/*
+ * Receives completed buffer content when streaming, see
+ * `flatcc_emitter_set_flush`. `offset` is the position of `data` in
+ * the builders virtual address space where the final buffer starts at
+ * the lowest offset flushed. Returns 0 on success, and otherwise
+ * causes the emitter, and thus the builder, to fail.
+ */
+typedef int flatcc_emitter_flush_fun(void *flush_context,
+        const void *data, size_t len, flatbuffers_soffset_t offset);
+
+/*
+ * Optional page allocator, see `flatcc_emitter_set_alloc`. Allocates
+ * a new block of at least `request` bytes into `b`, or frees `b` if
+ * `request` is 0. `b->iov_len` is the size actually provided. Returns
+ * 0 on success and -1 on failure.
+ */
+typedef int flatcc_emitter_alloc_fun(void *alloc_context,
+        flatcc_iovec_t *b, size_t request);
+
 struct flatcc_emitter_page {
-    uint8_t page[FLATCC_EMITTER_PAGE_SIZE];
+    /* Page content, also the start of the page allocation. */
+    uint8_t *page;
     flatcc_emitter_page_t *next;
     flatcc_emitter_page_t *prev;
     /*
@@ -93,6 +128,8 @@ struct flatcc_emitter_page {
      * and undefined for unused pages.
      */
     flatbuffers_soffset_t page_offset;
+    /* Pages may have different sizes. */
+    size_t page_size;
 };
 
 /*
@@ -109,6 +146,18 @@ struct flatcc_emitter {
     size_t used;
     size_t capacity;
     size_t used_average;
+    /* First and minimum page size, or 0 for `FLATCC_EMITTER_PAGE_SIZE`. */
+    size_t page_size;
+    /* Maximum page size, or 0 for `FLATCC_EMITTER_PAGE_SIZE_LIMIT`. */
+    size_t page_size_limit;
+    /* Streaming is enabled when `flush` is set. */
+    flatcc_emitter_flush_fun *flush;
+    void *flush_context;
+    /* Lowest offset flushed while building, or 0. */
+    flatbuffers_soffset_t flushed_start;
+    /* Pages are allocated with `FLATCC_EMITTER_ALLOC` when not set. */
+    flatcc_emitter_alloc_fun *alloc;
+    void *alloc_context;
 };
 
 /* Optional helper to ensure emitter is zeroed initially. */
@@ -117,7 +166,87 @@ static inline void flatcc_emitter_init(flatcc_emitter_t *E)
     memset(E, 0, sizeof(*E));
 }
 
-/* Deallocates all buffer memory making the emitter ready for next use. */
+/*
+ * Sets the first and minimum page size, and the maximum page size that
+ * pages grow to for large buffers. Sizes are rounded down to a
+ * multiple of `2 * FLATCC_EMITTER_PAGE_MULTIPLE` and 0 selects the
+ * compile time default. Using the same value for both gives fixed size
+ * pages. Only affects pages allocated after the call, so it is best
+ * called before first use, or after clear.
+ */
+static inline void flatcc_emitter_set_page_size(flatcc_emitter_t *E,
+        size_t page_size, size_t page_size_limit)
+{
+    size_t mask = ~(2 * (size_t)FLATCC_EMITTER_PAGE_MULTIPLE - 1);
+
+    page_size &= mask;
+    page_size_limit &= mask;
+    E->page_size = page_size;
+    E->page_size_limit = page_size_limit;
+}
+
+/*
+ * Enables streaming: every time the front of the buffer moves past a
+ * page, the completed page content is passed to `flush` and the page
+ * is recycled, so only the active front page, the first page, and any
+ * back pages remain in memory regardless of buffer size. Emitted
+ * content never changes, so this is safe during construction.
+ *
+ * Front content is flushed in decreasing offset order as the buffer
+ * grows towards lower addresses, each chunk immediately preceding the
+ * previous chunk. When the buffer is complete, `flatcc_emitter_flush`
+ * must be called to flush the remaining content in increasing offset
+ * order. Back content holds clustered vtables and end padding, so
+ * it is small if `flatcc_builder_set_vtable_clustering(B, 0)` is used.
+ * A receiver can rebuild the buffer by placing each chunk at its
+ * offset relative to the end of the buffer, or relative to the lowest
+ * offset received.
+ *
+ * The direct, copy and iov buffer access functions are not meaningful
+ * when streaming. A null `flush` disables streaming. Settings survive
+ * reset and clear.
+ */
+static inline void flatcc_emitter_set_flush(flatcc_emitter_t *E,
+        flatcc_emitter_flush_fun *flush, void *flush_context)
+{
+    E->flush = flush;
+    E->flush_context = flush_context;
+}
+
+/*
+ * Replaces the compile time page allocation with a runtime allocator,
+ * for example a page pool. Must be called before the first page is
+ * allocated, or after clear, because pages are freed with the same
+ * allocator. The setting survives reset and clear.
+ */
+static inline void flatcc_emitter_set_alloc(flatcc_emitter_t *E,
+        flatcc_emitter_alloc_fun *alloc, void *alloc_context)
+{
+    E->alloc = alloc;
+    E->alloc_context = alloc_context;
+}
+
+/*
+ * Flushes all content not already flushed when streaming. Call once
+ * when the buffer is complete and before reset. Returns -1 if
+ * streaming is not enabled or if the flush function fails, 0 otherwise.
+ */
+int flatcc_emitter_flush(flatcc_emitter_t *E);
+
+/*
+ * Discards content emitted after the front and back offsets were
+ * `front` and `back`, for example to undo a partially built object.
+ * `front` must not be below and `back` not above the current offsets.
+ * Pages are kept for reuse. Returns -1 if the range is invalid or if
+ * part of the discarded content has already been flushed, 0 otherwise.
+ */
+int flatcc_emitter_rewind(flatcc_emitter_t *E,
+        flatbuffers_soffset_t front, flatbuffers_soffset_t back);
+
+/*
+ * Deallocates all buffer memory making the emitter ready for next use.
+ * Page size, flush and allocator settings are preserved.
+ */
 void flatcc_emitter_clear(flatcc_emitter_t *E);
 
 /*
@@ -196,6 +325,22 @@ static inline void *flatcc_emitter_get_direct_buffer(flatcc_emitter_t *E, size_t
  */
 void *flatcc_emitter_copy_buffer(flatcc_emitter_t *E, void *buf, size_t size);
 
+/*
+ * Describes the buffer as a sequence of memory segments in buffer
+ * order without copying, for example for use with `writev` or
+ * `sendmsg` where `flatcc_iovec_t` is layout compatible with `struct
+ * iovec` on common platforms. The first and last segments cover only
+ * the used part of the front and back pages. At most `iov_max`
+ * entries are written to `iov`, which may be null if `iov_max` is 0.
+ *
+ * Returns the total number of segments in the buffer, which may exceed
+ * `iov_max`, in which case the call can be repeated with a larger
+ * array. Returns 0 for an empty buffer. The segments remain valid
+ * until the emitter is reset or cleared, and are not meaningful if
+ * pages have been recycled.
+ */
+int flatcc_emitter_get_iov(flatcc_emitter_t *E, flatcc_iovec_t *iov, int iov_max);
+
 /*
  * The emitter interface function to the flatbuilder API.
  * `emit_context` should be of type `flatcc_emitter_t` for this
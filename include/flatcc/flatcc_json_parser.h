@@ -28,6 +28,11 @@ static const flatcc_json_parser_flags_t flatcc_json_parser_f_force_add = 2;
 static const flatcc_json_parser_flags_t flatcc_json_parser_f_with_size = 4;
 static const flatcc_json_parser_flags_t flatcc_json_parser_f_skip_array_overflow = 8;
 static const flatcc_json_parser_flags_t flatcc_json_parser_f_reject_array_underflow = 16;
+/*
+ * Build a character class index of the input before parsing, see
+ * `flatcc_json_parser_build_index`.
+ */
+static const flatcc_json_parser_flags_t flatcc_json_parser_f_with_index = 32;
 
 #define FLATCC_JSON_PARSE_ERROR_MAP(XX)                                     \
     XX(ok,                      "ok")                                       \
@@ -79,6 +84,19 @@ const char *flatcc_json_parser_error_string(int err);
 #define flatcc_json_parser_ok flatcc_json_parser_error_ok
 #define flatcc_json_parser_eof flatcc_json_parser_error_eof
 
+/*
+ * One block of the index covers 64 input bytes with bit `i` of each
+ * mask representing byte `i` of the block.
+ */
+typedef struct flatcc_json_parser_index_block {
+    /* Bytes that are not JSON space, i.e. not space, tab, CR, or LF. */
+    uint64_t nonspace;
+    /* LF, and CR not followed by LF. */
+    uint64_t newline;
+    /* Quote, backslash, and control characters, ending a string part. */
+    uint64_t special;
+} flatcc_json_parser_index_block_t;
+
 /*
  * The struct may be zero initialized in which case the line count will
  * start at line zero, or the line may be set to 1 initially. The ctx
@@ -103,6 +121,8 @@ struct flatcc_json_parser_ctx {
     const char *error_loc;
     /* Set at end of successful parse. */
     const char *end_loc;
+    /* Optional index of `start` to `end`, see `flatcc_json_parser_build_index`. */
+    const flatcc_json_parser_index_block_t *index;
 };
 
 static inline int flatcc_json_parser_get_error(flatcc_json_parser_t *ctx)
@@ -125,6 +145,27 @@ static inline void flatcc_json_parser_init(flatcc_json_parser_t *ctx, flatcc_bui
 
 const char *flatcc_json_parser_set_error(flatcc_json_parser_t *ctx, const char *loc, const char *end, int reason);
 
+/*
+ * Classifies every input byte from `ctx->start` to `ctx->end` in a
+ * single pass over 64 byte blocks, so space and string content can be
+ * skipped by bit scans rather than byte by byte. The pass uses GCC /
+ * clang vector extensions where `FLATCC_JSON_PARSE_INDEX_VECTOR` allows
+ * it and portable 64-bit word operations otherwise. This pays off for
+ * input with long strings or runs of indentation and is otherwise
+ * mostly overhead.
+ *
+ * The `*_as_root` and generated `<schema>_parse_json` parsers build and
+ * clear the index when `flatcc_json_parser_f_with_index` is given.
+ * Otherwise the index must be built after `flatcc_json_parser_init`
+ * and cleared after parsing. The index is only used when parsing up to
+ * `ctx->end`.
+ *
+ * Returns -1 and parses without index if the index cannot be
+ * allocated.
+ */
+int flatcc_json_parser_build_index(flatcc_json_parser_t *ctx);
+void flatcc_json_parser_clear_index(flatcc_json_parser_t *ctx);
+
 /*
  * Wide space is not necessarily beneficial in the typical space, but it
  * also isn't expensive so it may be added when there are applications
@@ -899,6 +940,203 @@ int flatcc_json_parser_struct_as_root(flatcc_builder_t *B, flatcc_json_parser_t
         const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,
         flatcc_json_parser_struct_f *parser);
 
+/*
+ * Called by `flatcc_json_parser_table_lines` after each record.
+ *
+ * If `ctx->error` is zero, `B` holds the finished buffer of the record
+ * which may be accessed with `flatcc_builder_get_direct_buffer`,
+ * `flatcc_builder_copy_buffer`, or the emitter in use, and
+ * `ctx->end_loc` is set to the end of the record. Otherwise `ctx` holds
+ * the error and its location and the content of `B` is undefined.
+ *
+ * Returns 0 to continue with the next record, or a non-zero value that
+ * stops parsing and is returned from `flatcc_json_parser_table_lines`.
+ */
+typedef int flatcc_json_parser_record_f(void *context, flatcc_builder_t *B, flatcc_json_parser_t *ctx);
+
+/*
+ * Parses newline delimited JSON (NDJSON, JSON Lines) with one table per
+ * record into one buffer per record as `flatcc_json_parser_table_as_root`
+ * would, calling `record` after each. The parser context is initialized
+ * once for all input, including the index if `flatcc_json_parser_f_with_index`
+ * is given, and `B` is reset before each record. With
+ * `flatcc_json_parser_f_with_size`, writing each buffer from `record`
+ * produces a stream of size prefixed buffers as read by
+ * `flatcc_verify_stream`.
+ *
+ * Records are separated by at least one line break and may span several
+ * lines. Blank lines are ignored. Line numbers in `ctx` count from the
+ * start of the input. If a record fails and `record` returns 0, parsing
+ * resumes on the line following the error.
+ *
+ * Returns 0 when all input has been processed, -1 on builder errors, or
+ * the first non-zero value returned by `record`.
+ */
+int flatcc_json_parser_table_lines(flatcc_builder_t *B, flatcc_json_parser_t *ctx,
+        const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,
+        flatcc_json_parser_table_f *parser, flatcc_json_parser_record_f *record, void *context);
+
+/*
+ * Frames a sequence of JSON tables that arrives in chunks of any size,
+ * such as NDJSON or concatenated JSON read from a socket, and parses
+ * each table once it is complete:
+ *
+ *     flatcc_json_parser_stream_t S;
+ *
+ *     flatcc_json_parser_stream_init(&S, B, 0, ns(Monster_file_identifier),
+ *             ns(Monster_parse_json_table), on_record, context);
+ *     while ((n = recv(sock, chunk, sizeof(chunk), 0)) > 0) {
+ *         if (flatcc_json_parser_stream_feed(&S, chunk, (size_t)n)) break;
+ *     }
+ *     flatcc_json_parser_stream_end(&S);
+ *     flatcc_json_parser_stream_clear(&S);
+ *
+ * This is a value framer, not a resumable parser. The generated parsers
+ * hold their state on the C stack and cannot suspend inside a table.
+ * Instead each chunk is scanned for the end of the current top level
+ * value, tracking nesting and strings across chunk boundaries, and a
+ * table is parsed into `B` as soon as it is complete. Only the
+ * incomplete table is retained between chunks, so memory is
+ * proportional to the largest table rather than the input. A single
+ * large document is retained whole until its last chunk arrives, so
+ * its memory use is the same as with `flatcc_json_parser_table_as_root`
+ * on the complete input.
+ *
+ * Tables are separated by space and `record` is called after each as
+ * for `flatcc_json_parser_table_lines`, with `S.ctx` as parser context.
+ * Locations in `S.ctx` are only valid during the call, but `S.ctx.line`
+ * counts LF line breaks from the start of the input.
+ */
+typedef struct flatcc_json_parser_stream flatcc_json_parser_stream_t;
+struct flatcc_json_parser_stream {
+    flatcc_builder_t *B;
+    flatcc_json_parser_flags_t flags;
+    const char *fid;
+    flatcc_json_parser_table_f *parser;
+    flatcc_json_parser_record_f *record;
+    void *context;
+    flatcc_json_parser_t ctx;
+
+    size_t record_count;
+    size_t error_count;
+
+    /* Retained input from the start of the incomplete table. */
+    char *buf;
+    size_t size;
+    size_t capacity;
+    size_t scanned;
+    int line;
+    int depth;
+    int in_value;
+    int in_string;
+    int escape;
+};
+
+static inline void flatcc_json_parser_stream_init(flatcc_json_parser_stream_t *S,
+        flatcc_builder_t *B, flatcc_json_parser_flags_t flags, const char *fid,
+        flatcc_json_parser_table_f *parser, flatcc_json_parser_record_f *record, void *context)
+{
+    memset(S, 0, sizeof(*S));
+    S->B = B;
+    S->flags = flags;
+    S->fid = fid;
+    S->parser = parser;
+    S->record = record;
+    S->context = context;
+    S->line = 1;
+}
+
+/*
+ * Returns 0 when the chunk has been consumed, -1 on allocation or
+ * builder errors, or the first non-zero value returned by `record`.
+ * Parsing must not continue after a non-zero return.
+ */
+int flatcc_json_parser_stream_feed(flatcc_json_parser_stream_t *S, const char *buf, size_t bufsiz);
+
+/*
+ * Ends the input, which fails a table that is still incomplete.
+ * Returns as `flatcc_json_parser_stream_feed`.
+ */
+int flatcc_json_parser_stream_end(flatcc_json_parser_stream_t *S);
+
+/* Releases retained input. The stream may be initialized again. */
+void flatcc_json_parser_stream_clear(flatcc_json_parser_stream_t *S);
+
+/*
+ * Runs `task(arg, index)` for each index below `count`, possibly in
+ * parallel, and returns when all calls have returned. This has the
+ * same signature as `flatcc_verifier_parallel_for_f` so
+ * `flatcc_verifier_parallel_for_threads` may be used.
+ */
+typedef void flatcc_json_parser_task_f(void *arg, size_t index);
+typedef void flatcc_json_parser_parallel_for_f(void *pool,
+        flatcc_json_parser_task_f *task, void *arg, size_t count);
+
+/* Receives output in input order. Returns non-zero to stop. */
+typedef int flatcc_json_parser_write_f(void *context, const void *data, size_t size);
+
+/*
+ * Parallel conversion of newline delimited JSON with one record per
+ * line into back-to-back size prefixed buffers, for example:
+ *
+ *     flatcc_json_parser_parallel_lines_t P;
+ *     flatcc_verifier_threads_t threads = { 8 };
+ *
+ *     flatcc_json_parser_parallel_lines_init(&P, ns(Monster_file_identifier),
+ *             ns(Monster_parse_json_table));
+ *     P.parallel_for = flatcc_verifier_parallel_for_threads;
+ *     P.pool = &threads;
+ *     ret = flatcc_json_parser_parallel_lines(&P, json, json_size, write_file, fp);
+ *
+ * The input is split into chunks of about `chunk_size` bytes ending
+ * with a line break. Each chunk is parsed by `parallel_for` with
+ * `flatcc_json_parser_table_lines` into its own output, using a builder
+ * from a shared pool, and outputs are written with `write` in input
+ * order a batch of `batch_size` chunks at a time. Unlike
+ * `flatcc_json_parser_table_lines`, a record must not span lines.
+ *
+ * Failed records produce no output. They are counted and the first
+ * error in input order is recorded with its line and position.
+ *
+ * `flags` are passed to the parser and always include
+ * `flatcc_json_parser_f_with_size`.
+ */
+typedef struct flatcc_json_parser_parallel_lines flatcc_json_parser_parallel_lines_t;
+struct flatcc_json_parser_parallel_lines {
+    const char *fid;
+    flatcc_json_parser_table_f *parser;
+    flatcc_json_parser_flags_t flags;
+    /* Zero selects defaults. */
+    size_t chunk_size;
+    size_t batch_size;
+    /* Chunks are parsed in the calling thread if null. */
+    flatcc_json_parser_parallel_for_f *parallel_for;
+    void *pool;
+
+    /* Results. */
+    size_t record_count;
+    size_t error_count;
+    int error;
+    int error_line;
+    int error_pos;
+};
+
+static inline void flatcc_json_parser_parallel_lines_init(flatcc_json_parser_parallel_lines_t *P,
+        const char *fid, flatcc_json_parser_table_f *parser)
+{
+    memset(P, 0, sizeof(*P));
+    P->fid = fid;
+    P->parser = parser;
+}
+
+/*
+ * Returns 0 when all input has been processed, also if some records
+ * failed, -1 on allocation errors, or the first non-zero value returned
+ * by `write`.
+ */
+int flatcc_json_parser_parallel_lines(flatcc_json_parser_parallel_lines_t *P,
+        const char *buf, size_t bufsiz, flatcc_json_parser_write_f *write, void *context);
+
 #include "flatcc/portable/pdiagnostic_pop.h"
 
 #ifdef __cplusplus
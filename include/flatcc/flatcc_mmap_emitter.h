@@ -0,0 +1,171 @@
+#ifndef FLATCC_MMAP_EMITTER_H
+#define FLATCC_MMAP_EMITTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * File backed emitter that builds a buffer directly inside a shared
+ * memory mapped file.
+ *
+ * The default emitter (flatcc_emitter.h) stores the buffer in a chain of
+ * small pages which must be copied into a linear buffer when done, so
+ * peak memory is twice the buffer size. This emitter instead writes
+ * each emitted object straight to its final location in a mapped file,
+ * and the buffer is readable through the mapping, and by other
+ * processes mapping the same file, with no extra copy.
+ *
+ * The builder grows the buffer both downwards (front, negative offsets)
+ * and upwards (back, clustered vtables and end padding), so the file is
+ * organized with a zero point: front data is stored below and back data
+ * above this point. When either side runs out of space, the file is
+ * extended geometrically and remapped, and if the front side was too
+ * small, the content already emitted is moved up within the mapping.
+ * Growth is amortized, and a good `size_hint` avoids it entirely.
+ *
+ * Because the start of the buffer is not known until the buffer is
+ * complete, the content will in general not start at file offset 0.
+ * `flatcc_mmap_emitter_get_direct_buffer` gives access to the buffer
+ * where it is, while `flatcc_mmap_emitter_finalize` moves it to the
+ * start of the file (a move within the mapping, not an extra copy in
+ * heap memory) and truncates the file to the exact buffer size. The
+ * file is not synced to disk - use `fsync` on the descriptor if needed.
+ *
+ * Only available on Posix systems with `mmap`. On other systems all
+ * operations fail, except clear which does nothing.
+ *
+ * Example:
+ *
+ *     flatcc_mmap_emitter_t E;
+ *     flatcc_builder_t builder, *B = &builder;
+ *
+ *     flatcc_mmap_emitter_open(&E, "out.mon", 1024 * 1024);
+ *     flatcc_builder_custom_init(B, flatcc_mmap_emitter, &E, 0, 0);
+ *     ... build buffer ...
+ *     flatcc_mmap_emitter_finalize(&E, &size);
+ *     flatcc_builder_clear(B);
+ *     flatcc_mmap_emitter_clear(&E);
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "flatcc/flatcc_types.h"
+#include "flatcc/flatcc_iov.h"
+
+/* Capacity used when `size_hint` is 0. */
+#ifndef FLATCC_MMAP_EMITTER_DEFAULT_SIZE
+#define FLATCC_MMAP_EMITTER_DEFAULT_SIZE 65536
+#endif
+
+/*
+ * The fraction of the initial capacity reserved for back data, i.e.
+ * clustered vtables and end padding, given as a shift: 1/16 by default.
+ */
+#ifndef FLATCC_MMAP_EMITTER_BACK_SHIFT
+#define FLATCC_MMAP_EMITTER_BACK_SHIFT 4
+#endif
+
+typedef struct flatcc_mmap_emitter flatcc_mmap_emitter_t;
+
+/* All fields are private, but stable until the next emitter call. */
+struct flatcc_mmap_emitter {
+    /* Mapped file content, or null. */
+    uint8_t *map;
+    /* Current file size and mapped size. */
+    size_t capacity;
+    /* File offset of buffer offset 0. */
+    size_t zero;
+    /* Bytes emitted below zero. */
+    size_t front_used;
+    /* Bytes emitted at or above zero. */
+    size_t back_used;
+    /* Capacity to restore on reset after finalize truncated the file. */
+    size_t reserved;
+    int fd;
+    /* Set when the file was opened by the emitter and must be closed. */
+    int owns_fd;
+    /* Set after finalize where the buffer starts at file offset 0. */
+    int is_finalized;
+};
+
+/*
+ * Creates or truncates the file at `path` and maps an initial
+ * capacity of `size_hint` bytes, or a default if 0. The file is
+ * closed on clear. Returns 0 on success, -1 on failure.
+ */
+int flatcc_mmap_emitter_open(flatcc_mmap_emitter_t *E, const char *path, size_t size_hint);
+
+/*
+ * Same as `flatcc_mmap_emitter_open` but uses an already open file
+ * descriptor that must be readable and writable. The file is truncated
+ * and extended as needed, and is not closed on clear.
+ */
+int flatcc_mmap_emitter_init_fd(flatcc_mmap_emitter_t *E, int fd, size_t size_hint);
+
+/*
+ * Prepares for building a new buffer in the same file, overwriting any
+ * previous content. The current capacity is kept. Returns 0 on success.
+ */
+int flatcc_mmap_emitter_reset(flatcc_mmap_emitter_t *E);
+
+/* Unmaps the file and closes it if opened by the emitter. */
+void flatcc_mmap_emitter_clear(flatcc_mmap_emitter_t *E);
+
+static inline size_t flatcc_mmap_emitter_get_buffer_size(flatcc_mmap_emitter_t *E)
+{
+    return E->front_used + E->back_used;
+}
+
+/*
+ * Returns the buffer inside the mapping, or null if nothing has been
+ * emitted. The pointer is valid until the next emitter call, reset or
+ * clear. The buffer is aligned to the largest alignment in the buffer,
+ * up to the page size, once the builder has ended the buffer.
+ *
+ * If `size_out` is not null, it is set to the buffer size, or 0 if
+ * operation failed.
+ */
+static inline void *flatcc_mmap_emitter_get_direct_buffer(flatcc_mmap_emitter_t *E, size_t *size_out)
+{
+    if (!E->map || (E->front_used == 0 && E->back_used == 0)) {
+        if (size_out) {
+            *size_out = 0;
+        }
+        return 0;
+    }
+    if (size_out) {
+        *size_out = E->front_used + E->back_used;
+    }
+    return E->map + E->zero - E->front_used;
+}
+
+/*
+ * Moves the completed buffer to the start of the file and truncates the
+ * file to the buffer size. The buffer is then a standalone FlatBuffer
+ * file. Afterwards the buffer remains available via
+ * `flatcc_mmap_emitter_get_direct_buffer`, but nothing more can be
+ * emitted before reset.
+ *
+ * Returns 0 on success, -1 on failure. If `size_out` is not null it
+ * receives the buffer size, or 0 on failure.
+ */
+int flatcc_mmap_emitter_finalize(flatcc_mmap_emitter_t *E, size_t *size_out);
+
+/*
+ * The emitter interface function to the flatbuilder API.
+ * `emit_context` must be of type `flatcc_mmap_emitter_t`.
+ *
+ * This function is compatible with the `flatbuilder_emit_fun`
+ * type defined in "flatbuilder.h".
+ */
+int flatcc_mmap_emitter(void *emit_context,
+        const flatcc_iovec_t *iov, int iov_count,
+        flatbuffers_soffset_t offset, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLATCC_MMAP_EMITTER_H */
@@ -90,6 +90,28 @@ typedef char flatbuffers_fid_t[FLATBUFFERS_IDENTIFIER_SIZE];
 
 #endif /* flatbuffers_types_defined */
 
+#ifndef flatcc_table_index_defined
+#define flatcc_table_index_defined
+
+/*
+ * Field offsets of a table recorded by the indexing verifier, see
+ * `flatcc_verify_table_as_root_with_index`, so generated
+ * `<table>_<field>_indexed` readers need not decode the vtable.
+ */
+typedef struct flatcc_table_index flatcc_table_index_t;
+struct flatcc_table_index {
+    /* Set by the verifier to the table, or null if absent. */
+    const void *table;
+    /* Set by the verifier to field offsets by id, 0 if absent. */
+    flatbuffers_voffset_t *fields;
+    flatbuffers_voffset_t field_count;
+    /* Entry of the table with table field `id` referencing this table. */
+    const flatcc_table_index_t *parent;
+    flatbuffers_voffset_t id;
+};
+
+#endif /* flatcc_table_index_defined */
+
 #ifdef __cplusplus
 }
 #endif
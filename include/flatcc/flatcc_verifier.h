@@ -91,7 +91,12 @@ extern "C" {
     XX(union_vector_length_mismatch, "union type and table vectors have different lengths")\
     XX(union_vector_verification_not_supported, "union vector verification not supported")\
     XX(runtime_buffer_size_less_than_size_field, "runtime buffer size less than buffer headers size field")\
-    XX(not_supported, "not supported")
+    XX(not_supported, "not supported")\
+    XX(runtime_memo_allocation_failed, "runtime: verifier memo allocation failed")\
+    XX(runtime_stack_allocation_failed, "runtime: verifier stack allocation failed")\
+    XX(string_not_utf8, "string not valid UTF-8")\
+    XX(runtime_schema_type_not_found, "runtime: type not found in binary schema")\
+    XX(runtime_stream_allocation_failed, "runtime: verifier stream allocation failed")
 
 
 
@@ -105,6 +110,115 @@ enum flatcc_verify_error_no {
 
 const char *flatcc_verify_error_string(int err);
 
+/*
+ * Returns 1 if the `len` bytes at `s` are valid UTF-8, otherwise 0.
+ * Overlong encodings, surrogates and code points above U+10FFFF are
+ * invalid. Strings are checked this way during verification when the
+ * runtime library is built with `FLATCC_VERIFIER_UTF8`.
+ */
+int flatcc_verify_utf8(const void *s, size_t len);
+
+/*
+ * A verifier memo records the tables and vectors already verified so
+ * that objects shared by several references are only verified once.
+ *
+ * Without a memo, a shared object is verified every time it is
+ * reached, so a buffer built as a DAG, for example by cloning with a
+ * refmap, can take time exponential in the nesting depth to verify.
+ * With a memo, verification time is linear in the buffer size.
+ *
+ * Objects are recorded by address together with the verifier used
+ * and the enclosing buffer end, so the same data reached as a
+ * different type is still verified. Strings and scalar vectors are
+ * verified in constant time and are not recorded.
+ *
+ * A memoized object is not verified again when it is reached at a
+ * deeper nesting level, so the max nesting level only applies to the
+ * first path reaching an object. The verifier does not recurse into
+ * memoized objects, so this does not affect stack usage.
+ *
+ * The memo is reset by each `_with_memo` root verifier call, and
+ * retains its memory across calls until cleared. A memo must not be
+ * used by more than one verifier call at a time.
+ */
+typedef struct flatcc_verifier_memo_entry flatcc_verifier_memo_entry_t;
+typedef struct flatcc_verifier_memo flatcc_verifier_memo_t;
+
+/* All fields are private. */
+struct flatcc_verifier_memo_entry {
+    const void *obj;
+    const void *end;
+    const void *aux;
+    void (*fn)(void);
+    const void *type;
+    int kind;
+};
+
+/* All fields are private. */
+struct flatcc_verifier_memo {
+    flatcc_verifier_memo_entry_t *entries;
+    size_t count;
+    size_t capacity;
+};
+
+/* Does not allocate memory. */
+static inline void flatcc_verifier_memo_init(flatcc_verifier_memo_t *memo)
+{
+    memo->entries = 0;
+    memo->count = 0;
+    memo->capacity = 0;
+}
+
+/* Releases all memory. The memo can then be reused. */
+void flatcc_verifier_memo_clear(flatcc_verifier_memo_t *memo);
+
+/*
+ * Verifier statistics are collected by the `_with_stats` root verifiers
+ * when the runtime library is built with `FLATCC_VERIFIER_STATS`,
+ * otherwise all counts are left at zero.
+ *
+ * Only the generated recursive verifiers count, and they count each
+ * object every time it is reached, except objects skipped by a memo.
+ * Bytes are those covered by verified table, vtable, vector and string
+ * bounds, so shared data is counted once per reference.
+ */
+typedef struct flatcc_verifier_stats flatcc_verifier_stats_t;
+
+struct flatcc_verifier_stats {
+    /* Tables verified, not counting tables skipped by a memo. */
+    size_t tables;
+    /* Vtable headers read, including those of tables skipped by a memo. */
+    size_t vtables;
+    /* Vectors of any type, including table, string and union vectors. */
+    size_t vectors;
+    /* Strings in fields, unions, and string vectors. */
+    size_t strings;
+    size_t bytes;
+    /*
+     * Deepest nesting level reached as counted against the max nesting
+     * level, 1 for the root table. Vectors of tables and unions also
+     * count as a level.
+     */
+    int max_depth;
+    /*
+     * Elapsed seconds of the last root verifier call, measured with a
+     * monotonic clock where available.
+     */
+    double seconds;
+};
+
+/* Does not allocate memory. */
+static inline void flatcc_verifier_stats_init(flatcc_verifier_stats_t *stats)
+{
+    stats->tables = 0;
+    stats->vtables = 0;
+    stats->vectors = 0;
+    stats->strings = 0;
+    stats->bytes = 0;
+    stats->max_depth = 0;
+    stats->seconds = 0;
+}
+
 /*
  * Type specific table verifier function that checks each known field
  * for existence in the vtable and then calls the appropriate verifier
@@ -133,6 +247,13 @@ struct flatcc_table_verifier_descriptor {
     flatbuffers_voffset_t tsize;
     /* Size of vtable in bytes. */
     flatbuffers_voffset_t vsize;
+    /* Verified objects, or null when not memoizing. */
+    flatcc_verifier_memo_t *memo;
+    /* Statistics, or null when not collecting. */
+    flatcc_verifier_stats_t *stats;
+    /* Index entry of the current table and end of entries, or null. */
+    flatcc_table_index_t *index;
+    flatcc_table_index_t *index_end;
 };
 
 typedef int flatcc_table_verifier_f(flatcc_table_verifier_descriptor_t *td);
@@ -152,10 +273,93 @@ struct flatcc_union_verifier_descriptor {
     flatbuffers_uoffset_t base;
     /* Offset of union value relative to base. */
     flatbuffers_uoffset_t offset;
+    /* Verified objects, or null when not memoizing. */
+    flatcc_verifier_memo_t *memo;
+    /* Statistics, or null when not collecting. */
+    flatcc_verifier_stats_t *stats;
 };
 
 typedef int flatcc_union_verifier_f(flatcc_union_verifier_descriptor_t *ud);
 
+/*
+ * Verifier types describe tables and unions as data for the iterative
+ * verifier. They are generated as `<table>_table_verifier_type` and
+ * `<union>_union_verifier_type` functions returning static tables.
+ *
+ * The iterative verifier uses an explicit work stack rather than
+ * recursion, so nesting depth is only limited by available memory,
+ * and there is no call per table or per field.
+ */
+enum flatcc_verifier_op {
+    flatcc_verifier_op_none,
+    /* Scalar, enum, or struct field of `size` and `align`. */
+    flatcc_verifier_op_field,
+    flatcc_verifier_op_string,
+    /* Vector of scalars, enums, or structs of `size` and `align`. */
+    flatcc_verifier_op_vector,
+    flatcc_verifier_op_string_vector,
+    flatcc_verifier_op_table,
+    flatcc_verifier_op_table_vector,
+    flatcc_verifier_op_union,
+    flatcc_verifier_op_union_vector,
+    /* Nested flatbuffer with a table root and buffer `align`. */
+    flatcc_verifier_op_nested_table,
+    /* Nested flatbuffer with a struct root of `size` and `align`. */
+    flatcc_verifier_op_nested_struct,
+    /* Union member struct of `size` and `align`. */
+    flatcc_verifier_op_struct
+};
+
+typedef struct flatcc_verifier_table_type flatcc_verifier_table_type_t;
+typedef struct flatcc_verifier_union_type flatcc_verifier_union_type_t;
+typedef struct flatcc_verifier_field flatcc_verifier_field_t;
+typedef struct flatcc_verifier_union_member flatcc_verifier_union_member_t;
+
+/*
+ * Functions rather than objects so generated types can reference each
+ * other. Types built at runtime, such as from a binary schema, set the
+ * function to null and use the `_ptr` field instead.
+ */
+typedef const flatcc_verifier_table_type_t *flatcc_verifier_table_type_f(void);
+typedef const flatcc_verifier_union_type_t *flatcc_verifier_union_type_f(void);
+
+struct flatcc_verifier_field {
+    flatbuffers_voffset_t id;
+    uint8_t op;
+    uint8_t required;
+    uint16_t align;
+    /* Field or element size. */
+    flatbuffers_uoffset_t size;
+    /* Largest vector count that does not overflow the buffer size. */
+    flatbuffers_uoffset_t max_count;
+    /* Table, table vector, and nested table fields. */
+    flatcc_verifier_table_type_f *table_type;
+    /* Union and union vector fields. */
+    flatcc_verifier_union_type_f *union_type;
+    const flatcc_verifier_table_type_t *table_type_ptr;
+    const flatcc_verifier_union_type_t *union_type_ptr;
+};
+
+struct flatcc_verifier_table_type {
+    const flatcc_verifier_field_t *fields;
+    size_t field_count;
+};
+
+struct flatcc_verifier_union_member {
+    /* table, struct, string, or none for unknown types. */
+    uint8_t op;
+    uint16_t align;
+    flatbuffers_uoffset_t size;
+    flatcc_verifier_table_type_f *table_type;
+    const flatcc_verifier_table_type_t *table_type_ptr;
+};
+
+struct flatcc_verifier_union_type {
+    /* Indexed by union type, types beyond `member_count` are unknown. */
+    const flatcc_verifier_union_member_t *members;
+    size_t member_count;
+};
+
 /*
  * The `as_root` functions are normally the only functions called
  * explicitly in this interface.
@@ -193,6 +397,291 @@ int flatcc_verify_table_as_typed_root(const void *buf, size_t bufsiz, flatbuffer
 int flatcc_verify_table_as_typed_root_with_size(const void *buf, size_t bufsiz, flatbuffers_thash_t thash,
         flatcc_table_verifier_f *root_tvf);
 
+/*
+ * Same as `flatcc_verify_table_as_root` and
+ * `flatcc_verify_table_as_root_with_size`, but verifies each shared
+ * table and vector only once, see `flatcc_verifier_memo_t`.
+ */
+int flatcc_verify_table_as_root_with_memo(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, flatcc_verifier_memo_t *memo);
+
+int flatcc_verify_table_as_root_with_size_and_memo(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, flatcc_verifier_memo_t *memo);
+
+/*
+ * Same as `flatcc_verify_table_as_root` and
+ * `flatcc_verify_table_as_root_with_size`, but resets `stats` and then
+ * collects statistics, see `flatcc_verifier_stats_t`. Counts are only
+ * valid if the buffer verifies.
+ */
+int flatcc_verify_table_as_root_with_stats(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, flatcc_verifier_stats_t *stats);
+
+int flatcc_verify_table_as_root_with_size_and_stats(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, flatcc_verifier_stats_t *stats);
+
+/*
+ * Same as `flatcc_verify_table_as_root` and
+ * `flatcc_verify_table_as_root_with_size`, but also records the table
+ * and field offsets of the root table in `index[0]`, and of each table
+ * referenced by table field `id` of an earlier `parent` entry in the
+ * following `count - 1` entries. Tables reached through unions, vectors
+ * or nested buffers cannot be indexed.
+ *
+ * The caller provides `fields` and `field_count` of each entry, and
+ * `parent` and `id` of each entry but the first. Entries for absent
+ * tables have a null table, and absent fields have offset 0. Entries
+ * are only valid if the buffer verifies.
+ *
+ * Generated `<table>_<field>_indexed(index)` readers then read fields
+ * of indexed tables without decoding the vtable again.
+ */
+int flatcc_verify_table_as_root_with_index(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, flatcc_table_index_t *index, size_t count);
+
+int flatcc_verify_table_as_root_with_size_and_index(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, flatcc_table_index_t *index, size_t count);
+
+/*
+ * Iterative verifiers given a generated table verifier type. They
+ * accept the same buffers as the recursive verifiers, except that
+ * there is no max nesting level. `memo` may be null, otherwise it is
+ * used as in `flatcc_verify_table_as_root_with_memo`.
+ *
+ * Returns `flatcc_verify_error_runtime_stack_allocation_failed` if the
+ * work stack cannot grow.
+ */
+int flatcc_verify_table_as_root_iterative(const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verifier_table_type_t *root_type, flatcc_verifier_memo_t *memo);
+
+int flatcc_verify_table_as_root_with_size_iterative(const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verifier_table_type_t *root_type, flatcc_verifier_memo_t *memo);
+
+/*
+ * Runs `task(arg, index)` for each index below `count`, possibly in
+ * parallel, and returns when all calls have returned. `pool` is
+ * passed through from the parallel verifier.
+ */
+typedef void flatcc_verifier_task_f(void *arg, size_t index);
+typedef void flatcc_verifier_parallel_for_f(void *pool,
+        flatcc_verifier_task_f *task, void *arg, size_t count);
+
+/*
+ * A built-in `flatcc_verifier_parallel_for_f` which starts up to
+ * `thread_count - 1` threads per call and also works in the calling
+ * thread. `pool` must point to a `flatcc_verifier_threads_t`. Without
+ * `FLATCC_USE_THREADS` all tasks run in the calling thread.
+ */
+typedef struct flatcc_verifier_threads flatcc_verifier_threads_t;
+struct flatcc_verifier_threads {
+    int thread_count;
+};
+
+void flatcc_verifier_parallel_for_threads(void *pool,
+        flatcc_verifier_task_f *task, void *arg, size_t count);
+
+/*
+ * Parallel verifiers for large buffers. The buffer is first verified
+ * iteratively, except that vectors of tables, strings, or unions
+ * with more than `FLATCC_VERIFIER_PARALLEL_CHUNK_SIZE` elements are
+ * deferred. The deferred vectors are then split into chunks of that
+ * many elements and verified by `parallel_for`.
+ *
+ * The result does not depend on thread count or scheduling: errors
+ * found before deferral come first, then the error of the first
+ * failing chunk in buffer traversal order. Because of the deferral,
+ * this may be a different error than the recursive verifier would
+ * report for the same invalid buffer.
+ *
+ * If `parallel_for` is null, chunks are verified in the calling thread.
+ * There is no max nesting level, as with the iterative verifiers.
+ */
+int flatcc_verify_table_as_root_parallel(const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verifier_table_type_t *root_type,
+        flatcc_verifier_parallel_for_f *parallel_for, void *pool);
+
+int flatcc_verify_table_as_root_with_size_parallel(const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verifier_table_type_t *root_type,
+        flatcc_verifier_parallel_for_f *parallel_for, void *pool);
+
+/*
+ * A stream verifier verifies back-to-back size prefixed buffers as
+ * written by `flatcc_builder_finalize_buffer` with the
+ * `flatcc_builder_with_size` flag, for example a memory mapped log file,
+ * and records the stream offset of each valid buffer and of each
+ * invalid buffer together with its error.
+ *
+ * Input can be given as a single range with `flatcc_verify_stream`,
+ * or in chunks with `flatcc_verify_stream_chunk`, which leaves an
+ * incomplete last buffer for the caller to pass again at the start of
+ * the next chunk. Each buffer must be aligned in memory as for the
+ * `_with_size` verifiers, otherwise it fails with
+ * `flatcc_verify_error_runtime_buffer_header_not_aligned` and the
+ * stream continues with the next buffer.
+ *
+ * Buffers in a range are verified by `parallel_for` if set after
+ * init, otherwise in the calling thread. The result does not depend on
+ * scheduling.
+ *
+ * Generated code adds `<table>_verifier_stream_init`:
+ *
+ *     flatcc_verifier_stream_t S;
+ *     flatcc_verifier_threads_t threads = { 8 };
+ *
+ *     ns(Monster_verifier_stream_init(&S));
+ *     S.parallel_for = flatcc_verifier_parallel_for_threads;
+ *     S.pool = &threads;
+ *     ret = flatcc_verify_stream(&S, data, size);
+ *     ... S.records[0 .. S.record_count), S.errors[0 .. S.error_count)
+ *     flatcc_verifier_stream_clear(&S);
+ */
+typedef struct flatcc_verifier_stream_error flatcc_verifier_stream_error_t;
+typedef struct flatcc_verifier_stream flatcc_verifier_stream_t;
+
+struct flatcc_verifier_stream_error {
+    /* Stream offset of the size field of the invalid buffer. */
+    size_t offset;
+    int error;
+};
+
+struct flatcc_verifier_stream {
+    /* Set by init. */
+    const char *fid;
+    flatcc_table_verifier_f *tvf;
+    /* Optional, null by default. */
+    flatcc_verifier_parallel_for_f *parallel_for;
+    void *pool;
+    /* Stream offset of the next buffer, 0 after init. */
+    size_t offset;
+    /* Stream offsets of the size fields of valid buffers in order. */
+    size_t *records;
+    size_t record_count;
+    /* Invalid buffers in order. */
+    flatcc_verifier_stream_error_t *errors;
+    size_t error_count;
+    /* Private. */
+    size_t record_capacity;
+    size_t error_capacity;
+};
+
+/* Does not allocate memory. `fid` may be null as with `_as_root` verifiers. */
+static inline void flatcc_verifier_stream_init(flatcc_verifier_stream_t *S,
+        const char *fid, flatcc_table_verifier_f *tvf)
+{
+    S->fid = fid;
+    S->tvf = tvf;
+    S->parallel_for = 0;
+    S->pool = 0;
+    S->offset = 0;
+    S->records = 0;
+    S->record_count = 0;
+    S->errors = 0;
+    S->error_count = 0;
+    S->record_capacity = 0;
+    S->error_capacity = 0;
+}
+
+/* Releases all memory. Configuration is kept, and results are reset. */
+void flatcc_verifier_stream_clear(flatcc_verifier_stream_t *S);
+
+/*
+ * Verifies all complete buffers at the start of `buf` and stores the
+ * number of bytes they take in `consumed`. `S->offset` is advanced by
+ * the same amount. Invalid buffers are recorded and do not stop the
+ * stream.
+ *
+ * Returns `flatcc_verify_error_runtime_stream_allocation_failed` if
+ * results cannot be stored, otherwise `flatcc_verify_ok`.
+ */
+int flatcc_verify_stream_chunk(flatcc_verifier_stream_t *S,
+        const void *buf, size_t bufsiz, size_t *consumed);
+
+/*
+ * Same as `flatcc_verify_stream_chunk`, but `buf` is the end of the
+ * stream, so any remaining bytes are recorded as an error:
+ * `flatcc_verify_error_runtime_buffer_size_less_than_size_field` for a
+ * truncated buffer, or `flatcc_verify_error_buffer_header_too_small`
+ * if not even the size field is present.
+ */
+int flatcc_verify_stream(flatcc_verifier_stream_t *S, const void *buf, size_t bufsiz);
+
+/*
+ * Lazy verification checks the buffer header and the root table up
+ * front, and other tables only when the reader asks for them, so a
+ * reader that only visits a few tables of a large buffer only pays for
+ * those.
+ *
+ * A table is verified shallowly: its vtable, fields, strings, and
+ * vector bounds are checked, but not the tables, strings, union values,
+ * or nested buffers referenced from its vectors and union fields, nor
+ * tables referenced from its table fields. Before such an object is
+ * read, it must be passed to `flatcc_lazy_verify_table`,
+ * `flatcc_lazy_verify_string`, or `flatcc_lazy_verify_struct` which
+ * accept null for absent objects. Nested buffers need their own lazy
+ * verifier. Verified tables are remembered so checking a table again
+ * is cheap.
+ *
+ * Once a check fails, all later checks return the same error until the
+ * next `flatcc_lazy_verify_as_root` call, so a reader can check the
+ * result once after reading.
+ *
+ * Generated code adds `<table>_lazy_verify_as_root` and
+ * `<table>_lazy_verify`:
+ *
+ *     flatcc_lazy_verifier_t L;
+ *
+ *     flatcc_lazy_verifier_init(&L);
+ *     ... for each buffer:
+ *     if (ns(Monster_lazy_verify_as_root(&L, buf, bufsiz))) goto invalid;
+ *     enemy = ns(Monster_enemy(ns(Monster_as_root(buf))));
+ *     if (ns(Monster_lazy_verify(&L, enemy))) goto invalid;
+ *     ...
+ *     flatcc_lazy_verifier_clear(&L);
+ *
+ * A lazy verifier must only be used by one thread at a time.
+ */
+typedef struct flatcc_lazy_verifier flatcc_lazy_verifier_t;
+
+/* All fields are private. */
+struct flatcc_lazy_verifier {
+    const void *buf;
+    flatbuffers_uoffset_t end;
+    int error;
+    flatcc_verifier_memo_t memo;
+};
+
+/* Does not allocate memory. */
+static inline void flatcc_lazy_verifier_init(flatcc_lazy_verifier_t *L)
+{
+    L->buf = 0;
+    L->end = 0;
+    L->error = 0;
+    flatcc_verifier_memo_init(&L->memo);
+}
+
+/* Releases all memory. The verifier can then be reused. */
+static inline void flatcc_lazy_verifier_clear(flatcc_lazy_verifier_t *L)
+{
+    flatcc_verifier_memo_clear(&L->memo);
+    flatcc_lazy_verifier_init(L);
+}
+
+int flatcc_lazy_verify_as_root(flatcc_lazy_verifier_t *L, const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verifier_table_type_t *root_type);
+
+int flatcc_lazy_verify_as_root_with_size(flatcc_lazy_verifier_t *L, const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verifier_table_type_t *root_type);
+
+/* `table` is a table read from the buffer, or null. */
+int flatcc_lazy_verify_table(flatcc_lazy_verifier_t *L, const void *table,
+        const flatcc_verifier_table_type_t *type);
+
+/* `s` is a string read from the buffer, or null. */
+int flatcc_lazy_verify_string(flatcc_lazy_verifier_t *L, const char *s);
+
+/* `p` is a union struct value read from the buffer, or null. */
+int flatcc_lazy_verify_struct(flatcc_lazy_verifier_t *L, const void *p, size_t size, uint16_t align);
+
 /*
  * The buffer header is verified by any of the `_as_root` verifiers, but
  * this function may be used as a quick sanity check.
@@ -0,0 +1,151 @@
+/*
+ * A vtable dictionary holds vtables that are known ahead of time, and
+ * can be shared by any number of builders, also across threads.
+ *
+ * Each builder has its own vtable cache which must first see a vtable
+ * before it can be reused, and a builder cache entry is needed for
+ * every vtable shape in every builder. When a dictionary is attached
+ * with `flatcc_builder_set_vtable_dict`, the builder searches the
+ * dictionary on a cache miss and emits the dictionary's protocol endian
+ * copy directly without conversion. The vtable is then added to the
+ * builder cache so later uses are found without searching the
+ * dictionary again.
+ *
+ * The dictionary is read-mostly: it is filled, frozen, and then only
+ * read, so builders need no locks or atomic operations to use it. To
+ * update the vtables, build a new dictionary, attach it to builders
+ * as they become idle, and clear the old dictionary once no builder
+ * uses it.
+ *
+ * Vtables are keyed by the hash the builder computes while fields are
+ * added. Since that hash depends on the order in which fields are
+ * added, the simplest way to fill a dictionary is to build a few
+ * representative buffers with vtable cache retention enabled and then
+ * import the builder's cache with `flatcc_builder_export_vtable_cache`.
+ *
+ * Example:
+ *
+ *     flatcc_vtable_dict_t dict;
+ *
+ *     flatcc_vtable_dict_init(&dict);
+ *     flatcc_builder_set_vtable_cache_retention(B, 1);
+ *     ... build representative buffers with B ...
+ *     flatcc_builder_export_vtable_cache(B, &dict);
+ *     flatcc_vtable_dict_freeze(&dict);
+ *     ... for each builder in each thread:
+ *     flatcc_builder_set_vtable_dict(B2, &dict);
+ */
+
+#ifndef FLATCC_VTABLE_DICT_H
+#define FLATCC_VTABLE_DICT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h>
+
+#include "flatcc/flatcc_types.h"
+
+typedef struct flatcc_vtable_dict flatcc_vtable_dict_t;
+typedef struct flatcc_vtable_dict_entry flatcc_vtable_dict_entry_t;
+
+struct flatcc_vtable_dict_entry {
+    uint32_t hash;
+    flatbuffers_voffset_t size;
+    /* Offsets of the native and the protocol endian copy in `data`. */
+    size_t vt;
+    size_t vt_pe;
+};
+
+/* All fields are private. */
+struct flatcc_vtable_dict {
+    flatcc_vtable_dict_entry_t *entries;
+    size_t count;
+    size_t entries_size;
+    uint8_t *data;
+    size_t data_len;
+    size_t data_size;
+    /* Entry index + 1 for each slot, or 0. Null until frozen. */
+    uint32_t *slots;
+    size_t slot_mask;
+};
+
+/* Does not allocate memory. */
+static inline int flatcc_vtable_dict_init(flatcc_vtable_dict_t *D)
+{
+    memset(D, 0, sizeof(*D));
+    return 0;
+}
+
+/* Releases all memory. The dictionary can then be reused. */
+void flatcc_vtable_dict_clear(flatcc_vtable_dict_t *D);
+
+/*
+ * Adds a vtable in native endian format with the hash the builder
+ * computes for it. `vt_size` is the vtable size in bytes which must
+ * also be stored in `vt[0]`. Adding the same vtable twice is harmless.
+ *
+ * Returns 0 on success, -1 on allocation failure, invalid vtable, or if
+ * the dictionary is frozen.
+ */
+int flatcc_vtable_dict_add(flatcc_vtable_dict_t *D,
+        const flatbuffers_voffset_t *vt, flatbuffers_voffset_t vt_size, uint32_t vt_hash);
+
+/*
+ * Builds the lookup table. Afterwards the dictionary is read only and
+ * can be attached to builders. Returns 0 on success, -1 on failure.
+ */
+int flatcc_vtable_dict_freeze(flatcc_vtable_dict_t *D);
+
+static inline int flatcc_vtable_dict_is_frozen(const flatcc_vtable_dict_t *D)
+{
+    return D->slots != 0;
+}
+
+static inline size_t flatcc_vtable_dict_count(const flatcc_vtable_dict_t *D)
+{
+    return D->count;
+}
+
+/*
+ * Returns the index of a native endian vtable with the given hash, or
+ * -1 if not found or if the dictionary is not frozen.
+ */
+static inline int flatcc_vtable_dict_find(const flatcc_vtable_dict_t *D,
+        const flatbuffers_voffset_t *vt, flatbuffers_voffset_t vt_size, uint32_t vt_hash)
+{
+    const flatcc_vtable_dict_entry_t *e;
+    size_t i;
+    uint32_t k;
+
+    if (!D->slots) {
+        return -1;
+    }
+    i = (size_t)(vt_hash ^ (vt_hash >> 16)) & D->slot_mask;
+    while ((k = D->slots[i])) {
+        e = D->entries + k - 1;
+        if (e->hash == vt_hash && e->size == vt_size && 0 == memcmp(D->data + e->vt, vt, vt_size)) {
+            return (int)(k - 1);
+        }
+        i = (i + 1) & D->slot_mask;
+    }
+    return -1;
+}
+
+/* The protocol endian vtable at `index`, ready to be emitted. */
+static inline const void *flatcc_vtable_dict_get_pe(const flatcc_vtable_dict_t *D, int index)
+{
+    return D->data + D->entries[index].vt_pe;
+}
+
+static inline flatbuffers_voffset_t flatcc_vtable_dict_get_size(const flatcc_vtable_dict_t *D, int index)
+{
+    return D->entries[index].size;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLATCC_VTABLE_DICT_H */
@@ -0,0 +1,192 @@
+/*
+ * Converts newline delimited JSON (NDJSON, JSON Lines) with one Monster
+ * per line into back-to-back size prefixed Monster buffers using several
+ * threads. Replace the schema and root type to convert other data.
+ *
+ * Usage: ndjson [-j <threads>] [-i] <input.json> <output.bin>
+ *
+ * `-i` parses with the JSON parser index which can be faster for long
+ * strings. Without arguments, a generated input is converted serially
+ * and in parallel and the results are compared.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "monster_json_parser.h"
+#include "monster_verifier.h"
+#include "flatcc/support/readfile.h"
+#include "flatcc/support/elapsed.h"
+
+#undef ns
+#define ns(x) FLATBUFFERS_WRAP_NAMESPACE(MyGame_Sample, x)
+
+typedef struct output {
+    FILE *fp;
+    /* Used when `fp` is null. */
+    char *buf;
+    size_t size;
+    size_t capacity;
+} output_t;
+
+static int write_output(void *context, const void *data, size_t size)
+{
+    output_t *out = context;
+    char *p;
+
+    if (out->fp) {
+        return fwrite(data, 1, size, out->fp) == size ? 0 : -1;
+    }
+    if (size > out->capacity - out->size) {
+        out->capacity = 2 * (out->size + size);
+        if (!(p = realloc(out->buf, out->capacity))) {
+            return -1;
+        }
+        out->buf = p;
+    }
+    memcpy(out->buf + out->size, data, size);
+    out->size += size;
+    return 0;
+}
+
+static int convert(flatcc_json_parser_parallel_lines_t *P, const char *json, size_t size, output_t *out)
+{
+    int ret;
+
+    if ((ret = flatcc_json_parser_parallel_lines(P, json, size, write_output, out))) {
+        fprintf(stderr, "conversion failed\n");
+        return ret;
+    }
+    if (P->error_count) {
+        fprintf(stderr, "%lu records failed, first at %d:%d: %s\n",
+                (unsigned long)P->error_count, P->error_line, P->error_pos,
+                flatcc_json_parser_error_string(P->error));
+    }
+    return 0;
+}
+
+/* Records on every 1000th line fail. */
+static char *generate(int count, size_t *size)
+{
+    char *json, *p;
+    int i;
+
+    if (!(json = p = malloc((size_t)count * 200))) {
+        return 0;
+    }
+    for (i = 0; i < count; ++i) {
+        if (i % 1000 == 999) {
+            p += sprintf(p, "{ \"name\": \"broken %d\", \"hp\": }\n", i);
+            continue;
+        }
+        p += sprintf(p, "{ \"name\": \"monster %d\", \"hp\": %d, \"pos\": { \"x\": 1, \"y\": 2, \"z\": %d }, "
+                "\"inventory\": [1, 2, 3], \"color\": \"Red\", \"equipped_type\": \"Weapon\", "
+                "\"equipped\": { \"name\": \"sword\", \"damage\": %d } }\n", i, i % 300, i, i % 7);
+    }
+    *size = (size_t)(p - json);
+    return json;
+}
+
+static int self_test(void)
+{
+    flatcc_json_parser_parallel_lines_t P;
+    flatcc_verifier_threads_t threads = { 4 };
+    flatcc_verifier_stream_t S;
+    output_t serial = { 0 }, parallel = { 0 };
+    size_t size;
+    char *json;
+    double t1, t2, t3;
+    int ret = -1, count = 100000;
+
+    if (!(json = generate(count, &size))) {
+        return -1;
+    }
+    flatcc_json_parser_parallel_lines_init(&P, ns(Monster_file_identifier), ns(Monster_parse_json_table));
+    t1 = elapsed_realtime();
+    if (convert(&P, json, size, &serial)) {
+        goto done;
+    }
+    t2 = elapsed_realtime();
+    /* Small chunks and batches to test ordering across many of both. */
+    P.chunk_size = 64 * 1024;
+    P.batch_size = 8;
+    P.parallel_for = flatcc_verifier_parallel_for_threads;
+    P.pool = &threads;
+    if (convert(&P, json, size, &parallel)) {
+        goto done;
+    }
+    t3 = elapsed_realtime();
+    printf("converted %lu bytes: serial %.1f MB/s, %d threads %.1f MB/s\n", (unsigned long)size,
+            (double)size / 1e6 / (t2 - t1), threads.thread_count, (double)size / 1e6 / (t3 - t2));
+    if (P.record_count != (size_t)(count - count / 1000) || P.error_count != (size_t)count / 1000 ||
+            P.error_line != 1000 || P.error != flatcc_json_parser_error_expected_scalar) {
+        fprintf(stderr, "unexpected record or error count\n");
+        goto done;
+    }
+    if (serial.size != parallel.size || memcmp(serial.buf, parallel.buf, serial.size)) {
+        fprintf(stderr, "parallel output differs from serial output\n");
+        goto done;
+    }
+    ns(Monster_verifier_stream_init(&S));
+    ret = flatcc_verify_stream(&S, parallel.buf, parallel.size);
+    if (ret || S.record_count != P.record_count || S.error_count) {
+        fprintf(stderr, "output stream does not verify\n");
+        ret = -1;
+    }
+    flatcc_verifier_stream_clear(&S);
+done:
+    free(json);
+    free(serial.buf);
+    free(parallel.buf);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    flatcc_json_parser_parallel_lines_t P;
+    flatcc_verifier_threads_t threads = { 8 };
+    output_t out = { 0 };
+    char *json;
+    size_t size;
+    int i = 1, ret;
+
+    if (argc == 1) {
+        ret = self_test();
+        printf("ndjson self test %s\n", ret ? "failed" : "passed");
+        return ret ? -1 : 0;
+    }
+    flatcc_json_parser_parallel_lines_init(&P, ns(Monster_file_identifier), ns(Monster_parse_json_table));
+    P.parallel_for = flatcc_verifier_parallel_for_threads;
+    P.pool = &threads;
+    for (; i < argc && argv[i][0] == '-'; ++i) {
+        if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+            threads.thread_count = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-i")) {
+            P.flags |= flatcc_json_parser_f_with_index;
+        } else {
+            break;
+        }
+    }
+    if (argc - i != 2) {
+        fprintf(stderr, "usage: ndjson [-j <threads>] [-i] <input.json> <output.bin>\n");
+        return -1;
+    }
+    if (!(json = readfile(argv[i], (size_t)-1, &size))) {
+        fprintf(stderr, "could not read input: %s\n", argv[i]);
+        return -1;
+    }
+    if (!(out.fp = fopen(argv[i + 1], "wb"))) {
+        fprintf(stderr, "could not open output: %s\n", argv[i + 1]);
+        free(json);
+        return -1;
+    }
+    ret = convert(&P, json, size, &out);
+    if (fclose(out.fp)) {
+        ret = -1;
+    }
+    free(json);
+    if (!ret) {
+        printf("converted %lu records\n", (unsigned long)P.record_count);
+    }
+    return ret || P.error_count ? -1 : 0;
+}
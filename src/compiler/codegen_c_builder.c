@@ -1269,7 +1269,7 @@ static void gen_builder_struct(fb_output_t *out, fb_compound_type_t *ct)
     }
 }
 
-static int get_create_table_arg_count(fb_compound_type_t *ct)
+static int get_create_table_arg_count(fb_compound_type_t *ct, int fixed_only)
 {
     fb_member_t *member;
     fb_symbol_t *sym;
@@ -1280,6 +1280,9 @@ static int get_create_table_arg_count(fb_compound_type_t *ct)
         if (member->metadata_flags & fb_f_deprecated) {
             continue;
         }
+        if (fixed_only && !(member->metadata_flags & fb_f_fixed)) {
+            continue;
+        }
         ++count;
     }
     return count;
@@ -1314,7 +1317,7 @@ static int gen_required_table_fields(fb_output_t *out, fb_compound_type_t *ct)
     fb_scoped_name_t snt;
 
     fb_clear(snt);
-    arg_count = get_create_table_arg_count(ct);
+    arg_count = get_create_table_arg_count(ct, 0);
     index = 0;
     fb_compound_name(ct, &snt);
     fprintf(out->fp, "static const %svoffset_t __%s_required[] = {", nsc, snt.text);
@@ -1342,7 +1345,7 @@ static int gen_required_table_fields(fb_output_t *out, fb_compound_type_t *ct)
     return index;
 }
 
-static int gen_builder_table_args(fb_output_t *out, fb_compound_type_t *ct, int arg_count, int is_macro)
+static int gen_builder_table_args(fb_output_t *out, fb_compound_type_t *ct, int arg_count, int is_macro, int fixed_only)
 {
     const char *nsc = out->nsc;
     fb_symbol_t *sym;
@@ -1360,6 +1363,9 @@ static int gen_builder_table_args(fb_output_t *out, fb_compound_type_t *ct, int
         if (member->metadata_flags & fb_f_deprecated) {
             continue;
         }
+        if (fixed_only && !(member->metadata_flags & fb_f_fixed)) {
+            continue;
+        }
         gen_comma(out, index++, arg_count, is_macro);
         switch (member->type.type) {
         case vt_compound_type_ref:
@@ -1431,9 +1437,9 @@ static int gen_builder_create_table_decl(fb_output_t *out, fb_compound_type_t *c
     fb_clear(snt);
     fb_compound_name(ct, &snt);
 
-    arg_count = get_create_table_arg_count(ct);
+    arg_count = get_create_table_arg_count(ct, 0);
     fprintf(out->fp, "#define __%s_formal_args ", snt.text);
-    gen_builder_table_args(out, ct, arg_count, 1);
+    gen_builder_table_args(out, ct, arg_count, 1, 0);
     fprintf(out->fp, "\n#define __%s_call_args ", snt.text);
     gen_builder_table_call_list(out, ct, arg_count, 1);
     fprintf(out->fp, "\n");
@@ -1492,6 +1498,362 @@ static int gen_builder_create_table(fb_output_t *out, fb_compound_type_t *ct)
     return 0;
 }
 
+static inline int is_fixed_offset_member(fb_member_t *member)
+{
+    switch (member->type.type) {
+    case vt_scalar_type:
+        return 0;
+    case vt_compound_type_ref:
+        return member->type.ct->symbol.kind == fb_is_table;
+    default:
+        return 1;
+    }
+}
+
+static void get_fixed_member_layout(fb_output_t *out, fb_member_t *member, unsigned *size, unsigned *align)
+{
+    if (member->type.type == vt_scalar_type) {
+        *size = (unsigned)sizeof_scalar_type(member->type.st);
+        *align = *size;
+    } else if (is_fixed_offset_member(member)) {
+        *size = (unsigned)out->opts->offset_size;
+        *align = *size;
+    } else {
+        /* Struct and enum sizes are only reliable on the type. */
+        *size = (unsigned)member->type.ct->size;
+        *align = member->type.ct->align;
+    }
+}
+
+static inline int is_fixed_member(fb_member_t *member)
+{
+    return (member->metadata_flags & (fb_f_fixed | fb_f_deprecated)) == fb_f_fixed;
+}
+
+/*
+ * Fixed fields are placed by decreasing alignment, then in schema order,
+ * so no padding is needed between fields.
+ */
+static unsigned get_fixed_member_offset(fb_output_t *out, fb_compound_type_t *ct, fb_member_t *target)
+{
+    fb_member_t *member;
+    fb_symbol_t *sym;
+    unsigned size, align, target_size, target_align, offset = 0;
+    int before = 1;
+
+    get_fixed_member_layout(out, target, &target_size, &target_align);
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (member == target) {
+            before = 0;
+        }
+        if (!is_fixed_member(member) || member == target) {
+            continue;
+        }
+        get_fixed_member_layout(out, member, &size, &align);
+        if (align > target_align || (align == target_align && before)) {
+            offset += size;
+        }
+    }
+    return offset;
+}
+
+/*
+ * Fields with the `fixed` attribute get a `_create_fixed` constructor
+ * that always stores exactly these fields. The table layout and vtable
+ * are computed here, so the generated code only fills a local table
+ * body and calls `flatcc_builder_create_table` with a constant vtable.
+ */
+static int gen_builder_create_fixed_table(fb_output_t *out, fb_compound_type_t *ct)
+{
+    const char *nsc = out->nsc;
+    fb_member_t *member;
+    fb_symbol_t *sym;
+    const char *tname, *tname_ns, *tprefix;
+    unsigned size, align, offset, table_size = 0, max_align = 0, max_id = 0;
+    int arg_count, offset_count = 0, has_struct = 0, index, id;
+    fb_scoped_name_t snt;
+    fb_scoped_name_t snref;
+
+    arg_count = get_create_table_arg_count(ct, 1);
+    if (arg_count == 0) {
+        return 0;
+    }
+    fb_clear(snt);
+    fb_clear(snref);
+    fb_compound_name(ct, &snt);
+
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (!is_fixed_member(member)) {
+            continue;
+        }
+        get_fixed_member_layout(out, member, &size, &align);
+        table_size += size;
+        if (align > max_align) {
+            max_align = align;
+        }
+        if (member->id > max_id) {
+            max_id = (unsigned)member->id;
+        }
+        if (is_fixed_offset_member(member)) {
+            ++offset_count;
+        }
+        if (member->type.type == vt_compound_type_ref && member->type.ct->symbol.kind == fb_is_struct) {
+            has_struct = 1;
+        }
+    }
+
+    fprintf(out->fp,
+            "/* Always stores all fixed fields, also when equal to default. */\n"
+            "static inline %s_ref_t %s_create_fixed(%sbuilder_t *B",
+            snt.text, snt.text, nsc);
+    gen_builder_table_args(out, ct, arg_count, 0, 1);
+    fprintf(out->fp, ")\n{\n");
+    /* The vtable has a header and an entry for each id up to the largest fixed id. */
+    fprintf(out->fp, "    static const %svoffset_t _vt[] = { %u, %u",
+            nsc, (max_id + 3) * (unsigned)out->opts->voffset_size,
+            table_size + (unsigned)out->opts->offset_size);
+    for (id = 0; id <= (int)max_id; ++id) {
+        offset = 0;
+        for (sym = ct->members; sym; sym = sym->link) {
+            member = (fb_member_t *)sym;
+            if (is_fixed_member(member) && (int)member->id == id) {
+                offset = get_fixed_member_offset(out, ct, member) + (unsigned)out->opts->offset_size;
+            }
+        }
+        fprintf(out->fp, ", %u", offset);
+    }
+    fprintf(out->fp, " };\n");
+    if (offset_count) {
+        fprintf(out->fp, "    static const %svoffset_t _offsets[] = {", nsc);
+        index = 0;
+        for (sym = ct->members; sym; sym = sym->link) {
+            member = (fb_member_t *)sym;
+            if (is_fixed_member(member) && is_fixed_offset_member(member)) {
+                fprintf(out->fp, "%s %u", index++ ? "," : "", get_fixed_member_offset(out, ct, member));
+            }
+        }
+        fprintf(out->fp, " };\n");
+    }
+    fprintf(out->fp,
+            "    uint64_t _d[%u];\n"
+            "    uint8_t *_p = (uint8_t *)_d;\n"
+            "    flatcc_builder_vt_ref_t _vt_ref;\n"
+            "    uint32_t _vt_hash;\n\n",
+            (table_size + 7u) / 8u);
+    if (offset_count) {
+        fprintf(out->fp, "    if (");
+        index = 0;
+        for (sym = ct->members; sym; sym = sym->link) {
+            member = (fb_member_t *)sym;
+            if (is_fixed_member(member) && is_fixed_offset_member(member)) {
+                fprintf(out->fp, "%s!v%"PRIu64"", index++ ? " || " : "", (uint64_t)member->id);
+            }
+        }
+        fprintf(out->fp, ") {\n        return 0;\n    }\n");
+    }
+    fprintf(out->fp, "    FLATCC_BUILDER_INIT_VT_HASH(_vt_hash);\n");
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (!is_fixed_member(member)) {
+            continue;
+        }
+        get_fixed_member_layout(out, member, &size, &align);
+        fprintf(out->fp, "    FLATCC_BUILDER_UPDATE_VT_HASH(_vt_hash, %"PRIu64", %u);\n",
+                (uint64_t)member->id, size);
+    }
+    fprintf(out->fp,
+            "    FLATCC_BUILDER_UPDATE_VT_HASH(_vt_hash, _vt[0], _vt[1]);\n"
+            "    if (!(_vt_ref = flatcc_builder_create_cached_vtable(B, _vt, (%svoffset_t)sizeof(_vt), _vt_hash))) {\n"
+            "        return 0;\n"
+            "    }\n",
+            nsc);
+    if (has_struct) {
+        /* Struct padding must not leak stack content. */
+        fprintf(out->fp, "    memset(_d, 0, sizeof(_d));\n");
+    }
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (!is_fixed_member(member)) {
+            continue;
+        }
+        offset = get_fixed_member_offset(out, ct, member);
+        if (member->type.type == vt_scalar_type) {
+            tname_ns = scalar_type_ns(member->type.st, nsc);
+            tname = scalar_type_name(member->type.st);
+            tprefix = scalar_type_prefix(member->type.st);
+            fprintf(out->fp, "    %s%s_assign_to_pe((%s%s *)(_p + %u), v%"PRIu64");\n",
+                    nsc, tprefix, tname_ns, tname, offset, (uint64_t)member->id);
+        } else if (is_fixed_offset_member(member)) {
+            fprintf(out->fp, "    *(%suoffset_t *)(_p + %u) = (%suoffset_t)v%"PRIu64";\n",
+                    nsc, offset, nsc, (uint64_t)member->id);
+        } else {
+            fb_compound_name(member->type.ct, &snref);
+            if (member->type.ct->symbol.kind == fb_is_enum) {
+                fprintf(out->fp, "    %s_assign_to_pe((%s_enum_t *)(_p + %u), v%"PRIu64");\n",
+                        snref.text, snref.text, offset, (uint64_t)member->id);
+            } else {
+                fprintf(out->fp, "    %s_copy_to_pe((%s_t *)(_p + %u), v%"PRIu64");\n",
+                        snref.text, snref.text, offset, (uint64_t)member->id);
+            }
+        }
+    }
+    fprintf(out->fp,
+            "    return flatcc_builder_create_table(B, _d, %u, %u, %s%s%s, %d, _vt_ref);\n"
+            "}\n\n",
+            table_size, max_align, offset_count ? "(" : "", offset_count ? nsc : "",
+            offset_count ? "voffset_t *)_offsets" : "0", offset_count);
+    return 0;
+}
+
+/* Rows hold scalars and references, but not structs or unions. */
+static inline int is_row_member(fb_member_t *member)
+{
+    if (member->metadata_flags & fb_f_deprecated) {
+        return 0;
+    }
+    switch (member->type.type) {
+    case vt_scalar_type:
+    case vt_vector_type:
+    case vt_string_type:
+    case vt_vector_string_type:
+        return 1;
+    case vt_compound_type_ref:
+        return member->type.ct->symbol.kind == fb_is_enum || member->type.ct->symbol.kind == fb_is_table;
+    case vt_vector_compound_type_ref:
+        return member->type.ct->symbol.kind != fb_is_union;
+    default:
+        return 0;
+    }
+}
+
+static unsigned get_row_member_size(fb_output_t *out, fb_member_t *member)
+{
+    unsigned size, align;
+
+    get_fixed_member_layout(out, member, &size, &align);
+    return size;
+}
+
+/*
+ * Tables with the `rows` attribute get a row struct with a value for
+ * each eligible field. The `_vec_create_rows` call builds a vector of
+ * tables from an array of rows with presence bits using
+ * `flatcc_builder_create_table_vector`.
+ */
+static int gen_builder_create_rows(fb_output_t *out, fb_compound_type_t *ct)
+{
+    const char *nsc = out->nsc;
+    fb_member_t *member;
+    fb_symbol_t *sym;
+    const char *tname, *tname_ns;
+    unsigned size;
+    int n, index, field_count = 0, flags;
+    const char *s;
+    fb_scoped_name_t snt;
+    fb_scoped_name_t snref;
+
+    if (!(ct->metadata_flags & fb_f_rows)) {
+        return 0;
+    }
+    for (sym = ct->members; sym; sym = sym->link) {
+        if (is_row_member((fb_member_t *)sym)) {
+            ++field_count;
+        }
+    }
+    if (field_count == 0) {
+        return 0;
+    }
+    fb_clear(snt);
+    fb_clear(snref);
+    fb_compound_name(ct, &snt);
+
+    fprintf(out->fp,
+            "typedef struct %s_row %s_row_t;\n"
+            "struct %s_row {\n",
+            snt.text, snt.text, snt.text);
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (!is_row_member(member)) {
+            continue;
+        }
+        symbol_name(&member->symbol, &n, &s);
+        switch (member->type.type) {
+        case vt_scalar_type:
+            tname_ns = scalar_type_ns(member->type.st, nsc);
+            tname = scalar_type_name(member->type.st);
+            fprintf(out->fp, "    %s%s %.*s;\n", tname_ns, tname, n, s);
+            break;
+        case vt_vector_type:
+            tname = scalar_type_prefix(member->type.st);
+            fprintf(out->fp, "    %s%s_vec_ref_t %.*s;\n", nsc, tname, n, s);
+            break;
+        case vt_string_type:
+            fprintf(out->fp, "    %sstring_ref_t %.*s;\n", nsc, n, s);
+            break;
+        case vt_vector_string_type:
+            fprintf(out->fp, "    %sstring_vec_ref_t %.*s;\n", nsc, n, s);
+            break;
+        case vt_compound_type_ref:
+            fb_compound_name(member->type.ct, &snref);
+            fprintf(out->fp, "    %s_%s %.*s;\n", snref.text,
+                    member->type.ct->symbol.kind == fb_is_enum ? "enum_t" : "ref_t",
+                    n, s);
+            break;
+        case vt_vector_compound_type_ref:
+            fb_compound_name(member->type.ct, &snref);
+            fprintf(out->fp, "    %s_vec_ref_t %.*s;\n", snref.text, n, s);
+            break;
+        default:
+            gen_panic(out, "internal error: unexpected row member type");
+            continue;
+        }
+    }
+    fprintf(out->fp, "};\n");
+    fprintf(out->fp,
+            "#define %s_row_present_words %u\n",
+            snt.text, (unsigned)((ct->count + 31) / 32));
+    fprintf(out->fp,
+            "/* `present` has `_row_present_words` per row with a bit per field id, or is null. */\n"
+            "static inline %s_vec_ref_t %s_vec_create_rows(%sbuilder_t *B,\n"
+            "        const %s_row_t *rows, const uint32_t *present, size_t count)\n{\n"
+            "    static const flatcc_builder_row_field_t _fields[] = {",
+            snt.text, snt.text, nsc, snt.text);
+    /* Fields are packed by decreasing size, then in schema order. */
+    index = 0;
+    for (size = 8; size > 0; size /= 2) {
+        for (sym = ct->members; sym; sym = sym->link) {
+            member = (fb_member_t *)sym;
+            if (!is_row_member(member) || get_row_member_size(out, member) != size) {
+                continue;
+            }
+            symbol_name(&member->symbol, &n, &s);
+            flags = 0;
+            if (member->type.type != vt_scalar_type &&
+                    !(member->type.type == vt_compound_type_ref && member->type.ct->symbol.kind == fb_is_enum)) {
+                /* flatcc_builder_row_is_offset */
+                flags |= 1;
+            }
+            if (member->metadata_flags & fb_f_required) {
+                /* flatcc_builder_row_is_required */
+                flags |= 2;
+            }
+            fprintf(out->fp, "%s\n        { offsetof(%s_row_t, %.*s), %u, %u, %d }",
+                    index++ ? "," : "", snt.text, n, s,
+                    (unsigned)member->id, size, flags);
+        }
+    }
+    fprintf(out->fp,
+            " };\n"
+            "    static const flatcc_builder_row_layout_t _layout = {\n"
+            "        _fields, %d, %u, sizeof(%s_row_t) };\n\n"
+            "    return flatcc_builder_create_table_vector(B, &_layout, rows, present, count);\n"
+            "}\n\n",
+            field_count, (unsigned)ct->count, snt.text);
+    return 0;
+}
+
 static int gen_builder_structs(fb_output_t *out)
 {
     fb_compound_type_t *ct;
@@ -2126,6 +2488,8 @@ static int gen_builder_tables(fb_output_t *out)
         case fb_is_table:
             gen_builder_table_fields(out, (fb_compound_type_t *)sym);
             gen_builder_create_table(out, (fb_compound_type_t *)sym);
+            gen_builder_create_fixed_table(out, (fb_compound_type_t *)sym);
+            gen_builder_create_rows(out, (fb_compound_type_t *)sym);
             gen_builder_clone_table(out, (fb_compound_type_t *)sym);
             fprintf(out->fp, "\n");
             break;
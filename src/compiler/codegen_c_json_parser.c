@@ -1531,6 +1531,15 @@ static int gen_table_parser(fb_output_t *out, fb_compound_type_t *ct)
             snt.text);
     unindent(); println(out, "}");
     println(out, "");
+    println(out, "static inline int %s_parse_json_lines(flatcc_builder_t *B, flatcc_json_parser_t *ctx, const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,", snt.text);
+    indent(); indent();
+    println(out, "flatcc_json_parser_record_f *record, void *context)");
+    unindent(); unindent();
+    println(out, "{"); indent();
+    println(out, "return flatcc_json_parser_table_lines(B, ctx, buf, bufsiz, flags, fid, %s_parse_json_table, record, context);",
+            snt.text);
+    unindent(); println(out, "}");
+    println(out, "");
     clear_dict(trie.dict);
     return 0;
 }
@@ -1673,7 +1682,11 @@ static int gen_root_table_parser(fb_output_t *out, fb_compound_type_t *ct)
     } else {
         println(out, "if (flatcc_builder_start_buffer(B, 0, 0, 0)) return -1;");
     }
+    println(out, "if (flags & flatcc_json_parser_f_with_index) {"); indent();
+    println(out, "flatcc_json_parser_build_index(ctx);");
+    unindent(); println(out, "}");
     println(out, "%s_parse_json_table(ctx, buf, buf + bufsiz, &root);", snt.text);
+    println(out, "flatcc_json_parser_clear_index(ctx);");
     println(out, "if (ctx->error) {"); indent();
     println(out, "return ctx->error;");
     unindent(); println(out, "}");
@@ -1708,7 +1721,11 @@ static int gen_root_struct_parser(fb_output_t *out, fb_compound_type_t *ct)
     } else {
         println(out, "if (flatcc_builder_start_buffer(B, 0, 0, 0)) return -1;");
     }
+    println(out, "if ((flatcc_json_parser_flags_t)flags & flatcc_json_parser_f_with_index) {"); indent();
+    println(out, "flatcc_json_parser_build_index(ctx);");
+    unindent(); println(out, "}");
     println(out, "buf = %s_parse_json_struct(ctx, buf, buf + bufsiz, &root);", snt.text);
+    println(out, "flatcc_json_parser_clear_index(ctx);");
     println(out, "if (ctx->error) {"); indent();
     println(out, "return ctx->error;");
     unindent(); println(out, "}");
@@ -547,6 +547,16 @@ static void gen_helpers(fb_output_t *out)
         "    }\\\n"
         "}\n",
         nsc, nsc, nsc, nsc, nsc, nsc, nsc);
+    fprintf(out->fp,
+        "#define __%sread_ix(ID, offset, ix)\\\n"
+        "%svoffset_t offset = 0;\\\n"
+        "{   FLATCC_ASSERT(ix != 0 && (ix)->table != 0 && \"null pointer table access\");\\\n"
+        "    FLATCC_ASSERT((ID) < (ix)->field_count && \"field not in table index\");\\\n"
+        "    if ((ID) < (ix)->field_count) {\\\n"
+        "        offset = (ix)->fields[ID];\\\n"
+        "    }\\\n"
+        "}\n",
+        nsc, nsc);
     fprintf(out->fp,
             "#define __%sfield_present(ID, t) { __%sread_vt(ID, offset__tmp, t) return offset__tmp != 0; }\n",
             nsc, nsc);
@@ -565,7 +575,11 @@ static void gen_helpers(fb_output_t *out)
         "static inline T N ## _ ## NK ## _get(N ## _table_t t__tmp)\\\n"
         "{ __%sread_vt(ID, offset__tmp, t__tmp)\\\n"
         "  return offset__tmp ? __%sread_scalar_at_byteoffset(TK, t__tmp, offset__tmp) : V;\\\n"
-        "}\\\n", nsc, nsc, nsc);
+        "}\\\n"
+        "static inline T N ## _ ## NK ## _indexed(const flatcc_table_index_t *ix__tmp)\\\n"
+        "{ __%sread_ix(ID, offset__tmp, ix__tmp)\\\n"
+        "  return offset__tmp ? __%sread_scalar_at_byteoffset(TK, ix__tmp->table, offset__tmp) : V;\\\n"
+        "}\\\n", nsc, nsc, nsc, nsc, nsc);
     if (!out->opts->cgen_no_conflicts) {
         fprintf(out->fp,
             "static inline T N ## _ ## NK(N ## _table_t t__tmp)\\\n"
@@ -622,10 +636,37 @@ static void gen_helpers(fb_output_t *out)
         "#define __%svector_field(T, ID, t, r) __%soffset_field(T, ID, t, r, sizeof(%suoffset_t))\n"
         "#define __%stable_field(T, ID, t, r) __%soffset_field(T, ID, t, r, 0)\n",
         nsc, nsc, nsc, nsc, nsc);
+    fprintf(out->fp,
+        "#define __%sindexed_struct_field(T, ID, ix, r)\\\n"
+        "{\\\n"
+        "    __%sread_ix(ID, offset__tmp, ix)\\\n"
+        "    if (offset__tmp) {\\\n"
+        "        return (T)((uint8_t *)(ix)->table + offset__tmp);\\\n"
+        "    }\\\n"
+        "    FLATCC_ASSERT(!(r) && \"required field missing\");\\\n"
+        "    return 0;\\\n"
+        "}\n",
+        nsc, nsc);
+    fprintf(out->fp,
+        "#define __%sindexed_offset_field(T, ID, ix, r, adjust)\\\n"
+        "{\\\n"
+        "    %suoffset_t *elem__tmp;\\\n"
+        "    __%sread_ix(ID, offset__tmp, ix)\\\n"
+        "    if (offset__tmp) {\\\n"
+        "        elem__tmp = (%suoffset_t *)((uint8_t *)(ix)->table + offset__tmp);\\\n"
+        "        return (T)((uint8_t *)(elem__tmp) + adjust +\\\n"
+        "              __%suoffset_read_from_pe(elem__tmp));\\\n"
+        "    }\\\n"
+        "    FLATCC_ASSERT(!(r) && \"required field missing\");\\\n"
+        "    return 0;\\\n"
+        "}\n",
+        nsc, nsc, nsc, nsc, nsc);
     fprintf(out->fp,
         "#define __%sdefine_struct_field(ID, N, NK, T, r)\\\n"
         "static inline T N ## _ ## NK ## _get(N ## _table_t t__tmp)\\\n"
-        "__%sstruct_field(T, ID, t__tmp, r)", nsc, nsc);
+        "__%sstruct_field(T, ID, t__tmp, r)\\\n"
+        "static inline T N ## _ ## NK ## _indexed(const flatcc_table_index_t *ix__tmp)\\\n"
+        "__%sindexed_struct_field(T, ID, ix__tmp, r)", nsc, nsc, nsc);
     if (!out->opts->cgen_no_conflicts) {
         fprintf(out->fp,
             "\\\nstatic inline T N ## _ ## NK(N ## _table_t t__tmp)\\\n"
@@ -637,7 +678,9 @@ static void gen_helpers(fb_output_t *out)
     fprintf(out->fp,
         "#define __%sdefine_vector_field(ID, N, NK, T, r)\\\n"
         "static inline T N ## _ ## NK ## _get(N ## _table_t t__tmp)\\\n"
-        "__%svector_field(T, ID, t__tmp, r)", nsc, nsc);
+        "__%svector_field(T, ID, t__tmp, r)\\\n"
+        "static inline T N ## _ ## NK ## _indexed(const flatcc_table_index_t *ix__tmp)\\\n"
+        "__%sindexed_offset_field(T, ID, ix__tmp, r, sizeof(%suoffset_t))", nsc, nsc, nsc, nsc);
     if (!out->opts->cgen_no_conflicts) {
         fprintf(out->fp,
             "\\\nstatic inline T N ## _ ## NK(N ## _table_t t__tmp)\\\n"
@@ -649,7 +692,10 @@ static void gen_helpers(fb_output_t *out)
     fprintf(out->fp,
         "#define __%sdefine_table_field(ID, N, NK, T, r)\\\n"
         "static inline T N ## _ ## NK ## _get(N ## _table_t t__tmp)\\\n"
-        "__%stable_field(T, ID, t__tmp, r)", nsc, nsc);
+        "__%stable_field(T, ID, t__tmp, r)\\\n"
+        "static inline T N ## _ ## NK ## _indexed(const flatcc_table_index_t *ix__tmp)\\\n"
+        "__%sindexed_offset_field(T, ID, ix__tmp, r, 0)\\\n"
+        "enum { N ## _ ## NK ## _field_id = ID };", nsc, nsc, nsc);
     if (!out->opts->cgen_no_conflicts) {
         fprintf(out->fp,
             "\\\nstatic inline T N ## _ ## NK(N ## _table_t t__tmp)\\\n"
@@ -661,7 +707,10 @@ static void gen_helpers(fb_output_t *out)
     fprintf(out->fp,
         "#define __%sdefine_string_field(ID, N, NK, r)\\\n"
         "static inline %sstring_t N ## _ ## NK ## _get(N ## _table_t t__tmp)\\\n"
-        "__%svector_field(%sstring_t, ID, t__tmp, r)", nsc, nsc, nsc, nsc);
+        "__%svector_field(%sstring_t, ID, t__tmp, r)\\\n"
+        "static inline %sstring_t N ## _ ## NK ## _indexed(const flatcc_table_index_t *ix__tmp)\\\n"
+        "__%sindexed_offset_field(%sstring_t, ID, ix__tmp, r, sizeof(%suoffset_t))",
+        nsc, nsc, nsc, nsc, nsc, nsc, nsc, nsc);
     if (!out->opts->cgen_no_conflicts) {
         fprintf(out->fp,
         "\\\nstatic inline %sstring_t N ## _ ## NK(N ## _table_t t__tmp)\\\n"
@@ -1595,6 +1644,7 @@ static void gen_table(fb_output_t *out, fb_compound_type_t *ct)
     fb_scoped_name_t snref;
     fb_literal_t literal;
     int is_optional;
+    uint64_t field_count = 0;
 
     assert(ct->symbol.kind == fb_is_table);
 
@@ -1623,6 +1673,16 @@ static void gen_table(fb_output_t *out, fb_compound_type_t *ct)
     fprintf(out->fp,
             "__%stable_as_root(%s)\n",
             nsc, snt.text);
+    /* Size of `flatcc_table_index_t` fields needed by `_indexed` readers. */
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (member->id + 1 > field_count) {
+            field_count = member->id + 1;
+        }
+    }
+    fprintf(out->fp,
+            "#define %s_field_count %"PRIu64"\n",
+            snt.text, field_count);
     fprintf(out->fp, "\n");
 
     for (sym = ct->members; sym; sym = sym->link) {
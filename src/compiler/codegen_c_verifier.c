@@ -89,6 +89,216 @@ static int gen_union_verifier(fb_output_t *out, fb_compound_type_t *ct)
     return 0;
 }
 
+static int gen_union_verifier_type(fb_output_t *out, fb_compound_type_t *ct)
+{
+    fb_symbol_t *sym;
+    fb_member_t *member;
+    fb_scoped_name_t snt, snref;
+    uint64_t i, count = 0;
+    int n;
+    const char *s;
+
+    fb_clear(snt);
+    fb_clear(snref);
+    fb_compound_name(ct, &snt);
+
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (member->type.type != vt_missing && member->value.u >= count) {
+            count = member->value.u + 1;
+        }
+    }
+    fprintf(out->fp,
+            "static const flatcc_verifier_union_type_t *%s_union_verifier_type(void)\n{\n",
+            snt.text);
+    if (count == 0) {
+        fprintf(out->fp,
+                "    static const flatcc_verifier_union_type_t type = { 0, 0 };\n"
+                "    return &type;\n}\n\n");
+        return 0;
+    }
+    fprintf(out->fp, "    static const flatcc_verifier_union_member_t members[] = {\n");
+    /* Members are indexed by type, unused types are unknown. */
+    for (i = 0; i < count; ++i) {
+        for (sym = ct->members; sym; sym = sym->link) {
+            member = (fb_member_t *)sym;
+            if (member->type.type != vt_missing && member->value.u == i) {
+                break;
+            }
+        }
+        if (!sym) {
+            fprintf(out->fp, "        { flatcc_verifier_op_none, 0, 0, 0, 0 },\n");
+            continue;
+        }
+        symbol_name(sym, &n, &s);
+        switch (member->type.type) {
+        case vt_compound_type_ref:
+            fb_compound_name(member->type.ct, &snref);
+            switch (member->type.ct->symbol.kind) {
+            case fb_is_table:
+                fprintf(out->fp,
+                        "        { flatcc_verifier_op_table, 0, 0, %s_table_verifier_type, 0 }, /* %.*s */\n",
+                        snref.text, n, s);
+                continue;
+            case fb_is_struct:
+                fprintf(out->fp,
+                        "        { flatcc_verifier_op_struct, %"PRIu16", %"PRIu64", 0, 0 }, /* %.*s */\n",
+                        member->type.ct->align, member->type.ct->size, n, s);
+                continue;
+            default:
+                gen_panic(out, "internal error: unexpected compound type for union verifier");
+                return -1;
+            }
+        case vt_string_type:
+            fprintf(out->fp,
+                    "        { flatcc_verifier_op_string, 0, 0, 0, 0 }, /* %.*s */\n", n, s);
+            continue;
+        default:
+            gen_panic(out, "internal error: unexpected type for union verifier");
+            return -1;
+        }
+    }
+    fprintf(out->fp,
+            "    };\n"
+            "    static const flatcc_verifier_union_type_t type = { members, %"PRIu64" };\n"
+            "    return &type;\n}\n\n", count);
+    return 0;
+}
+
+static int gen_table_verifier_type(fb_output_t *out, fb_compound_type_t *ct)
+{
+    fb_symbol_t *sym;
+    fb_member_t *member;
+    fb_scoped_name_t snt, snref;
+    const char *op;
+    int required, count = 0;
+
+    fb_clear(snt);
+    fb_clear(snref);
+    fb_compound_name(ct, &snt);
+
+    fprintf(out->fp,
+            "static const flatcc_verifier_table_type_t *%s_table_verifier_type(void)\n{\n",
+            snt.text);
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (member->metadata_flags & fb_f_deprecated) {
+            continue;
+        }
+        if (count++ == 0) {
+            fprintf(out->fp, "    static const flatcc_verifier_field_t fields[] = {\n");
+        }
+        required = (member->metadata_flags & fb_f_required) != 0;
+        fprintf(out->fp, "        { %"PRIu64", ", member->id);
+        switch (member->type.type) {
+        case vt_scalar_type:
+            fprintf(out->fp, "flatcc_verifier_op_field, 0, %"PRIu16", %"PRIu64", 0, 0, 0, 0, 0 },",
+                    member->align, member->size);
+            break;
+        case vt_vector_type:
+            if (member->nest) {
+                fb_compound_name((fb_compound_type_t *)&member->nest->symbol, &snref);
+                if (member->nest->symbol.kind == fb_is_table) {
+                    fprintf(out->fp, "flatcc_verifier_op_nested_table, %d, %"PRIu16", 0, 0, %s_table_verifier_type, 0, 0, 0 },",
+                            required, member->align, snref.text);
+                } else {
+                    fprintf(out->fp, "flatcc_verifier_op_nested_struct, %d, %"PRIu16", %"PRIu64", 0, 0, 0, 0, 0 },",
+                            required, member->align, member->size);
+                }
+            } else {
+                fprintf(out->fp, "flatcc_verifier_op_vector, %d, %"PRIu16", %"PRIu64", UINT64_C(%"PRIu64"), 0, 0, 0, 0 },",
+                        required, member->align, member->size, (uint64_t)FLATBUFFERS_COUNT_MAX(member->size));
+            }
+            break;
+        case vt_string_type:
+        case vt_vector_string_type:
+            op = member->type.type == vt_string_type ? "string" : "string_vector";
+            fprintf(out->fp, "flatcc_verifier_op_%s, %d, 0, 0, 0, 0, 0, 0, 0 },", op, required);
+            break;
+        case vt_compound_type_ref:
+            fb_compound_name(member->type.ct, &snref);
+            switch (member->type.ct->symbol.kind) {
+            case fb_is_enum:
+            case fb_is_struct:
+                fprintf(out->fp, "flatcc_verifier_op_field, 0, %"PRIu16", %"PRIu64", 0, 0, 0, 0, 0 },",
+                        member->align, member->size);
+                break;
+            case fb_is_table:
+                fprintf(out->fp, "flatcc_verifier_op_table, %d, 0, 0, 0, %s_table_verifier_type, 0, 0, 0 },",
+                        required, snref.text);
+                break;
+            case fb_is_union:
+                fprintf(out->fp, "flatcc_verifier_op_union, %d, 0, 0, 0, 0, %s_union_verifier_type, 0, 0 },",
+                        required, snref.text);
+                break;
+            default:
+                gen_panic(out, "internal error: unexpected compound type for table verifier");
+                return -1;
+            }
+            break;
+        case vt_vector_compound_type_ref:
+            fb_compound_name(member->type.ct, &snref);
+            switch (member->type.ct->symbol.kind) {
+            case fb_is_table:
+                fprintf(out->fp, "flatcc_verifier_op_table_vector, %d, 0, 0, 0, %s_table_verifier_type, 0, 0, 0 },",
+                        required, snref.text);
+                break;
+            case fb_is_enum:
+            case fb_is_struct:
+                fprintf(out->fp, "flatcc_verifier_op_vector, %d, %"PRIu16", %"PRIu64", UINT64_C(%"PRIu64"), 0, 0, 0, 0 },",
+                        required, member->align, member->size, (uint64_t)FLATBUFFERS_COUNT_MAX(member->size));
+                break;
+            case fb_is_union:
+                fprintf(out->fp, "flatcc_verifier_op_union_vector, %d, 0, 0, 0, 0, %s_union_verifier_type, 0, 0 },",
+                        required, snref.text);
+                break;
+            default:
+                gen_panic(out, "internal error: unexpected vector compound type for table verifier");
+                return -1;
+            }
+            break;
+        default:
+            gen_panic(out, "internal error: unexpected table member type");
+            return -1;
+        }
+        fprintf(out->fp, " /* %.*s */\n", (int)sym->ident->len, sym->ident->text);
+    }
+    if (count) {
+        fprintf(out->fp,
+                "    };\n"
+                "    static const flatcc_verifier_table_type_t type = { fields, %d };\n", count);
+    } else {
+        fprintf(out->fp,
+                "    static const flatcc_verifier_table_type_t type = { 0, 0 };\n");
+    }
+    fprintf(out->fp, "    return &type;\n}\n\n");
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_iterative(const void *buf, size_t bufsiz)\n"
+            "{\n    return flatcc_verify_table_as_root_iterative(buf, bufsiz, %s_identifier, %s_table_verifier_type(), 0);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_size_iterative(const void *buf, size_t bufsiz)\n"
+            "{\n    return flatcc_verify_table_as_root_with_size_iterative(buf, bufsiz, %s_identifier, %s_table_verifier_type(), 0);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_parallel(const void *buf, size_t bufsiz, flatcc_verifier_parallel_for_f *parallel_for, void *pool)\n"
+            "{\n    return flatcc_verify_table_as_root_parallel(buf, bufsiz, %s_identifier, %s_table_verifier_type(), parallel_for, pool);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_size_parallel(const void *buf, size_t bufsiz, flatcc_verifier_parallel_for_f *parallel_for, void *pool)\n"
+            "{\n    return flatcc_verify_table_as_root_with_size_parallel(buf, bufsiz, %s_identifier, %s_table_verifier_type(), parallel_for, pool);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_lazy_verify_as_root(flatcc_lazy_verifier_t *L, const void *buf, size_t bufsiz)\n"
+            "{\n    return flatcc_lazy_verify_as_root(L, buf, bufsiz, %s_identifier, %s_table_verifier_type());\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_lazy_verify(flatcc_lazy_verifier_t *L, %s_table_t t)\n"
+            "{\n    return flatcc_lazy_verify_table(L, t, %s_table_verifier_type());\n}\n\n",
+            snt.text, snt.text, snt.text);
+    return 0;
+}
+
 static int gen_table_verifier(fb_output_t *out, fb_compound_type_t *ct)
 {
     fb_symbol_t *sym;
@@ -243,6 +453,34 @@ static int gen_table_verifier(fb_output_t *out, fb_compound_type_t *ct)
             "static inline int %s_verify_as_root_with_type_hash_and_size(const void *buf, size_t bufsiz, %sthash_t thash)\n"
             "{\n    return flatcc_verify_table_as_typed_root_with_size(buf, bufsiz, thash, &%s_verify_table);\n}\n\n",
             snt.text, nsc, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_memo(const void *buf, size_t bufsiz, flatcc_verifier_memo_t *memo)\n"
+            "{\n    return flatcc_verify_table_as_root_with_memo(buf, bufsiz, %s_identifier, &%s_verify_table, memo);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_size_and_memo(const void *buf, size_t bufsiz, flatcc_verifier_memo_t *memo)\n"
+            "{\n    return flatcc_verify_table_as_root_with_size_and_memo(buf, bufsiz, %s_identifier, &%s_verify_table, memo);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_stats(const void *buf, size_t bufsiz, flatcc_verifier_stats_t *stats)\n"
+            "{\n    return flatcc_verify_table_as_root_with_stats(buf, bufsiz, %s_identifier, &%s_verify_table, stats);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_size_and_stats(const void *buf, size_t bufsiz, flatcc_verifier_stats_t *stats)\n"
+            "{\n    return flatcc_verify_table_as_root_with_size_and_stats(buf, bufsiz, %s_identifier, &%s_verify_table, stats);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_index(const void *buf, size_t bufsiz, flatcc_table_index_t *index, size_t count)\n"
+            "{\n    return flatcc_verify_table_as_root_with_index(buf, bufsiz, %s_identifier, &%s_verify_table, index, count);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_size_and_index(const void *buf, size_t bufsiz, flatcc_table_index_t *index, size_t count)\n"
+            "{\n    return flatcc_verify_table_as_root_with_size_and_index(buf, bufsiz, %s_identifier, &%s_verify_table, index, count);\n}\n\n",
+            snt.text, snt.text, snt.text);
+    fprintf(out->fp,
+            "static inline void %s_verifier_stream_init(flatcc_verifier_stream_t *S)\n"
+            "{\n    flatcc_verifier_stream_init(S, %s_identifier, &%s_verify_table);\n}\n\n",
+            snt.text, snt.text, snt.text);
     return 0;
 }
 
@@ -302,6 +540,9 @@ static int gen_verifier_prototypes(fb_output_t *out)
             fprintf(out->fp,
                     "static int %s_verify_table(flatcc_table_verifier_descriptor_t *td);\n",
                     snt.text);
+            fprintf(out->fp,
+                    "static const flatcc_verifier_table_type_t *%s_table_verifier_type(void);\n",
+                    snt.text);
         }
     }
     fprintf(out->fp, "\n");
@@ -316,6 +557,7 @@ static int gen_union_verifiers(fb_output_t *out)
         switch (sym->kind) {
         case fb_is_union:
             gen_union_verifier(out, (fb_compound_type_t *)sym);
+            gen_union_verifier_type(out, (fb_compound_type_t *)sym);
         }
     }
     return 0;
@@ -342,6 +584,7 @@ static int gen_table_verifiers(fb_output_t *out)
         switch (sym->kind) {
         case fb_is_table:
             gen_table_verifier(out, (fb_compound_type_t *)sym);
+            gen_table_verifier_type(out, (fb_compound_type_t *)sym);
         }
     }
     return 0;
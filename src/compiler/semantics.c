@@ -27,6 +27,8 @@ static const char *fb_known_attribute_names[] = {
     "base64url",
     "primary_key",
     "sorted",
+    "fixed",
+    "rows",
 };
 
 static const int fb_known_attribute_types[] = {
@@ -44,6 +46,8 @@ static const int fb_known_attribute_types[] = {
     vt_missing,
     vt_missing,
     vt_missing,
+    vt_missing,
+    vt_missing,
 };
 
 static fb_scalar_type_t map_scalar_token_type(fb_token_t *t)
@@ -930,7 +934,7 @@ static int process_table(fb_parser_t *P, fb_compound_type_t *ct)
     assert(ct->symbol.kind == fb_is_table);
     assert(!ct->type.type);
 
-    ct->metadata_flags = process_metadata(P, ct->metadata, fb_f_original_order, knowns);
+    ct->metadata_flags = process_metadata(P, ct->metadata, fb_f_original_order | fb_f_rows, knowns);
     /*
      * `original_order` now lives as a flag, we need not consider it
      * further until code generation.
@@ -957,7 +961,8 @@ static int process_table(fb_parser_t *P, fb_compound_type_t *ct)
         }
         allow_flags =
                 fb_f_id | fb_f_nested_flatbuffer | fb_f_deprecated | fb_f_key |
-                fb_f_required | fb_f_hash | fb_f_base64 | fb_f_base64url | fb_f_sorted;
+                fb_f_required | fb_f_hash | fb_f_base64 | fb_f_base64url | fb_f_sorted |
+                fb_f_fixed;
 
         if (P->opts.allow_primary_key) {
             allow_flags |= fb_f_primary_key;
@@ -1398,6 +1403,49 @@ static int process_table(fb_parser_t *P, fb_compound_type_t *ct)
     return ret;
 }
 
+/* Field names of `rows` tables become members of a generated C struct. */
+static int is_c_keyword(const char *s, int n)
+{
+    static const char *keywords[] = {
+        "auto", "bool", "break", "case", "catch", "char", "class", "const",
+        "continue", "default", "delete", "do", "double", "else", "enum",
+        "extern", "false", "float", "for", "friend", "goto", "if", "inline",
+        "int", "long", "namespace", "new", "operator", "private", "protected",
+        "public", "register", "restrict", "return", "short", "signed",
+        "sizeof", "static", "struct", "switch", "template", "this", "throw",
+        "true", "try", "typedef", "typename", "union", "unsigned", "using",
+        "virtual", "void", "volatile", "while", 0 };
+    const char **k;
+
+    for (k = keywords; *k; ++k) {
+        if ((int)strlen(*k) == n && 0 == memcmp(*k, s, (size_t)n)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Fields of a rows table that go into the generated row struct. Must
+ * match `is_row_member` in the builder code generator.
+ */
+static int is_row_member(fb_member_t *member)
+{
+    switch (member->type.type) {
+    case vt_scalar_type:
+    case vt_vector_type:
+    case vt_string_type:
+    case vt_vector_string_type:
+        return 1;
+    case vt_compound_type_ref:
+        return member->type.ct->symbol.kind == fb_is_enum || member->type.ct->symbol.kind == fb_is_table;
+    case vt_vector_compound_type_ref:
+        return member->type.ct->symbol.kind != fb_is_union;
+    default:
+        return 0;
+    }
+}
+
 /*
  * Post processing of process_table because some information is only
  * available when all types have been processed.
@@ -1406,12 +1454,53 @@ static int validate_table_attr(fb_parser_t *P, fb_compound_type_t *ct)
 {
     fb_symbol_t *sym;
     fb_member_t *member;
+    int has_fixed = 0;
 
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (!(member->metadata_flags & fb_f_deprecated) && (member->metadata_flags & fb_f_fixed)) {
+            has_fixed = 1;
+        }
+    }
     for (sym = ct->members; sym; sym = sym->link) {
         member = (fb_member_t *)sym;
         if (member->metadata_flags & fb_f_deprecated) {
             continue;
         }
+        if (ct->metadata_flags & fb_f_rows) {
+            if (!is_row_member(member)) {
+                /* Rows cannot store the field, so rows could never satisfy it. */
+                if (member->metadata_flags & fb_f_required) {
+                    error_sym(P, sym, "required struct or union field not allowed in a rows table");
+                    return -1;
+                }
+            } else if (is_c_keyword(sym->ident->text, (int)sym->ident->len)) {
+                error_sym(P, sym, "field name is a C or C++ keyword and cannot be a member of the generated row struct of a rows table");
+                return -1;
+            }
+        }
+        /*
+         * Fixed fields are always stored by the generated `_create_fixed`
+         * call, so required fields must be part of the fixed set.
+         */
+        if (has_fixed && (member->metadata_flags & fb_f_required) &&
+                !(member->metadata_flags & fb_f_fixed)) {
+            error_sym(P, sym, "required field must also be fixed when other fields are fixed");
+            return -1;
+        }
+        if (member->metadata_flags & fb_f_fixed) {
+            if ((member->type.type == vt_compound_type_ref ||
+                    member->type.type == vt_vector_compound_type_ref) &&
+                    member->type.ct->symbol.kind == fb_is_union) {
+                error_sym(P, sym, "fixed attribute not allowed for union fields");
+                return -1;
+            }
+            if (member->type.type == vt_compound_type_ref &&
+                    member->type.ct->symbol.kind == fb_is_struct && member->type.ct->align > 8) {
+                error_sym(P, sym, "fixed attribute not allowed for structs aligned beyond 8 bytes");
+                return -1;
+            }
+        }
 
         if (member->type.type == vt_vector_compound_type_ref &&
                 member->metadata_flags & fb_f_sorted) {
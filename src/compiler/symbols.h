@@ -300,6 +300,8 @@ enum fb_known_attributes {
     fb_attr_base64url = 11,
     fb_attr_primary_key = 12,
     fb_attr_sorted = 13,
+    fb_attr_fixed = 14,
+    fb_attr_rows = 15,
     KNOWN_ATTR_COUNT
 };
 
@@ -318,6 +320,8 @@ enum fb_known_attribute_flags {
     fb_f_base64url = 1 << fb_attr_base64url,
     fb_f_primary_key = 1 << fb_attr_primary_key,
     fb_f_sorted = 1 << fb_attr_sorted,
+    fb_f_fixed = 1 << fb_attr_fixed,
+    fb_f_rows = 1 << fb_attr_rows,
 };
 
 struct fb_attribute {
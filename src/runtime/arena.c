@@ -0,0 +1,223 @@
+#include <string.h>
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_alloc.h"
+#include "flatcc/flatcc_builder.h"
+#include "flatcc/flatcc_arena.h"
+
+#define min_block_size ((size_t)1 << FLATCC_ARENA_MIN_CLASS_SHIFT)
+#define class_size(k) ((size_t)1 << ((k) + FLATCC_ARENA_MIN_CLASS_SHIFT))
+
+/* Regions are aligned so every block is aligned to its minimum size. */
+static inline uint8_t *align_block(uint8_t *p)
+{
+    return (uint8_t *)(((size_t)p + min_block_size - 1) & ~(min_block_size - 1));
+}
+
+/* Returns the size class that holds `size` bytes, or -1 if too large. */
+static inline int size_class(size_t size)
+{
+    int k = 0;
+
+    while (class_size(k) < size) {
+        if (++k >= FLATCC_ARENA_CLASS_COUNT) {
+            return -1;
+        }
+    }
+    return k;
+}
+
+static int add_region(flatcc_arena_t *A, size_t need)
+{
+    flatcc_arena_region_t *r;
+    size_t size = A->capacity > FLATCC_ARENA_REGION_SIZE ? A->capacity : FLATCC_ARENA_REGION_SIZE;
+
+    if (size < need) {
+        size = need;
+    }
+    if (A->limit) {
+        if (A->capacity >= A->limit) {
+            return -1;
+        }
+        if (size > A->limit - A->capacity) {
+            size = A->limit - A->capacity;
+        }
+        if (size < need) {
+            return -1;
+        }
+    }
+    if (!(r = FLATCC_ALLOC(sizeof(*r) + size + min_block_size))) {
+        return -1;
+    }
+    r->next = 0;
+    r->base = align_block((uint8_t *)(r + 1));
+    r->end = r->base + size;
+    r->is_owned = 1;
+    A->capacity += size;
+    if (A->region) {
+        /* Only called when the current region is the last. */
+        A->region->next = r;
+    } else {
+        A->regions = r;
+    }
+    A->region = r;
+    A->cursor = r->base;
+    return 0;
+}
+
+static void *take_block(flatcc_arena_t *A, int k)
+{
+    void *p;
+    size_t n = class_size(k);
+
+    if ((p = A->free_list[k])) {
+        A->free_list[k] = *(void **)p;
+        return p;
+    }
+    for (;;) {
+        if (A->region && (size_t)(A->region->end - A->cursor) >= n) {
+            p = A->cursor;
+            A->cursor += n;
+            return p;
+        }
+        if (A->region && A->region->next) {
+            A->region = A->region->next;
+            A->cursor = A->region->base;
+            continue;
+        }
+        if (add_region(A, n)) {
+            return 0;
+        }
+    }
+}
+
+static inline void release_block(flatcc_arena_t *A, flatcc_iovec_t *b)
+{
+    int k = size_class(b->iov_len);
+
+    /* Emitter pages may report the requested size rather than the class size. */
+    FLATCC_ASSERT(k >= 0);
+    *(void **)b->iov_base = A->free_list[k];
+    A->free_list[k] = b->iov_base;
+    b->iov_base = 0;
+    b->iov_len = 0;
+}
+
+int flatcc_arena_init(flatcc_arena_t *A, void *mem, size_t size)
+{
+    uint8_t *base;
+
+    memset(A, 0, sizeof(*A));
+    if (mem) {
+        base = align_block(mem);
+        if ((size_t)(base - (uint8_t *)mem) >= size) {
+            return 0;
+        }
+        A->first.base = base;
+        A->first.end = (uint8_t *)mem + size;
+        A->capacity = (size_t)(A->first.end - base);
+        A->regions = &A->first;
+        A->region = &A->first;
+        A->cursor = base;
+        return 0;
+    }
+    if (size) {
+        return add_region(A, size);
+    }
+    return 0;
+}
+
+void flatcc_arena_reset(flatcc_arena_t *A)
+{
+    memset(A->free_list, 0, sizeof(A->free_list));
+    A->region = A->regions;
+    A->cursor = A->region ? A->region->base : 0;
+}
+
+void flatcc_arena_clear(flatcc_arena_t *A)
+{
+    flatcc_arena_region_t *r = A->regions, *next;
+
+    while (r) {
+        next = r->next;
+        if (r->is_owned) {
+            FLATCC_FREE(r);
+        }
+        r = next;
+    }
+    memset(A, 0, sizeof(*A));
+}
+
+int flatcc_arena_alloc(void *alloc_context, flatcc_iovec_t *b,
+        size_t request, int zero_fill, int alloc_type)
+{
+    flatcc_arena_t *A = alloc_context;
+    void *p;
+    size_t n;
+    int k;
+
+    if (request == 0) {
+        if (b->iov_base) {
+            release_block(A, b);
+        }
+        return 0;
+    }
+    /* Buffers never shrink, they are cheap to keep. */
+    if (request <= b->iov_len) {
+        return 0;
+    }
+    /* Same initial sizes as the default allocator. */
+    switch (alloc_type) {
+    case flatcc_builder_alloc_ds:
+        n = 256;
+        break;
+    case flatcc_builder_alloc_fs:
+        n = sizeof(__flatcc_builder_frame_t) * 8;
+        break;
+    case flatcc_builder_alloc_us:
+        n = 64;
+        break;
+    default:
+        n = 32;
+        break;
+    }
+    if (n < request) {
+        n = request;
+    }
+    if ((k = size_class(n)) < 0 || !(p = take_block(A, k))) {
+        return -1;
+    }
+    n = class_size(k);
+    if (b->iov_base) {
+        memcpy(p, b->iov_base, b->iov_len);
+    }
+    if (zero_fill) {
+        memset((uint8_t *)p + b->iov_len, 0, n - b->iov_len);
+    }
+    if (b->iov_base) {
+        release_block(A, b);
+    }
+    b->iov_base = p;
+    b->iov_len = n;
+    return 0;
+}
+
+int flatcc_arena_emitter_alloc(void *alloc_context, flatcc_iovec_t *b, size_t request)
+{
+    flatcc_arena_t *A = alloc_context;
+    void *p;
+    int k;
+
+    if (b->iov_base) {
+        release_block(A, b);
+    }
+    if (request == 0) {
+        return 0;
+    }
+    if ((k = size_class(request)) < 0 || !(p = take_block(A, k))) {
+        return -1;
+    }
+    b->iov_base = p;
+    b->iov_len = class_size(k);
+    return 0;
+}
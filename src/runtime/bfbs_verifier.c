@@ -0,0 +1,447 @@
+/*
+ * Verifier driven by a binary schema, see `flatcc/flatcc_bfbs_verifier.h`.
+ */
+
+#include <string.h>
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_bfbs_verifier.h"
+#include "flatcc/flatcc_alloc.h"
+#include "flatcc/reflection/reflection_verifier.h"
+
+#define BaseType(x) reflection_BaseType_ ## x
+
+/* Size and alignment of scalar base types, or 0. */
+static uint16_t scalar_size(reflection_BaseType_enum_t type)
+{
+    switch (type) {
+    case BaseType(Bool):
+    case BaseType(Byte):
+    case BaseType(UByte):
+        return 1;
+    case BaseType(Short):
+    case BaseType(UShort):
+        return 2;
+    case BaseType(Int):
+    case BaseType(UInt):
+    case BaseType(Float):
+        return 4;
+    case BaseType(Long):
+    case BaseType(ULong):
+    case BaseType(Double):
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+static int is_union_type_field(reflection_Field_table_t F)
+{
+    reflection_Type_table_t T = reflection_Field_type(F);
+
+    return reflection_Type_base_type(T) == BaseType(UType) ||
+        (reflection_Type_base_type(T) == BaseType(Vector) && reflection_Type_element(T) == BaseType(UType));
+}
+
+static int find_object(const flatcc_bfbs_verifier_t *V, const char *name, size_t len)
+{
+    size_t lo = 0, hi = V->object_count, i;
+    const char *s;
+    int cmp;
+
+    while (lo < hi) {
+        i = lo + (hi - lo) / 2;
+        s = V->names + V->name_offsets[i];
+        if (!(cmp = strncmp(s, name, len)) && s[len]) {
+            cmp = 1;
+        }
+        if (cmp == 0) {
+            return (int)i;
+        }
+        if (cmp < 0) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Nested flatbuffer types are named as in the schema source, so they
+ * are resolved like the schema compiler does: in the namespace of the
+ * referring object first, then in each enclosing namespace.
+ */
+static int find_scoped_object(const flatcc_bfbs_verifier_t *V, const char *scope, const char *name)
+{
+    char buf[256];
+    size_t n = strlen(scope), k = strlen(name);
+    int index;
+
+    while (n > 0 && scope[n - 1] != '.') {
+        --n;
+    }
+    for (;;) {
+        if (n + k < sizeof(buf)) {
+            memcpy(buf, scope, n);
+            memcpy(buf + n, name, k);
+            if ((index = find_object(V, buf, n + k)) >= 0) {
+                return index;
+            }
+        }
+        if (n == 0) {
+            return -1;
+        }
+        for (--n; n > 0 && scope[n - 1] != '.'; --n) {
+        }
+    }
+}
+
+static int compile_struct(reflection_Object_vec_t Objs, int32_t index,
+        uint16_t *align, flatbuffers_uoffset_t *size)
+{
+    reflection_Object_table_t O = reflection_Object_vec_at(Objs, (size_t)index);
+    int32_t minalign = reflection_Object_minalign(O);
+    int32_t bytesize = reflection_Object_bytesize(O);
+
+    if (minalign < 1 || minalign > 256 || (minalign & (minalign - 1)) || bytesize < 1) {
+        return -1;
+    }
+    *align = (uint16_t)minalign;
+    *size = (flatbuffers_uoffset_t)bytesize;
+    return 0;
+}
+
+static int compile_field(flatcc_bfbs_verifier_t *V, reflection_Schema_table_t S,
+        reflection_Object_table_t O, reflection_Field_table_t F, flatcc_verifier_field_t *f)
+{
+    reflection_Object_vec_t Objs = reflection_Schema_objects(S);
+    reflection_Enum_vec_t Enums = reflection_Schema_enums(S);
+    reflection_Type_table_t T = reflection_Field_type(F);
+    reflection_BaseType_enum_t base_type = reflection_Type_base_type(T);
+    reflection_BaseType_enum_t element = reflection_Type_element(T);
+    int32_t index = reflection_Type_index(T);
+    int is_object = index >= 0 && (size_t)index < reflection_Object_vec_len(Objs);
+    int is_struct = is_object && reflection_Object_is_struct(reflection_Object_vec_at(Objs, (size_t)index));
+    int is_union = index >= 0 && (size_t)index < reflection_Enum_vec_len(Enums) &&
+        reflection_Enum_is_union(reflection_Enum_vec_at(Enums, (size_t)index));
+    reflection_KeyValue_vec_t Attrs;
+    const char *nested = 0;
+    size_t k;
+    int nested_index;
+
+    memset(f, 0, sizeof(*f));
+    f->id = reflection_Field_id(F);
+    f->required = reflection_Field_required(F) != 0;
+    switch (base_type) {
+    case BaseType(String):
+        f->op = flatcc_verifier_op_string;
+        return 0;
+    case BaseType(Obj):
+        if (!is_object) {
+            return -1;
+        }
+        if (is_struct) {
+            f->op = flatcc_verifier_op_field;
+            f->required = 0;
+            return compile_struct(Objs, index, &f->align, &f->size);
+        }
+        f->op = flatcc_verifier_op_table;
+        f->table_type_ptr = V->table_types + index;
+        return 0;
+    case BaseType(Union):
+        /* The type field precedes the value field. */
+        if (!is_union || f->id == 0) {
+            return -1;
+        }
+        f->op = flatcc_verifier_op_union;
+        f->union_type_ptr = V->union_types + index;
+        return 0;
+    case BaseType(Vector):
+        break;
+    default:
+        if (!(f->size = f->align = scalar_size(base_type))) {
+            return -1;
+        }
+        f->op = flatcc_verifier_op_field;
+        f->required = 0;
+        return 0;
+    }
+    switch (element) {
+    case BaseType(String):
+        f->op = flatcc_verifier_op_string_vector;
+        return 0;
+    case BaseType(Obj):
+        if (!is_object) {
+            return -1;
+        }
+        if (is_struct) {
+            f->op = flatcc_verifier_op_vector;
+            if (compile_struct(Objs, index, &f->align, &f->size)) {
+                return -1;
+            }
+            f->max_count = FLATBUFFERS_COUNT_MAX(f->size);
+            return 0;
+        }
+        f->op = flatcc_verifier_op_table_vector;
+        f->table_type_ptr = V->table_types + index;
+        return 0;
+    case BaseType(Union):
+        if (!is_union || f->id == 0) {
+            return -1;
+        }
+        f->op = flatcc_verifier_op_union_vector;
+        f->union_type_ptr = V->union_types + index;
+        return 0;
+    default:
+        break;
+    }
+    if (!(f->size = f->align = scalar_size(element))) {
+        return -1;
+    }
+    f->op = flatcc_verifier_op_vector;
+    f->max_count = FLATBUFFERS_COUNT_MAX(f->size);
+    Attrs = reflection_Field_attributes(F);
+    if (Attrs && (k = reflection_KeyValue_vec_scan(Attrs, "nested_flatbuffer")) != flatbuffers_not_found) {
+        nested = reflection_KeyValue_value(reflection_KeyValue_vec_at(Attrs, k));
+    }
+    if (!nested || f->size != 1) {
+        return 0;
+    }
+    if ((nested_index = find_scoped_object(V, reflection_Object_name(O), nested)) < 0) {
+        return -1;
+    }
+    if (reflection_Object_is_struct(reflection_Object_vec_at(Objs, (size_t)nested_index))) {
+        f->op = flatcc_verifier_op_nested_struct;
+        return compile_struct(Objs, nested_index, &f->align, &f->size);
+    }
+    f->op = flatcc_verifier_op_nested_table;
+    f->table_type_ptr = V->table_types + nested_index;
+    f->size = 0;
+    f->max_count = 0;
+    return 0;
+}
+
+static int compile_union_member(flatcc_bfbs_verifier_t *V, reflection_Schema_table_t S,
+        reflection_EnumVal_table_t EV, flatcc_verifier_union_member_t *m)
+{
+    reflection_Object_vec_t Objs = reflection_Schema_objects(S);
+    reflection_Type_table_t T = reflection_EnumVal_union_type(EV);
+    reflection_Object_table_t O;
+    reflection_BaseType_enum_t base_type = BaseType(Obj);
+    int32_t index = -1;
+    size_t k;
+
+    memset(m, 0, sizeof(*m));
+    if (reflection_EnumVal_value(EV) == 0) {
+        return 0;
+    }
+    if (T) {
+        base_type = reflection_Type_base_type(T);
+        index = reflection_Type_index(T);
+    } else if ((O = reflection_EnumVal_object(EV))) {
+        /* Older schemas only reference tables. */
+        k = reflection_Object_vec_find(Objs, reflection_Object_name(O));
+        index = k == flatbuffers_not_found ? -1 : (int32_t)k;
+    }
+    switch (base_type) {
+    case BaseType(String):
+        m->op = flatcc_verifier_op_string;
+        return 0;
+    case BaseType(Obj):
+        if (index < 0 || (size_t)index >= reflection_Object_vec_len(Objs)) {
+            return -1;
+        }
+        if (reflection_Object_is_struct(reflection_Object_vec_at(Objs, (size_t)index))) {
+            m->op = flatcc_verifier_op_struct;
+            return compile_struct(Objs, index, &m->align, &m->size);
+        }
+        m->op = flatcc_verifier_op_table;
+        m->table_type_ptr = V->table_types + index;
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+/* Fields are sorted by name in the schema, but verified in id order. */
+static void sort_fields(flatcc_verifier_field_t *fields, size_t count)
+{
+    flatcc_verifier_field_t f;
+    size_t i, j;
+
+    for (i = 1; i < count; ++i) {
+        f = fields[i];
+        for (j = i; j > 0 && fields[j - 1].id > f.id; --j) {
+            fields[j] = fields[j - 1];
+        }
+        fields[j] = f;
+    }
+}
+
+static int compile(flatcc_bfbs_verifier_t *V, reflection_Schema_table_t S)
+{
+    reflection_Object_vec_t Objs = reflection_Schema_objects(S);
+    reflection_Enum_vec_t Enums = reflection_Schema_enums(S);
+    reflection_Object_table_t O, root = reflection_Schema_root_table(S);
+    reflection_Field_vec_t Flds;
+    reflection_Field_table_t F;
+    reflection_EnumVal_vec_t Vals;
+    reflection_EnumVal_table_t EV;
+    flatcc_verifier_field_t *f;
+    flatcc_verifier_union_member_t *m;
+    size_t i, k, n, nobjs, nenums, nfields = 0, nmembers = 0, names_len = 0;
+    const char *fid, *name;
+    int64_t value;
+
+    nobjs = reflection_Object_vec_len(Objs);
+    nenums = reflection_Enum_vec_len(Enums);
+    for (i = 0; i < nobjs; ++i) {
+        O = reflection_Object_vec_at(Objs, i);
+        names_len += strlen(reflection_Object_name(O)) + 1;
+        if (!reflection_Object_is_struct(O)) {
+            nfields += reflection_Field_vec_len(reflection_Object_fields(O));
+        }
+    }
+    for (i = 0; i < nenums; ++i) {
+        if (!reflection_Enum_is_union(reflection_Enum_vec_at(Enums, i))) {
+            continue;
+        }
+        Vals = reflection_Enum_values(reflection_Enum_vec_at(Enums, i));
+        if ((n = reflection_EnumVal_vec_len(Vals))) {
+            /* Values are sorted, so the last is the largest. */
+            value = reflection_EnumVal_value(reflection_EnumVal_vec_at(Vals, n - 1));
+            if (value < 0 || value > UINT8_MAX) {
+                return -1;
+            }
+            nmembers += (size_t)value + 1;
+        }
+    }
+    V->object_count = nobjs;
+    if (!(V->table_types = FLATCC_CALLOC(nobjs + 1, sizeof(V->table_types[0])))
+            || !(V->union_types = FLATCC_CALLOC(nenums + 1, sizeof(V->union_types[0])))
+            || !(V->fields = FLATCC_CALLOC(nfields + 1, sizeof(V->fields[0])))
+            || !(V->members = FLATCC_CALLOC(nmembers + 1, sizeof(V->members[0])))
+            || !(V->names = FLATCC_ALLOC(names_len + 1))
+            || !(V->name_offsets = FLATCC_CALLOC(nobjs + 1, sizeof(V->name_offsets[0])))) {
+        return -1;
+    }
+    for (i = 0, n = 0; i < nobjs; ++i) {
+        O = reflection_Object_vec_at(Objs, i);
+        name = reflection_Object_name(O);
+        V->name_offsets[i] = n;
+        k = strlen(name) + 1;
+        memcpy(V->names + n, name, k);
+        n += k;
+        if (O == root) {
+            V->root_index = (int)i;
+        }
+    }
+    f = V->fields;
+    for (i = 0; i < nobjs; ++i) {
+        O = reflection_Object_vec_at(Objs, i);
+        if (reflection_Object_is_struct(O)) {
+            continue;
+        }
+        V->table_types[i].fields = f;
+        Flds = reflection_Object_fields(O);
+        for (k = 0; k < reflection_Field_vec_len(Flds); ++k) {
+            F = reflection_Field_vec_at(Flds, k);
+            if (reflection_Field_deprecated(F) || is_union_type_field(F)) {
+                continue;
+            }
+            if (compile_field(V, S, O, F, f++)) {
+                return -1;
+            }
+        }
+        V->table_types[i].field_count = (size_t)(f - V->table_types[i].fields);
+        sort_fields((flatcc_verifier_field_t *)V->table_types[i].fields, V->table_types[i].field_count);
+    }
+    m = V->members;
+    for (i = 0; i < nenums; ++i) {
+        if (!reflection_Enum_is_union(reflection_Enum_vec_at(Enums, i))) {
+            continue;
+        }
+        Vals = reflection_Enum_values(reflection_Enum_vec_at(Enums, i));
+        if (!(n = reflection_EnumVal_vec_len(Vals))) {
+            continue;
+        }
+        V->union_types[i].members = m;
+        V->union_types[i].member_count = (size_t)reflection_EnumVal_value(reflection_EnumVal_vec_at(Vals, n - 1)) + 1;
+        for (k = 0; k < n; ++k) {
+            EV = reflection_EnumVal_vec_at(Vals, k);
+            value = reflection_EnumVal_value(EV);
+            if (value < 0 || (size_t)value >= V->union_types[i].member_count) {
+                return -1;
+            }
+            if (compile_union_member(V, S, EV, m + value)) {
+                return -1;
+            }
+        }
+        m += V->union_types[i].member_count;
+    }
+    if ((fid = reflection_Schema_file_ident(S))) {
+        strncpy(V->fid, fid, FLATBUFFERS_IDENTIFIER_SIZE);
+    }
+    return 0;
+}
+
+int flatcc_bfbs_verifier_init(flatcc_bfbs_verifier_t *V, const void *bfbs, size_t size)
+{
+    memset(V, 0, sizeof(*V));
+    V->root_index = -1;
+    if (reflection_Schema_verify_as_root(bfbs, size)) {
+        return -1;
+    }
+    if (compile(V, reflection_Schema_as_root(bfbs))) {
+        flatcc_bfbs_verifier_clear(V);
+        return -1;
+    }
+    return 0;
+}
+
+void flatcc_bfbs_verifier_clear(flatcc_bfbs_verifier_t *V)
+{
+    FLATCC_FREE(V->table_types);
+    FLATCC_FREE(V->union_types);
+    FLATCC_FREE(V->fields);
+    FLATCC_FREE(V->members);
+    FLATCC_FREE(V->names);
+    FLATCC_FREE(V->name_offsets);
+    memset(V, 0, sizeof(*V));
+    V->root_index = -1;
+}
+
+const flatcc_verifier_table_type_t *flatcc_bfbs_verifier_table_type(
+        const flatcc_bfbs_verifier_t *V, const char *name)
+{
+    int index = name ? find_object(V, name, strlen(name)) : V->root_index;
+
+    /* Structs have no fields. */
+    if (index < 0 || !V->table_types[index].fields) {
+        return 0;
+    }
+    return V->table_types + index;
+}
+
+int flatcc_bfbs_verify_as_root(const flatcc_bfbs_verifier_t *V,
+        const void *buf, size_t bufsiz, const char *name)
+{
+    const flatcc_verifier_table_type_t *type = flatcc_bfbs_verifier_table_type(V, name);
+
+    if (!type) {
+        return flatcc_verify_error_runtime_schema_type_not_found;
+    }
+    return flatcc_verify_table_as_root_iterative(buf, bufsiz, V->fid[0] ? V->fid : 0, type, 0);
+}
+
+int flatcc_bfbs_verify_as_root_with_size(const flatcc_bfbs_verifier_t *V,
+        const void *buf, size_t bufsiz, const char *name)
+{
+    const flatcc_verifier_table_type_t *type = flatcc_bfbs_verifier_table_type(V, name);
+
+    if (!type) {
+        return flatcc_verify_error_runtime_schema_type_not_found;
+    }
+    return flatcc_verify_table_as_root_with_size_iterative(buf, bufsiz, V->fid[0] ? V->fid : 0, type, 0);
+}
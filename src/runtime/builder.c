@@ -102,6 +102,8 @@ struct vtable_descriptor {
     uoffset_t vb_start;
     /* Hash table collision chain. */
     uoffset_t next;
+    /* The builder hash of the vtable. */
+    uint32_t vt_hash;
 };
 
 typedef struct flatcc_iov_state flatcc_iov_state_t;
@@ -388,6 +390,7 @@ void flatcc_builder_flush_vtable_cache(flatcc_builder_t *B)
         return;
     }
     memset(buf->iov_base, 0, buf->iov_len);
+    ++B->vb_flush_count;
     /* Reserve the null entry. */
     B->vd_end = sizeof(vtable_descriptor_t);
     B->vb_end = 0;
@@ -424,13 +427,39 @@ int flatcc_builder_init(flatcc_builder_t *B)
     return flatcc_builder_custom_init(B, 0, 0, 0, 0);
 }
 
+static inline int is_vtable_cache_buffer(int alloc_type)
+{
+    return alloc_type == flatcc_builder_alloc_ht ||
+        alloc_type == flatcc_builder_alloc_vd ||
+        alloc_type == flatcc_builder_alloc_vb;
+}
+
+/*
+ * Cached vtables stay in the hash table, but their emitted references
+ * belong to the previous buffer. A zero `vt_ref` marks a descriptor as
+ * retained so it is emitted again and claimed on next use.
+ */
+static void retire_vtable_cache(flatcc_builder_t *B)
+{
+    vtable_descriptor_t *vd;
+    uoffset_t next;
+
+    for (next = sizeof(vtable_descriptor_t); next < B->vd_end; next += sizeof(vtable_descriptor_t)) {
+        vd = vd_ptr(next);
+        vd->vt_ref = 0;
+    }
+}
+
 int flatcc_builder_custom_reset(flatcc_builder_t *B, int set_defaults, int reduce_buffers)
 {
     iovec_t *buf;
-    int i;
+    int i, retain = B->retain_vtable_cache && !reduce_buffers;
 
     for (i = 0; i < FLATCC_BUILDER_ALLOC_BUFFER_COUNT; ++i) {
         buf = B->buffers + i;
+        if (retain && is_vtable_cache_buffer(i)) {
+            continue;
+        }
         if (buf->iov_base) {
             /* Don't try to reduce the hash table. */
             if (i != flatcc_builder_alloc_ht &&
@@ -442,10 +471,14 @@ int flatcc_builder_custom_reset(flatcc_builder_t *B, int set_defaults, int reduc
             FLATCC_ASSERT(buf->iov_len == 0);
         }
     }
-    B->vb_end = 0;
-    if (B->vd_end > 0) {
-        /* Reset past null entry. */
-        B->vd_end = sizeof(vtable_descriptor_t);
+    if (retain) {
+        retire_vtable_cache(B);
+    } else {
+        B->vb_end = 0;
+        if (B->vd_end > 0) {
+            /* Reset past null entry. */
+            B->vd_end = sizeof(vtable_descriptor_t);
+        }
     }
     B->min_align = 0;
     B->emit_start = 0;
@@ -465,6 +498,7 @@ int flatcc_builder_custom_reset(flatcc_builder_t *B, int set_defaults, int reduc
         B->vb_flush_limit = 0;
         B->max_level = 0;
         B->disable_vt_clustering = 0;
+        B->retain_vtable_cache = 0;
     }
     if (B->is_default_emitter) {
         flatcc_emitter_reset(&B->default_emit_context);
@@ -1107,11 +1141,37 @@ int flatcc_builder_start_table(flatcc_builder_t *B, int count)
     return 0;
 }
 
-flatcc_builder_vt_ref_t flatcc_builder_create_vtable(flatcc_builder_t *B,
-        const voffset_t *vt, voffset_t vt_size)
+/* Emits a vtable already converted to protocol endian format. */
+static flatcc_builder_vt_ref_t emit_vtable(flatcc_builder_t *B,
+        const void *vt, voffset_t vt_size)
 {
     flatcc_builder_vt_ref_t vt_ref;
     iov_state_t iov;
+
+    init_iov();
+    push_iov(vt, vt_size);
+    if (is_top_buffer(B) && !B->disable_vt_clustering) {
+        /* Note that `emit_back` already returns ref + 1 as we require for vtables. */
+        if (0 == (vt_ref = emit_back(B, &iov))) {
+            return 0;
+        }
+    } else {
+        if (0 == (vt_ref = emit_front(B, &iov))) {
+            return 0;
+        }
+        /*
+         * We don't have a valid 0 ref here, but to be consistent with
+         * clustered vtables we offset by one. This cannot be zero
+         * either.
+         */
+        vt_ref += 1;
+    }
+    return vt_ref;
+}
+
+flatcc_builder_vt_ref_t flatcc_builder_create_vtable(flatcc_builder_t *B,
+        const voffset_t *vt, voffset_t vt_size)
+{
     voffset_t *vt_;
     size_t i;
 
@@ -1149,26 +1209,28 @@ flatcc_builder_vt_ref_t flatcc_builder_create_vtable(flatcc_builder_t *B,
         vt = vt_;
         /* We don't need to free the reservation since we don't advance any base pointer. */
     }
+    return emit_vtable(B, vt, vt_size);
+}
 
-    init_iov();
-    push_iov(vt, vt_size);
-    if (is_top_buffer(B) && !B->disable_vt_clustering) {
-        /* Note that `emit_back` already returns ref + 1 as we require for vtables. */
-        if (0 == (vt_ref = emit_back(B, &iov))) {
-            return 0;
-        }
-    } else {
-        if (0 == (vt_ref = emit_front(B, &iov))) {
-            return 0;
-        }
-        /*
-         * We don't have a valid 0 ref here, but to be consistent with
-         * clustered vtables we offset by one. This cannot be zero
-         * either.
-         */
-        vt_ref += 1;
+/*
+ * The vr buffer holds the emitted reference of each dictionary vtable
+ * in the current buffer, or 0, and is cleared on reset.
+ */
+static flatcc_builder_vt_ref_t create_dict_vtable(flatcc_builder_t *B, int index)
+{
+    const flatcc_vtable_dict_t *D = B->vt_dict;
+    flatcc_builder_vt_ref_t *vt_ref;
+
+    if (!(vt_ref = reserve_buffer(B, flatcc_builder_alloc_vr, 0,
+            flatcc_vtable_dict_count(D) * sizeof(*vt_ref), 1))) {
+        return 0;
     }
-    return vt_ref;
+    vt_ref += index;
+    if (*vt_ref == 0) {
+        *vt_ref = emit_vtable(B, flatcc_vtable_dict_get_pe(D, index),
+                flatcc_vtable_dict_get_size(D, index));
+    }
+    return *vt_ref;
 }
 
 flatcc_builder_vt_ref_t flatcc_builder_create_cached_vtable(flatcc_builder_t *B,
@@ -1178,6 +1240,7 @@ flatcc_builder_vt_ref_t flatcc_builder_create_cached_vtable(flatcc_builder_t *B,
     uoffset_t *pvd, *pvd_head;
     uoffset_t next;
     voffset_t *vt_;
+    int index;
 
     /* This just gets the hash table slot, we still have to inspect it. */
     if (!(pvd_head = lookup_ht(B, vt_hash))) {
@@ -1195,8 +1258,14 @@ flatcc_builder_vt_ref_t flatcc_builder_create_cached_vtable(flatcc_builder_t *B,
             next = vd->next;
             continue;
         }
-        /* Can't share emitted vtables between buffers, */
-        if (vd->nest_id != B->nest_id) {
+        if (vd->vt_ref == 0) {
+            /* Retained from an earlier buffer, so emit and claim it. */
+            if (0 == (vd->vt_ref = flatcc_builder_create_vtable(B, vt, vt_size))) {
+                return 0;
+            }
+            vd->nest_id = B->nest_id;
+        } else if (vd->nest_id != B->nest_id) {
+            /* Can't share emitted vtables between buffers, */
             /* but we don't have to resubmit to cache. */
             vd2 = vd;
             /* See if there is a better match. */
@@ -1222,11 +1291,22 @@ flatcc_builder_vt_ref_t flatcc_builder_create_cached_vtable(flatcc_builder_t *B,
 
     /* Identify the buffer this vtable descriptor belongs to. */
     vd->nest_id = B->nest_id;
+    vd->vt_hash = vt_hash;
 
     /* Move to front hash strategy. */
     vd->next = *pvd_head;
     *pvd_head = next;
-    if (0 == (vd->vt_ref = flatcc_builder_create_vtable(B, vt, vt_size))) {
+    /*
+     * The dictionary is only searched on a cache miss, and the descriptor
+     * makes later uses in this buffer a cache hit.
+     */
+    if (B->vt_dict && is_top_buffer(B) &&
+            (index = flatcc_vtable_dict_find(B->vt_dict, vt, vt_size, vt_hash)) >= 0) {
+        vd->vt_ref = create_dict_vtable(B, index);
+    } else {
+        vd->vt_ref = flatcc_builder_create_vtable(B, vt, vt_size);
+    }
+    if (0 == vd->vt_ref) {
         return 0;
     }
     if (vd2) {
@@ -1288,6 +1368,145 @@ flatcc_builder_ref_t flatcc_builder_create_table(flatcc_builder_t *B, const void
     return emit_front(B, &iov);
 }
 
+/* Position of an absent field in the table of the current row shape. */
+#define row_field_absent ((voffset_t)~(voffset_t)0)
+
+static inline int is_row_field_present(const uint32_t *present, voffset_t id)
+{
+    return !present || ((present[id / 32] >> (id % 32)) & 1);
+}
+
+static inline void copy_row_field_to_pe(uint8_t *p, const uint8_t *src, size_t size)
+{
+    uint16_t v16;
+    uint32_t v32;
+    uint64_t v64;
+
+    switch (size) {
+    case 2:
+        memcpy(&v16, src, 2);
+        flatbuffers_uint16_write_to_pe(p, v16);
+        break;
+    case 4:
+        memcpy(&v32, src, 4);
+        flatbuffers_uint32_write_to_pe(p, v32);
+        break;
+    case 8:
+        memcpy(&v64, src, 8);
+        flatbuffers_uint64_write_to_pe(p, v64);
+        break;
+    default:
+        *p = *src;
+        break;
+    }
+}
+
+flatcc_builder_ref_t flatcc_builder_create_table_vector(flatcc_builder_t *B,
+        const flatcc_builder_row_layout_t *layout, const void *rows,
+        const uint32_t *present, size_t count)
+{
+    const flatcc_builder_row_field_t *f;
+    const uint8_t *row = rows;
+    const uint32_t *prev = 0;
+    flatcc_builder_ref_t ref;
+    flatcc_builder_vt_ref_t vt_ref = 0;
+    voffset_t *vt, *pos, *offsets, vt_size = 0, id_end;
+    uint8_t *data;
+    size_t i, words, data_size = 0, base, vt_base;
+    uint32_t vt_hash;
+    uoffset_t tsize = 0;
+    uint16_t align = 1;
+    int k, offset_count = 0;
+
+    check(layout->id_count > 0 && (size_t)layout->id_count <= FLATBUFFERS_ID_MAX + 1, "invalid row layout");
+    for (k = 0; k < layout->field_count; ++k) {
+        f = layout->fields + k;
+        check(k == 0 || f->size <= f[-1].size, "row fields must be ordered by decreasing size");
+        data_size += f->size;
+    }
+    check_error(data_size + field_size <= FLATBUFFERS_VOFFSET_MAX, 0, "table too large");
+    words = flatcc_builder_row_present_words(layout->id_count);
+    if (flatcc_builder_start_offset_vector(B) || !flatcc_builder_extend_offset_vector(B, count)) {
+        return 0;
+    }
+    /*
+     * The table, vtable, and field positions of the current row shape
+     * use the data stack after the vector references as scratch space.
+     * The vector only uses `count` references and `exit_frame` clears
+     * the rest.
+     */
+    base = alignup_size(B->ds_offset, 8);
+    vt_base = base + alignup_size(data_size, 8);
+    if (!push_ds(B, (uoffset_t)(vt_base - B->ds_offset + sizeof(voffset_t) *
+            ((size_t)layout->id_count + 2 + 2 * (size_t)layout->field_count)))) {
+        return 0;
+    }
+    data = B->ds + base;
+    vt = (voffset_t *)(B->ds + vt_base);
+    pos = vt + layout->id_count + 2;
+    offsets = pos + layout->field_count;
+    for (i = 0; i < count; ++i, row += layout->row_size) {
+        if (!vt_ref || (present && memcmp(prev, present, words * sizeof(uint32_t)))) {
+            memset(vt, 0, vt_size);
+            FLATCC_BUILDER_INIT_VT_HASH(vt_hash);
+            tsize = 0;
+            align = 1;
+            offset_count = 0;
+            id_end = 0;
+            for (k = 0; k < layout->field_count; ++k) {
+                f = layout->fields + k;
+                if (!is_row_field_present(present, f->id)) {
+                    check_error(!(f->flags & flatcc_builder_row_is_required), 0, "required row field missing");
+                    pos[k] = row_field_absent;
+                    continue;
+                }
+                pos[k] = (voffset_t)tsize;
+                vt[f->id + 2] = (voffset_t)(tsize + field_size);
+                if (f->flags & flatcc_builder_row_is_offset) {
+                    offsets[offset_count++] = (voffset_t)tsize;
+                }
+                if (f->size > align) {
+                    align = f->size;
+                }
+                if (f->id >= id_end) {
+                    id_end = (voffset_t)(f->id + 1);
+                }
+                tsize += f->size;
+                FLATCC_BUILDER_UPDATE_VT_HASH(vt_hash, (uint32_t)f->id, (uint32_t)f->size);
+            }
+            vt_size = (voffset_t)(sizeof(voffset_t) * (id_end + 2u));
+            vt[0] = vt_size;
+            vt[1] = (voffset_t)(tsize + field_size);
+            FLATCC_BUILDER_UPDATE_VT_HASH(vt_hash, (uint32_t)vt[0], (uint32_t)vt[1]);
+            if (!(vt_ref = flatcc_builder_create_cached_vtable(B, vt, vt_size, vt_hash))) {
+                return 0;
+            }
+        }
+        prev = present;
+        for (k = 0; k < layout->field_count; ++k) {
+            if (pos[k] == row_field_absent) {
+                continue;
+            }
+            f = layout->fields + k;
+            if (f->flags & flatcc_builder_row_is_offset) {
+                memcpy(&ref, row + f->row_offset, sizeof(ref));
+                check_error(ref != 0, 0, "row offset field is null");
+                memcpy(data + pos[k], &ref, sizeof(ref));
+            } else {
+                copy_row_field_to_pe(data + pos[k], row + f->row_offset, f->size);
+            }
+        }
+        if (!(ref = flatcc_builder_create_table(B, data, tsize, align, offsets, offset_count, vt_ref))) {
+            return 0;
+        }
+        ((flatcc_builder_ref_t *)B->ds)[i] = ref;
+        if (present) {
+            present += words;
+        }
+    }
+    return flatcc_builder_end_offset_vector(B);
+}
+
 int flatcc_builder_check_required_field(flatcc_builder_t *B, flatbuffers_voffset_t id)
 {
     check(frame(type) == flatcc_builder_table, "expected table frame");
@@ -1903,6 +2122,149 @@ void flatcc_builder_set_max_level(flatcc_builder_t *B, int max_level)
     }
 }
 
+static inline int is_vector_frame_type(int type)
+{
+    switch (type) {
+    case flatcc_builder_vector:
+    case flatcc_builder_offset_vector:
+    case flatcc_builder_string:
+    case flatcc_builder_union_vector:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+void flatcc_builder_checkpoint(flatcc_builder_t *B, flatcc_builder_checkpoint_t *cp)
+{
+    memset(cp, 0, sizeof(*cp));
+    cp->emit_start = B->emit_start;
+    cp->emit_end = B->emit_end;
+    cp->vb_end = B->vb_end;
+    cp->vd_end = B->vd_end;
+    cp->vb_flush_count = B->vb_flush_count;
+    cp->nest_id = B->nest_id;
+    cp->min_align = B->min_align;
+    cp->align = B->align;
+    cp->level = B->level;
+    if (B->level == 0) {
+        return;
+    }
+    cp->type = frame(type);
+    cp->ds_offset = B->ds_offset;
+    if (cp->type == flatcc_builder_table) {
+        cp->pl_offset = pl_offset(B->pl);
+        cp->id_end = B->id_end;
+        cp->vt_hash = B->vt_hash;
+    }
+    if (is_vector_frame_type(cp->type)) {
+        cp->vector_count = frame(container.vector.count);
+    }
+}
+
+/* True if the reference was emitted after the checkpoint. */
+static inline int is_rolled_back(flatcc_builder_t *B, const flatcc_builder_checkpoint_t *cp,
+        flatcc_builder_ref_t ref)
+{
+    return (ref >= B->emit_start && ref < cp->emit_start) || (ref >= cp->emit_end && ref < B->emit_end);
+}
+
+/*
+ * Drops vtable descriptors created after the checkpoint, and forgets
+ * where older vtables were emitted if that was after the checkpoint,
+ * so they are emitted again when needed.
+ */
+static void rollback_vtable_cache(flatcc_builder_t *B, const flatcc_builder_checkpoint_t *cp)
+{
+    vtable_descriptor_t *vd;
+    flatcc_builder_vt_ref_t *vt_ref;
+    uoffset_t *ht, *pvd, next;
+    size_t i, n;
+
+    if (B->vt_dict && B->buffers[flatcc_builder_alloc_vr].iov_base) {
+        vt_ref = B->buffers[flatcc_builder_alloc_vr].iov_base;
+        n = B->buffers[flatcc_builder_alloc_vr].iov_len / sizeof(*vt_ref);
+        if (n > flatcc_vtable_dict_count(B->vt_dict)) {
+            n = flatcc_vtable_dict_count(B->vt_dict);
+        }
+        for (i = 0; i < n; ++i) {
+            if (vt_ref[i] && is_rolled_back(B, cp, vt_ref[i] - 1)) {
+                vt_ref[i] = 0;
+            }
+        }
+    }
+    if (B->ht_width == 0) {
+        return;
+    }
+    if (B->vb_flush_count != cp->vb_flush_count) {
+        /* The cache no longer has the checkpoint content. */
+        flatcc_builder_flush_vtable_cache(B);
+        return;
+    }
+    ht = B->buffers[flatcc_builder_alloc_ht].iov_base;
+    n = (size_t)1 << B->ht_width;
+    for (i = 0; i < n; ++i) {
+        pvd = ht + i;
+        while ((next = *pvd)) {
+            vd = vd_ptr(next);
+            if (next >= cp->vd_end) {
+                *pvd = vd->next;
+                continue;
+            }
+            if (vd->vt_ref && is_rolled_back(B, cp, vd->vt_ref - 1)) {
+                vd->vt_ref = 0;
+            }
+            pvd = &vd->next;
+        }
+    }
+    B->vd_end = cp->vd_end;
+    B->vb_end = cp->vb_end;
+}
+
+int flatcc_builder_rollback(flatcc_builder_t *B, const flatcc_builder_checkpoint_t *cp)
+{
+    voffset_t id;
+
+    check_error(cp->level == B->level && cp->nest_id == B->nest_id, -1,
+            "rollback must be at the checkpoint level");
+    check_error(B->level == 0 || (cp->type == frame(type) && cp->ds_offset <= B->ds_offset), -1,
+            "rollback must be in the checkpoint frame");
+    if (B->emit_start != cp->emit_start || B->emit_end != cp->emit_end) {
+        if (!B->is_default_emitter || flatcc_emitter_rewind(&B->default_emit_context,
+                cp->emit_start, cp->emit_end)) {
+            return -1;
+        }
+    }
+    rollback_vtable_cache(B, cp);
+    if (B->refmap) {
+        flatcc_refmap_reset(B->refmap);
+    }
+    B->emit_start = cp->emit_start;
+    B->emit_end = cp->emit_end;
+    B->min_align = cp->min_align;
+    B->align = cp->align;
+    if (B->level == 0) {
+        return 0;
+    }
+    if (cp->type == flatcc_builder_table) {
+        /* Fields added after the checkpoint are stored above its ds offset. */
+        for (id = 0; id < B->id_end; ++id) {
+            if (B->vs[id] >= cp->ds_offset + field_size) {
+                B->vs[id] = 0;
+            }
+        }
+        B->id_end = cp->id_end;
+        B->vt_hash = cp->vt_hash;
+        B->pl = pl_ptr(cp->pl_offset);
+    }
+    if (is_vector_frame_type(cp->type)) {
+        frame(container.vector.count) = cp->vector_count;
+    }
+    memset(B->ds + cp->ds_offset, 0, B->ds_offset - cp->ds_offset);
+    B->ds_offset = cp->ds_offset;
+    return 0;
+}
+
 size_t flatcc_builder_get_buffer_size(flatcc_builder_t *B)
 {
     return (size_t)(B->emit_end - B->emit_start);
@@ -1923,6 +2285,42 @@ void flatcc_builder_set_vtable_cache_limit(flatcc_builder_t *B, size_t size)
     B->vb_flush_limit = size;
 }
 
+void flatcc_builder_set_vtable_cache_retention(flatcc_builder_t *B, int enable)
+{
+    B->retain_vtable_cache = enable;
+}
+
+int flatcc_builder_set_vtable_dict(flatcc_builder_t *B, const flatcc_vtable_dict_t *D)
+{
+    iovec_t *buf = B->buffers + flatcc_builder_alloc_vr;
+
+    if (D && !flatcc_vtable_dict_is_frozen(D)) {
+        return -1;
+    }
+    /* References into the previous dictionary are no longer valid. */
+    if (buf->iov_base) {
+        memset(buf->iov_base, 0, buf->iov_len);
+    }
+    B->vt_dict = D;
+    return 0;
+}
+
+int flatcc_builder_export_vtable_cache(flatcc_builder_t *B, flatcc_vtable_dict_t *D)
+{
+    vtable_descriptor_t *vd;
+    voffset_t *vt;
+    uoffset_t next;
+
+    for (next = sizeof(vtable_descriptor_t); next < B->vd_end; next += sizeof(vtable_descriptor_t)) {
+        vd = vd_ptr(next);
+        vt = vb_ptr(vd->vb_start);
+        if (flatcc_vtable_dict_add(D, vt, vt[0], vd->vt_hash)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
 void flatcc_builder_set_identifier(flatcc_builder_t *B, const char identifier[identifier_size])
 {
     set_identifier(identifier);
@@ -1964,6 +2362,14 @@ void *flatcc_builder_copy_buffer(flatcc_builder_t *B, void *buffer, size_t size)
     return buffer;
 }
 
+int flatcc_builder_get_buffer_iov(flatcc_builder_t *B, flatcc_iovec_t *iov, int iov_max)
+{
+    if (!B->is_default_emitter) {
+        return 0;
+    }
+    return flatcc_emitter_get_iov(&B->default_emit_context, iov, iov_max);
+}
+
 void *flatcc_builder_finalize_buffer(flatcc_builder_t *B, size_t *size_out)
 {
     void * buffer;
@@ -0,0 +1,219 @@
+/*
+ * Posix locks are not visible with -std=c11 unless requested
+ * explicitly.
+ */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <string.h>
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_alloc.h"
+#include "flatcc/flatcc_assert.h"
+#include "flatcc/flatcc_emitter.h"
+#include "flatcc/flatcc_builder_pool.h"
+
+#if FLATCC_USE_THREADS
+
+#if defined(_WIN32)
+
+#include <windows.h>
+
+typedef SRWLOCK pool_lock_t;
+
+static inline int init_lock(pool_lock_t *lock) { InitializeSRWLock(lock); return 0; }
+static inline void destroy_lock(pool_lock_t *lock) { (void)lock; }
+static inline void lock(pool_lock_t *lock) { AcquireSRWLockExclusive(lock); }
+static inline void unlock(pool_lock_t *lock) { ReleaseSRWLockExclusive(lock); }
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_mutex_t pool_lock_t;
+
+static inline int init_lock(pool_lock_t *lock) { return pthread_mutex_init(lock, 0) ? -1 : 0; }
+static inline void destroy_lock(pool_lock_t *lock) { pthread_mutex_destroy(lock); }
+static inline void lock(pool_lock_t *lock) { pthread_mutex_lock(lock); }
+static inline void unlock(pool_lock_t *lock) { pthread_mutex_unlock(lock); }
+
+#endif
+
+#define lock_pool(P) lock((pool_lock_t *)(P)->lock)
+#define unlock_pool(P) unlock((pool_lock_t *)(P)->lock)
+
+#else /* FLATCC_USE_THREADS */
+
+#define lock_pool(P) ((void)0)
+#define unlock_pool(P) ((void)0)
+
+#endif /* FLATCC_USE_THREADS */
+
+/* Memory held by the builder stacks and the default emitter pages. */
+static size_t builder_size(flatcc_builder_t *B)
+{
+    size_t size = B->default_emit_context.capacity;
+    int i;
+
+    for (i = 0; i < FLATCC_BUILDER_ALLOC_BUFFER_COUNT; ++i) {
+        size += B->buffers[i].iov_len;
+    }
+    return size;
+}
+
+static void free_entry(flatcc_builder_pool_entry_t *entry)
+{
+    flatcc_builder_clear(&entry->builder);
+    FLATCC_FREE(entry);
+}
+
+int flatcc_builder_pool_init(flatcc_builder_pool_t *P, size_t max_idle, size_t trim_size)
+{
+    memset(P, 0, sizeof(*P));
+    P->max_idle = max_idle ? max_idle : FLATCC_BUILDER_POOL_MAX_IDLE;
+    P->trim_size = trim_size ? trim_size : FLATCC_BUILDER_POOL_TRIM_SIZE;
+#if FLATCC_USE_THREADS
+    if (!(P->lock = FLATCC_ALLOC(sizeof(pool_lock_t)))) {
+        return -1;
+    }
+    if (init_lock(P->lock)) {
+        FLATCC_FREE(P->lock);
+        P->lock = 0;
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+flatcc_builder_t *flatcc_builder_pool_acquire(flatcc_builder_pool_t *P)
+{
+    flatcc_builder_pool_entry_t *entry;
+
+    lock_pool(P);
+    if ((entry = P->idle)) {
+        P->idle = entry->next;
+        --P->idle_count;
+    }
+    if (++P->in_use > P->peak_in_use) {
+        P->peak_in_use = P->in_use;
+    }
+    unlock_pool(P);
+    if (entry) {
+        entry->next = 0;
+        return &entry->builder;
+    }
+    if (!(entry = FLATCC_ALLOC(sizeof(*entry)))) {
+        goto failed;
+    }
+    if (flatcc_builder_init(&entry->builder)) {
+        FLATCC_FREE(entry);
+        goto failed;
+    }
+    entry->next = 0;
+    flatcc_builder_set_vtable_cache_retention(&entry->builder, 1);
+    flatcc_builder_set_vtable_cache_limit(&entry->builder, FLATCC_BUILDER_POOL_VTABLE_CACHE_LIMIT);
+    return &entry->builder;
+
+failed:
+    lock_pool(P);
+    --P->in_use;
+    unlock_pool(P);
+    return 0;
+}
+
+/* Settings a user may have changed are restored for the next user. */
+static void restore_settings(flatcc_builder_t *B)
+{
+    flatcc_emitter_t *E = &B->default_emit_context;
+
+    /* Pages must be freed by the allocator that allocated them. */
+    if (E->alloc) {
+        flatcc_emitter_clear(E);
+        flatcc_emitter_set_alloc(E, 0, 0);
+    }
+    flatcc_emitter_set_flush(E, 0, 0);
+    flatcc_emitter_set_page_size(E, 0, 0);
+    flatcc_builder_set_vtable_cache_retention(B, 1);
+    flatcc_builder_set_vtable_cache_limit(B, FLATCC_BUILDER_POOL_VTABLE_CACHE_LIMIT);
+    flatcc_builder_set_vtable_clustering(B, 1);
+    flatcc_builder_set_vtable_dict(B, 0);
+    B->max_level = 0;
+}
+
+void flatcc_builder_pool_release(flatcc_builder_pool_t *P, flatcc_builder_t *B)
+{
+    flatcc_builder_pool_entry_t *entry = (flatcc_builder_pool_entry_t *)B;
+    int is_idle = 0;
+
+    if (builder_size(B) > P->trim_size) {
+        /*
+         * Reduce the stacks, which also gives up the vtable cache. The
+         * definition takes `set_defaults` before `reduce_buffers`,
+         * unlike the parameter names in the declaration.
+         */
+        flatcc_builder_custom_reset(B, 0, 1);
+        if (B->default_emit_context.capacity > P->trim_size) {
+            flatcc_emitter_clear(&B->default_emit_context);
+        }
+    } else {
+        flatcc_builder_custom_reset(B, 0, 0);
+    }
+    restore_settings(B);
+    lock_pool(P);
+    --P->in_use;
+    if (P->idle_count < P->max_idle) {
+        entry->next = P->idle;
+        P->idle = entry;
+        ++P->idle_count;
+        is_idle = 1;
+    }
+    unlock_pool(P);
+    if (!is_idle) {
+        free_entry(entry);
+    }
+}
+
+size_t flatcc_builder_pool_trim(flatcc_builder_pool_t *P)
+{
+    flatcc_builder_pool_entry_t *entry, **link, *trimmed;
+    size_t keep, count = 0;
+
+    lock_pool(P);
+    keep = P->peak_in_use - P->in_use;
+    /* The least recently used builders are at the end. */
+    for (link = &P->idle; *link && keep; --keep) {
+        link = &(*link)->next;
+    }
+    trimmed = *link;
+    *link = 0;
+    for (entry = trimmed; entry; entry = entry->next) {
+        ++count;
+    }
+    P->idle_count -= count;
+    P->peak_in_use = P->in_use;
+    unlock_pool(P);
+    while ((entry = trimmed)) {
+        trimmed = entry->next;
+        free_entry(entry);
+    }
+    return count;
+}
+
+void flatcc_builder_pool_clear(flatcc_builder_pool_t *P)
+{
+    flatcc_builder_pool_entry_t *entry, *next;
+
+    FLATCC_ASSERT(P->in_use == 0);
+    for (entry = P->idle; entry; entry = next) {
+        next = entry->next;
+        free_entry(entry);
+    }
+#if FLATCC_USE_THREADS
+    if (P->lock) {
+        destroy_lock(P->lock);
+        FLATCC_FREE(P->lock);
+    }
+#endif
+    memset(P, 0, sizeof(*P));
+}
@@ -3,19 +3,117 @@
 #include "flatcc/flatcc_rtconfig.h"
 #include "flatcc/flatcc_emitter.h"
 
+static inline size_t min_page_size(flatcc_emitter_t *E)
+{
+    return E->page_size ? E->page_size : FLATCC_EMITTER_PAGE_SIZE;
+}
+
+static inline size_t page_size_limit(flatcc_emitter_t *E)
+{
+    size_t limit = E->page_size_limit ? E->page_size_limit : FLATCC_EMITTER_PAGE_SIZE_LIMIT;
+
+    return limit < min_page_size(E) ? min_page_size(E) : limit;
+}
+
+/*
+ * New pages are as large as the current capacity, within limits, so
+ * the total capacity grows geometrically and large buffers need few
+ * allocations, while small buffers stay on a single small page.
+ */
+static flatcc_emitter_page_t *alloc_page(flatcc_emitter_t *E)
+{
+    flatcc_emitter_page_t *p;
+    flatcc_iovec_t b;
+    uint8_t *page;
+    size_t size = E->capacity;
+
+    if (size < min_page_size(E)) {
+        size = min_page_size(E);
+    }
+    if (size > page_size_limit(E)) {
+        size = page_size_limit(E);
+    }
+    size &= ~(2 * (size_t)FLATCC_EMITTER_PAGE_MULTIPLE - 1);
+    /* The page header is stored after the page content to keep the content aligned. */
+    if (E->alloc) {
+        b.iov_base = 0;
+        b.iov_len = 0;
+        if (E->alloc(E->alloc_context, &b, size + sizeof(flatcc_emitter_page_t))) {
+            return 0;
+        }
+        page = b.iov_base;
+    } else if (!(page = FLATCC_EMITTER_ALLOC(size + sizeof(flatcc_emitter_page_t)))) {
+        return 0;
+    }
+    p = (flatcc_emitter_page_t *)(page + size);
+    p->page = page;
+    p->page_size = size;
+    E->capacity += size;
+    return p;
+}
+
+static inline void free_page(flatcc_emitter_t *E, flatcc_emitter_page_t *p)
+{
+    flatcc_iovec_t b;
+
+    E->capacity -= p->page_size;
+    if (E->alloc) {
+        b.iov_base = p->page;
+        b.iov_len = p->page_size + sizeof(flatcc_emitter_page_t);
+        E->alloc(E->alloc_context, &b, 0);
+        return;
+    }
+    FLATCC_EMITTER_FREE(p->page);
+}
+
+/* The first page is split between front and back. */
+static inline void init_first_page(flatcc_emitter_t *E, flatcc_emitter_page_t *p)
+{
+    E->front = p;
+    E->back = p;
+    E->front_cursor = p->page + p->page_size / 2;
+    E->back_cursor = E->front_cursor;
+    E->front_left = p->page_size / 2;
+    E->back_left = p->page_size - E->front_left;
+    p->page_offset = -(flatbuffers_soffset_t)E->front_left;
+}
+
+/*
+ * Passes the front content of a completed front page to the flush
+ * function. The page is recycled unless it is also the back page.
+ */
+static int flush_front_page(flatcc_emitter_t *E, flatcc_emitter_page_t *p)
+{
+    flatbuffers_soffset_t end = p->page_offset + (flatbuffers_soffset_t)p->page_size;
+
+    /* The first page holds the start of the back content above offset 0. */
+    if (end > 0) {
+        end = 0;
+    }
+    if (end > p->page_offset) {
+        if (E->flush(E->flush_context, p->page,
+                (size_t)(end - p->page_offset), p->page_offset)) {
+            return -1;
+        }
+        E->flushed_start = p->page_offset;
+    }
+    if (p != E->back) {
+        flatcc_emitter_recycle_page(E, p);
+    }
+    return 0;
+}
+
 static int advance_front(flatcc_emitter_t *E)
 {
-    flatcc_emitter_page_t *p = 0;
+    flatcc_emitter_page_t *p = 0, *old_front = E->front;
 
     if (E->front && E->front->prev != E->back) {
-        E->front->prev->page_offset = E->front->page_offset - FLATCC_EMITTER_PAGE_SIZE;
         E->front = E->front->prev;
         goto done;
     }
-    if (!(p = FLATCC_EMITTER_ALLOC(sizeof(flatcc_emitter_page_t)))) {
+    if (!(p = alloc_page(E))) {
         return -1;
     }
-    E->capacity += FLATCC_EMITTER_PAGE_SIZE;
     if (E->front) {
         p->prev = E->back;
         p->next = E->front;
@@ -28,20 +126,17 @@ static int advance_front(flatcc_emitter_t *E)
      * The first page is shared between front and back to avoid
      * double unecessary extra allocation.
      */
-    E->front = p;
-    E->back = p;
     p->next = p;
     p->prev = p;
-    E->front_cursor = E->front->page + FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->back_cursor = E->front_cursor;
-    E->front_left = FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->back_left = FLATCC_EMITTER_PAGE_SIZE - E->front_left;
-    p->page_offset = -(flatbuffers_soffset_t)E->front_left;
+    init_first_page(E, p);
     return 0;
 done:
-    E->front_cursor = E->front->page + FLATCC_EMITTER_PAGE_SIZE;
-    E->front_left = FLATCC_EMITTER_PAGE_SIZE;
-    E->front->page_offset = E->front->next->page_offset - FLATCC_EMITTER_PAGE_SIZE;
+    E->front_cursor = E->front->page + E->front->page_size;
+    E->front_left = E->front->page_size;
+    E->front->page_offset = E->front->next->page_offset - (flatbuffers_soffset_t)E->front->page_size;
+    if (E->flush) {
+        return flush_front_page(E, old_front);
+    }
     return 0;
 }
 
@@ -53,10 +148,9 @@ static int advance_back(flatcc_emitter_t *E)
         E->back = E->back->next;
         goto done;
     }
-    if (!(p = FLATCC_EMITTER_ALLOC(sizeof(flatcc_emitter_page_t)))) {
+    if (!(p = alloc_page(E))) {
         return -1;
     }
-    E->capacity += FLATCC_EMITTER_PAGE_SIZE;
     if (E->back) {
         p->prev = E->back;
         p->next = E->front;
@@ -69,20 +163,14 @@ static int advance_back(flatcc_emitter_t *E)
      * The first page is shared between front and back to avoid
      * double unecessary extra allocation.
      */
-    E->front = p;
-    E->back = p;
     p->next = p;
     p->prev = p;
-    E->front_cursor = E->front->page + FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->back_cursor = E->front_cursor;
-    E->front_left = FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->back_left = FLATCC_EMITTER_PAGE_SIZE - E->front_left;
-    p->page_offset = -(flatbuffers_soffset_t)E->front_left;
+    init_first_page(E, p);
     return 0;
 done:
     E->back_cursor = E->back->page;
-    E->back_left = FLATCC_EMITTER_PAGE_SIZE;
-    E->back->page_offset = E->back->prev->page_offset + FLATCC_EMITTER_PAGE_SIZE;
+    E->back_left = E->back->page_size;
+    E->back->page_offset = E->back->prev->page_offset + (flatbuffers_soffset_t)E->back->prev->page_size;
     return 0;
 }
 
@@ -151,17 +239,24 @@ int flatcc_emitter_recycle_page(flatcc_emitter_t *E, flatcc_emitter_page_t *p)
 
 void flatcc_emitter_reset(flatcc_emitter_t *E)
 {
-    flatcc_emitter_page_t *p = E->front;
+    flatcc_emitter_page_t *p;
 
     if (!E->front) {
         return;
     }
+    /*
+     * Restart from the smallest page so small buffers keep a small
+     * footprint after a large buffer has been built.
+     */
     E->back = E->front;
-    E->front_cursor = E->front->page + FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->back_cursor = E->front_cursor;
-    E->front_left = FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->back_left = FLATCC_EMITTER_PAGE_SIZE - FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->front->page_offset = -(flatbuffers_soffset_t)E->front_left;
+    for (p = E->front->next; p != E->front; p = p->next) {
+        if (p->page_size < E->back->page_size) {
+            E->back = p;
+        }
+    }
+    E->front = E->back;
+    init_first_page(E, E->front);
+    E->flushed_start = 0;
     /* Heuristic to reduce peak allocation over time. */
     if (E->used_average == 0) {
         E->used_average = E->used;
@@ -173,25 +268,117 @@ void flatcc_emitter_reset(flatcc_emitter_t *E)
         p = E->back->next;
         E->back->next = p->next;
         p->next->prev = E->back;
-        FLATCC_EMITTER_FREE(p);
-        E->capacity -= FLATCC_EMITTER_PAGE_SIZE;
+        free_page(E, p);
     }
 }
 
 void flatcc_emitter_clear(flatcc_emitter_t *E)
 {
-    flatcc_emitter_page_t *p = E->front;
+    flatcc_emitter_page_t *p = E->front, *next;
+    size_t page_size = E->page_size;
+    size_t limit = E->page_size_limit;
+    flatcc_emitter_flush_fun *flush = E->flush;
+    void *flush_context = E->flush_context;
+    flatcc_emitter_alloc_fun *alloc = E->alloc;
+    void *alloc_context = E->alloc_context;
 
-    if (!p) {
-        return;
+    if (p) {
+        p->prev->next = 0;
+        while (p) {
+            next = p->next;
+            free_page(E, p);
+            p = next;
+        }
     }
-    p->prev->next = 0;
-    while (p->next) {
+    memset(E, 0, sizeof(*E));
+    /* Page size, flush and allocator settings survive clear. */
+    E->page_size = page_size;
+    E->page_size_limit = limit;
+    E->flush = flush;
+    E->flush_context = flush_context;
+    E->alloc = alloc;
+    E->alloc_context = alloc_context;
+}
+
+static inline int flush_range(flatcc_emitter_t *E, flatcc_emitter_page_t *p,
+        flatbuffers_soffset_t start, flatbuffers_soffset_t end)
+{
+    if (end <= start) {
+        return 0;
+    }
+    return E->flush(E->flush_context, p->page + (start - p->page_offset),
+            (size_t)(end - start), start);
+}
+
+int flatcc_emitter_flush(flatcc_emitter_t *E)
+{
+    flatcc_emitter_page_t *p;
+    flatbuffers_soffset_t start, end;
+
+    if (!E->flush) {
+        return -1;
+    }
+    if (!E->front) {
+        return 0;
+    }
+    p = E->front;
+    for (;;) {
+        start = p->page_offset;
+        end = p->page_offset + (flatbuffers_soffset_t)p->page_size;
+        if (p == E->front) {
+            start += (flatbuffers_soffset_t)(E->front_cursor - p->page);
+        }
+        if (p == E->back) {
+            end = p->page_offset + (flatbuffers_soffset_t)(E->back_cursor - p->page);
+        }
+        /* Skip the part of the first page that was flushed during build. */
+        if (flush_range(E, p, start, end < E->flushed_start ? end : E->flushed_start) ||
+                flush_range(E, p, start > 0 ? start : 0, end)) {
+            return -1;
+        }
+        if (p == E->back) {
+            break;
+        }
         p = p->next;
-        FLATCC_EMITTER_FREE(p->prev);
     }
-    FLATCC_EMITTER_FREE(p);
-    memset(E, 0, sizeof(*E));
+    return 0;
+}
+
+int flatcc_emitter_rewind(flatcc_emitter_t *E,
+        flatbuffers_soffset_t front, flatbuffers_soffset_t back)
+{
+    flatcc_emitter_page_t *p;
+    flatbuffers_soffset_t cur_front, cur_back;
+
+    if (!E->front) {
+        return front == 0 && back == 0 ? 0 : -1;
+    }
+    cur_front = E->front->page_offset + (flatbuffers_soffset_t)(E->front_cursor - E->front->page);
+    cur_back = E->back->page_offset + (flatbuffers_soffset_t)(E->back_cursor - E->back->page);
+    if (front < cur_front || back > cur_back || front > back) {
+        return -1;
+    }
+    /* Front pages are flushed from offset 0 and downwards. */
+    if (E->flushed_start < 0 && front > E->flushed_start) {
+        return -1;
+    }
+    /* Pages passed by the new front stay between back and front for reuse. */
+    p = E->front;
+    while (front > p->page_offset + (flatbuffers_soffset_t)p->page_size) {
+        p = p->next;
+    }
+    E->front = p;
+    E->front_left = (size_t)(front - p->page_offset);
+    E->front_cursor = p->page + E->front_left;
+    p = E->back;
+    while (back < p->page_offset) {
+        p = p->prev;
+    }
+    E->back = p;
+    E->back_cursor = p->page + (back - p->page_offset);
+    E->back_left = p->page_size - (size_t)(back - p->page_offset);
+    E->used -= (size_t)(front - cur_front) + (size_t)(cur_back - back);
+    return 0;
 }
 
 int flatcc_emitter(void *emit_context,
@@ -243,6 +430,7 @@ copy:
 void *flatcc_emitter_copy_buffer(flatcc_emitter_t *E, void *buf, size_t size)
 {
     flatcc_emitter_page_t *p;
+    uint8_t *dst = buf;
     size_t len;
 
     if (size < E->used) {
@@ -255,15 +443,59 @@ void *flatcc_emitter_copy_buffer(flatcc_emitter_t *E, void *buf, size_t size)
         memcpy(buf, E->front_cursor, E->used);
         return buf;
     }
-    len = FLATCC_EMITTER_PAGE_SIZE - E->front_left;
-    memcpy(buf, E->front_cursor, len);
-    buf = (uint8_t *)buf + len;
+    len = E->front->page_size - E->front_left;
+    memcpy(dst, E->front_cursor, len);
+    dst += len;
     p = E->front->next;
     while (p != E->back) {
-        memcpy(buf, p->page, FLATCC_EMITTER_PAGE_SIZE);
-        buf = (uint8_t *)buf + FLATCC_EMITTER_PAGE_SIZE;
+        memcpy(dst, p->page, p->page_size);
+        dst += p->page_size;
         p = p->next;
     }
-    memcpy(buf, p->page, FLATCC_EMITTER_PAGE_SIZE - E->back_left);
+    memcpy(dst, p->page, p->page_size - E->back_left);
     return buf;
 }
+
+int flatcc_emitter_get_iov(flatcc_emitter_t *E, flatcc_iovec_t *iov, int iov_max)
+{
+    flatcc_emitter_page_t *p;
+    uint8_t *base;
+    size_t len;
+    int n = 0;
+
+    if (!E->front || E->used == 0) {
+        return 0;
+    }
+    if (E->front == E->back) {
+        if (iov_max > 0) {
+            iov[0].iov_base = E->front_cursor;
+            iov[0].iov_len = E->used;
+        }
+        return 1;
+    }
+    p = E->front;
+    for (;;) {
+        if (p == E->front) {
+            base = E->front_cursor;
+            len = p->page_size - E->front_left;
+        } else if (p == E->back) {
+            base = p->page;
+            len = p->page_size - E->back_left;
+        } else {
+            base = p->page;
+            len = p->page_size;
+        }
+        if (len > 0) {
+            if (n < iov_max) {
+                iov[n].iov_base = base;
+                iov[n].iov_len = len;
+            }
+            ++n;
+        }
+        if (p == E->back) {
+            break;
+        }
+        p = p->next;
+    }
+    return n;
+}
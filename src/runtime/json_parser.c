@@ -1,6 +1,7 @@
 #include "flatcc/flatcc_rtconfig.h"
 #include "flatcc/flatcc_json_parser.h"
 #include "flatcc/flatcc_assert.h"
+#include "flatcc/flatcc_alloc.h"
 
 #define uoffset_t flatbuffers_uoffset_t
 #define soffset_t flatbuffers_soffset_t
@@ -62,16 +63,249 @@ const char *flatcc_json_parser_set_error(flatcc_json_parser_t *ctx, const char *
     return end;
 }
 
-const char *flatcc_json_parser_string_part(flatcc_json_parser_t *ctx, const char *buf, const char *end)
+/*
+ * Character class index, see `flatcc_json_parser_build_index`.
+ *
+ * Bytes are compared in parallel and the compare result is left in the
+ * high bit of each byte. A multiplication then gathers the 8 high bits
+ * of a 64-bit word into one byte of the block mask.
+ */
+
+#if FLATCC_JSON_PARSE_INDEX_VECTOR && (defined(__GNUC__) || defined(__clang__)) && \
+        defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define USE_INDEX_VECTOR
+#endif
+
+#define index_ones UINT64_C(0x0101010101010101)
+#define index_high UINT64_C(0x8080808080808080)
+#define index_low7 UINT64_C(0x7f7f7f7f7f7f7f7f)
+
+/* Gathers the high bit of byte `i` into bit `i`. */
+static inline uint64_t index_gather(uint64_t h)
+{
+    return ((h & index_high) * UINT64_C(0x0002040810204081)) >> 56;
+}
+
+/* High bit of bytes equal to `c`, without carry between bytes. */
+static inline uint64_t index_eq(uint64_t w, unsigned char c)
+{
+    uint64_t x = w ^ (index_ones * c);
+
+    return ~(((x & index_low7) + index_low7) | x) & index_high;
+}
+
+/* High bit of bytes below 0x20. */
+static inline uint64_t index_control(uint64_t w)
+{
+    return ~(((w & index_low7) + index_ones * 0x60) | w) & index_high;
+}
+
+#ifdef USE_INDEX_VECTOR
+
+typedef unsigned char index_vec_t __attribute__((vector_size(16)));
+typedef uint64_t index_vec64_t __attribute__((vector_size(16)));
+
+static inline uint64_t index_gather_vec(index_vec_t v)
+{
+    index_vec64_t h = (index_vec64_t)v;
+
+    return index_gather(h[0]) | (index_gather(h[1]) << 8);
+}
+
+static void index_block(const char *p, flatcc_json_parser_index_block_t *block)
+{
+    index_vec_t v, lf, cr, space, special;
+    uint64_t nonspace = 0, lf_mask = 0, cr_mask = 0, special_mask = 0;
+    int i;
+
+    for (i = 0; i < 4; ++i) {
+        memcpy(&v, p + 16 * i, sizeof(v));
+        lf = (index_vec_t)(v == '\n');
+        cr = (index_vec_t)(v == '\r');
+        space = (index_vec_t)(v == ' ') | (index_vec_t)(v == '\t') | lf | cr;
+        special = (index_vec_t)(v == '"') | (index_vec_t)(v == '\\') | (index_vec_t)(v < 0x20);
+        nonspace |= index_gather_vec(~space) << (16 * i);
+        lf_mask |= index_gather_vec(lf) << (16 * i);
+        cr_mask |= index_gather_vec(cr) << (16 * i);
+        special_mask |= index_gather_vec(special) << (16 * i);
+    }
+    block->nonspace = nonspace;
+    block->newline = lf_mask | (cr_mask & ~(lf_mask >> 1));
+    block->special = special_mask;
+}
+
+#else
+
+static void index_block(const char *p, flatcc_json_parser_index_block_t *block)
+{
+    uint64_t w, lf, cr, nonspace = 0, lf_mask = 0, cr_mask = 0, special = 0;
+    int i;
+
+    for (i = 0; i < 8; ++i) {
+        memcpy(&w, p + 8 * i, sizeof(w));
+        w = le64toh(w);
+        lf = index_eq(w, '\n');
+        cr = index_eq(w, '\r');
+        nonspace |= index_gather(~(index_eq(w, ' ') | index_eq(w, '\t') | lf | cr)) << (8 * i);
+        lf_mask |= index_gather(lf) << (8 * i);
+        cr_mask |= index_gather(cr) << (8 * i);
+        special |= index_gather(index_eq(w, '"') | index_eq(w, '\\') | index_control(w)) << (8 * i);
+    }
+    block->nonspace = nonspace;
+    block->newline = lf_mask | (cr_mask & ~(lf_mask >> 1));
+    block->special = special;
+}
+
+#endif
+
+static inline int index_ctz(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+
+    while (!(x & 1)) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+static inline int index_msb(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(x);
+#else
+    int n = 0;
+
+    while (x >>= 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+static inline int index_popcount(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & UINT64_C(0x5555555555555555));
+    x = (x & UINT64_C(0x3333333333333333)) + ((x >> 2) & UINT64_C(0x3333333333333333));
+    x = (x + (x >> 4)) & UINT64_C(0x0f0f0f0f0f0f0f0f);
+    return (int)((x * index_ones) >> 56);
+#endif
+}
+
+int flatcc_json_parser_build_index(flatcc_json_parser_t *ctx)
+{
+    flatcc_json_parser_index_block_t *index;
+    char tail[64];
+    size_t k, size = (size_t)(ctx->end - ctx->start);
+    /* At least one byte of zero padding ends every scan. */
+    size_t n = size / 64 + 1;
+
+    flatcc_json_parser_clear_index(ctx);
+    if (n > (size_t)-1 / sizeof(index[0]) ||
+            !(index = FLATCC_ALLOC(n * sizeof(index[0])))) {
+        return -1;
+    }
+    for (k = 0; k + 1 < n; ++k) {
+        index_block(ctx->start + 64 * k, index + k);
+        /* CR LF split between blocks. */
+        if (k > 0 && ctx->start[64 * k] == '\n' && ctx->start[64 * k - 1] == '\r') {
+            index[k - 1].newline &= ~(UINT64_C(1) << 63);
+        }
+    }
+    memset(tail, 0, sizeof(tail));
+    memcpy(tail, ctx->start + 64 * k, size - 64 * k);
+    index_block(tail, index + k);
+    if (k > 0 && tail[0] == '\n' && ctx->start[64 * k - 1] == '\r') {
+        index[k - 1].newline &= ~(UINT64_C(1) << 63);
+    }
+    ctx->index = index;
+    return 0;
+}
+
+void flatcc_json_parser_clear_index(flatcc_json_parser_t *ctx)
+{
+    if (ctx->index) {
+        FLATCC_FREE((void *)ctx->index);
+        ctx->index = 0;
+    }
+}
+
+/*
+ * Skips space from `buf` using the index, counting lines. The padding
+ * after the input is not space so the scan stops at `ctx->end`.
+ */
+static const char *index_space(flatcc_json_parser_t *ctx, const char *buf)
+{
+    size_t pos = (size_t)(buf - ctx->start), k = pos / 64;
+    uint64_t w, newline, mask = ~UINT64_C(0) << (pos % 64);
+
+    for (;; ++k, mask = ~UINT64_C(0)) {
+        w = ctx->index[k].nonspace & mask;
+        newline = ctx->index[k].newline & mask;
+        if (w) {
+            newline &= (w & (~w + 1)) - 1;
+        }
+        if (newline) {
+            ctx->line += index_popcount(newline);
+            ctx->line_start = ctx->start + 64 * k + (size_t)index_msb(newline) + 1;
+        }
+        if (w) {
+            return ctx->start + 64 * k + (size_t)index_ctz(w);
+        }
+    }
+}
+
+/* Finds the first quote, backslash, or control character from `buf`. */
+static const char *index_special(flatcc_json_parser_t *ctx, const char *buf)
 {
+    size_t pos = (size_t)(buf - ctx->start), k = pos / 64;
+    uint64_t w = ctx->index[k].special & (~UINT64_C(0) << (pos % 64));
+
+    while (!w) {
+        w = ctx->index[++k].special;
+    }
+    return ctx->start + 64 * k + (size_t)index_ctz(w);
+}
+
 /*
- * Disabled because it doesn't catch all control characters, but is
- * useful for performance testing.
+ * Finds the first quote, backslash, or control character from `buf`
+ * without an index, or `end`. Unlike the `cmpistri` instruction, which
+ * stops at a zero byte, all bytes below 0x20 are found.
  */
-#if 0
-//#ifdef USE_SSE4_2
-    cmpistri(end, buf, "\"\\\0\r\n\t\v\f", _SIDD_POSITIVE_POLARITY);
+static inline const char *scan_special(const char *buf, const char *end)
+{
+#ifdef USE_INDEX_VECTOR
+    index_vec_t v;
+    uint64_t m;
+
+    while (end - buf >= 16) {
+        memcpy(&v, buf, sizeof(v));
+        m = index_gather_vec((index_vec_t)(v == '"') | (index_vec_t)(v == '\\') | (index_vec_t)(v < 0x20));
+        if (m) {
+            return buf + index_ctz(m);
+        }
+        buf += 16;
+    }
 #else
+    uint64_t w, m;
+
+    while (end - buf >= 8) {
+        memcpy(&w, buf, sizeof(w));
+        w = le64toh(w);
+        m = index_eq(w, '"') | index_eq(w, '\\') | index_control(w);
+        if (m) {
+            return buf + index_ctz(m) / 8;
+        }
+        buf += 8;
+    }
+#endif
     /*
      * Testing for signed char >= 0x20 would also capture UTF-8
      * encodings that we could verify, and also invalid encodings like
@@ -80,7 +314,16 @@ const char *flatcc_json_parser_string_part(flatcc_json_parser_t *ctx, const char
     while (buf != end && *buf != '\"' && ((unsigned char)*buf) >= 0x20 && *buf != '\\') {
         ++buf;
     }
-#endif
+    return buf;
+}
+
+const char *flatcc_json_parser_string_part(flatcc_json_parser_t *ctx, const char *buf, const char *end)
+{
+    if (ctx->index && end == ctx->end) {
+        buf = index_special(ctx, buf);
+    } else {
+        buf = scan_special(buf, end);
+    }
     if (buf == end) {
         return flatcc_json_parser_set_error(ctx, buf, end, flatcc_json_parser_error_unterminated_string);
     }
@@ -95,6 +338,14 @@ const char *flatcc_json_parser_string_part(flatcc_json_parser_t *ctx, const char
 
 const char *flatcc_json_parser_space_ext(flatcc_json_parser_t *ctx, const char *buf, const char *end)
 {
+    if (ctx->index && end == ctx->end) {
+        buf = index_space(ctx, buf);
+        /* Like below, signed characters above 0x7f are unexpected. */
+        if (buf != end && *buf <= 0x20) {
+            return flatcc_json_parser_set_error(ctx, buf, end, flatcc_json_parser_error_unexpected_character);
+        }
+        return buf;
+    }
 again:
 #ifdef USE_SSE4_2
     /*
@@ -887,28 +1138,56 @@ const char *flatcc_json_parser_char_array(flatcc_json_parser_t *ctx,
 
 /* String Creation - depends on flatcc builder. */
 
+/*
+ * A string with escapes is decoded in a single pass into space reserved
+ * on the builder string: every run between escapes is copied as a whole
+ * and each escape is written directly after it. The reservation grows
+ * geometrically, but never beyond the remaining input because decoded
+ * text is never longer than its source. The excess is truncated at the
+ * end.
+ */
 const char *flatcc_json_parser_build_string(flatcc_json_parser_t *ctx,
         const char *buf, const char *end, flatcc_builder_ref_t *ref)
 {
     flatcc_json_parser_escape_buffer_t code;
     const char *mark;
+    char *s = 0;
+    size_t n, k, len = 0, room = 0;
 
     buf = flatcc_json_parser_string_start(ctx, buf, end);
     buf = flatcc_json_parser_string_part(ctx, (mark = buf), end);
     if (buf != end && *buf == '\"') {
         *ref = flatcc_builder_create_string(ctx->ctx, mark, (size_t)(buf - mark));
-    } else {
-        if (flatcc_builder_start_string(ctx->ctx) ||
-                0 == flatcc_builder_append_string(ctx->ctx, mark, (size_t)(buf - mark))) goto failed;
-        while (buf != end && *buf != '\"') {
-            buf = flatcc_json_parser_string_escape(ctx, buf, end, code);
-            if (0 == flatcc_builder_append_string(ctx->ctx, code + 1, (size_t)code[0])) goto failed;
-            if (end != (buf = flatcc_json_parser_string_part(ctx, (mark = buf), end))) {
-                if (0 == flatcc_builder_append_string(ctx->ctx, mark, (size_t)(buf - mark))) goto failed;
+        return flatcc_json_parser_string_end(ctx, buf, end);
+    }
+    if (flatcc_builder_start_string(ctx->ctx)) goto failed;
+    for (;;) {
+        n = (size_t)(buf - mark);
+        /* Room for the run and the escape that may follow. */
+        if (room - len < n + sizeof(code)) {
+            k = len + n + sizeof(code);
+            if (k < 2 * room) {
+                k = 2 * room;
+                if (k > len + (size_t)(end - mark) + sizeof(code)) {
+                    k = len + (size_t)(end - mark) + sizeof(code);
+                }
             }
+            if (0 == flatcc_builder_extend_string(ctx->ctx, k - room)) goto failed;
+            room = k;
+            s = flatcc_builder_string_edit(ctx->ctx);
+        }
+        memcpy(s + len, mark, n);
+        len += n;
+        if (buf == end || *buf == '\"') {
+            break;
         }
-        *ref = flatcc_builder_end_string(ctx->ctx);
+        buf = flatcc_json_parser_string_escape(ctx, buf, end, code);
+        memcpy(s + len, code + 1, (size_t)code[0]);
+        len += (size_t)code[0];
+        buf = flatcc_json_parser_string_part(ctx, (mark = buf), end);
     }
+    flatcc_builder_truncate_string(ctx->ctx, room - len);
+    *ref = flatcc_builder_end_string(ctx->ctx);
     return flatcc_json_parser_string_end(ctx, buf, end);
 
 failed:
@@ -1267,7 +1546,11 @@ int flatcc_json_parser_table_as_root(flatcc_builder_t *B, flatcc_json_parser_t *
     ctx = ctx ? ctx : &_ctx;
     flatcc_json_parser_init(ctx, B, buf, buf + bufsiz, flags);
     if (flatcc_builder_start_buffer(B, fid, 0, builder_flags)) return -1;
+    if (flags & flatcc_json_parser_f_with_index) {
+        flatcc_json_parser_build_index(ctx);
+    }
     buf = parser(ctx, buf, buf + bufsiz, &root);
+    flatcc_json_parser_clear_index(ctx);
     if (ctx->error) {
         return ctx->error;
     }
@@ -1287,7 +1570,11 @@ int flatcc_json_parser_struct_as_root(flatcc_builder_t *B, flatcc_json_parser_t
     ctx = ctx ? ctx : &_ctx;
     flatcc_json_parser_init(ctx, B, buf, buf + bufsiz, flags);
     if (flatcc_builder_start_buffer(B, fid, 0, builder_flags)) return -1;
+    if (flags & flatcc_json_parser_f_with_index) {
+        flatcc_json_parser_build_index(ctx);
+    }
     buf = parser(ctx, buf, buf + bufsiz, &root);
+    flatcc_json_parser_clear_index(ctx);
     if (ctx->error) {
         return ctx->error;
     }
@@ -1295,3 +1582,257 @@ int flatcc_json_parser_struct_as_root(flatcc_builder_t *B, flatcc_json_parser_t
     ctx->end_loc = buf;
     return 0;
 }
+
+/* Skips to the line following an error and clears the error. */
+static const char *skip_error_line(flatcc_json_parser_t *ctx, const char *end)
+{
+    const char *buf = ctx->error_loc;
+
+    ctx->error = 0;
+    if (!(buf = memchr(buf, '\n', (size_t)(end - buf)))) {
+        return end;
+    }
+    ++ctx->line;
+    ctx->line_start = ++buf;
+    return flatcc_json_parser_space(ctx, buf, end);
+}
+
+/* True if the space between a record and `buf` has a line break. */
+static int follows_line_break(const char *start, const char *buf)
+{
+    while (buf != start) {
+        switch (*--buf) {
+        case '\n':
+            return 1;
+        case ' ': case '\t': case '\r': case '\v': case '\f':
+            continue;
+        default:
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int flatcc_json_parser_table_lines(flatcc_builder_t *B, flatcc_json_parser_t *ctx,
+        const char *buf, size_t bufsiz, flatcc_json_parser_flags_t flags, const char *fid,
+        flatcc_json_parser_table_f *parser, flatcc_json_parser_record_f *record, void *context)
+{
+    flatcc_json_parser_t _ctx;
+    flatcc_builder_ref_t root;
+    flatcc_builder_buffer_flags_t builder_flags = flags & flatcc_json_parser_f_with_size ? flatcc_builder_with_size : 0;
+    const char *end = buf + bufsiz;
+    int separated = 1, ret = 0;
+
+    ctx = ctx ? ctx : &_ctx;
+    flatcc_json_parser_init(ctx, B, buf, end, flags);
+    if (flags & flatcc_json_parser_f_with_index) {
+        flatcc_json_parser_build_index(ctx);
+    }
+    buf = flatcc_json_parser_space(ctx, buf, end);
+    while (!ret && (buf != end || ctx->error)) {
+        if (!ctx->error) {
+            flatcc_builder_reset(B);
+            /* A record on the same line as the previous record fails. */
+            if (!separated) {
+                flatcc_json_parser_set_error(ctx, buf, end, flatcc_json_parser_error_unexpected_character);
+            }
+        }
+        if (!ctx->error) {
+            if (flatcc_builder_start_buffer(B, fid, 0, builder_flags)) {
+                ret = -1;
+                break;
+            }
+            buf = parser(ctx, buf, end, &root);
+            if (!ctx->error) {
+                if (!flatcc_builder_end_buffer(B, root)) {
+                    ret = -1;
+                    break;
+                }
+                ctx->end_loc = buf;
+                separated = follows_line_break(ctx->start, buf);
+            }
+        }
+        ret = record(context, B, ctx);
+        if (ctx->error) {
+            buf = skip_error_line(ctx, end);
+            separated = 1;
+        }
+    }
+    flatcc_json_parser_clear_index(ctx);
+    return ret;
+}
+
+/*
+ * Parses the value retained from `start` to `end`. `incomplete` is the
+ * error of a value cut off by the end of input, or 0.
+ */
+static int parse_stream_value(flatcc_json_parser_stream_t *S, size_t start, size_t end, int incomplete)
+{
+    flatcc_json_parser_t *ctx = &S->ctx;
+    flatcc_builder_ref_t root = 0;
+    flatcc_builder_buffer_flags_t builder_flags = S->flags & flatcc_json_parser_f_with_size ? flatcc_builder_with_size : 0;
+    const char *value_start = S->buf + start, *value_end = S->buf + end, *buf = value_start;
+    int ret;
+
+    flatcc_json_parser_init(ctx, S->B, buf, value_end, S->flags);
+    ctx->line = S->line;
+    flatcc_builder_reset(S->B);
+    if (flatcc_builder_start_buffer(S->B, S->fid, 0, builder_flags)) {
+        return -1;
+    }
+    if (S->flags & flatcc_json_parser_f_with_index) {
+        flatcc_json_parser_build_index(ctx);
+    }
+    buf = S->parser(ctx, buf, value_end, &root);
+    flatcc_json_parser_clear_index(ctx);
+    if (!ctx->error && buf != value_end) {
+        flatcc_json_parser_set_error(ctx, buf, value_end, flatcc_json_parser_error_unexpected_character);
+    }
+    /* The parser accepts a table that is not closed at end of input. */
+    if (!ctx->error && incomplete) {
+        flatcc_json_parser_set_error(ctx, value_end, value_end, incomplete);
+    }
+    if (!ctx->error) {
+        if (!flatcc_builder_end_buffer(S->B, root)) {
+            return -1;
+        }
+        ctx->end_loc = buf;
+        ++S->record_count;
+    } else {
+        ++S->error_count;
+    }
+    ret = S->record(S->context, S->B, ctx);
+    /* Lines are counted by the scan, not the parse which may have failed. */
+    for (buf = value_start; buf != value_end; ++buf) {
+        S->line += *buf == '\n';
+    }
+    return ret;
+}
+
+/*
+ * Finds complete top level values in the retained input. A value ends
+ * when its outermost brace or bracket closes or, for other content,
+ * with the following space, which is left to the parser to reject.
+ * Values are parsed in place, and only the incomplete value is moved to
+ * the start of the retained input once the chunk has been scanned.
+ */
+static int stream_scan(flatcc_json_parser_stream_t *S)
+{
+    size_t i = S->scanned, start = 0;
+    char c;
+    int ret;
+
+    while (i < S->size) {
+        c = S->buf[i++];
+        if (S->in_string) {
+            if (S->escape) {
+                S->escape = 0;
+            } else if (c == '\\') {
+                S->escape = 1;
+            } else if (c == '"') {
+                S->in_string = 0;
+            }
+            continue;
+        }
+        if (!S->in_value) {
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                S->line += c == '\n';
+                continue;
+            }
+            start = i - 1;
+            S->in_value = 1;
+        }
+        switch (c) {
+        case '"':
+            S->in_string = 1;
+            continue;
+        case '{': case '[':
+            ++S->depth;
+            continue;
+        case '}': case ']':
+            if (--S->depth > 0) {
+                continue;
+            }
+            break;
+        case ' ': case '\t': case '\r': case '\n':
+            if (S->depth > 0) {
+                continue;
+            }
+            /* The space is scanned again between values. */
+            --i;
+            break;
+        default:
+            continue;
+        }
+        S->in_value = 0;
+        S->depth = 0;
+        if ((ret = parse_stream_value(S, start, i, 0))) {
+            return ret;
+        }
+    }
+    if (!S->in_value) {
+        start = S->size;
+    }
+    if (start > 0) {
+        memmove(S->buf, S->buf + start, S->size - start);
+        S->size -= start;
+    }
+    S->scanned = S->size;
+    return 0;
+}
+
+int flatcc_json_parser_stream_feed(flatcc_json_parser_stream_t *S, const char *buf, size_t bufsiz)
+{
+    size_t n;
+    char *p;
+
+    if (bufsiz > S->capacity - S->size) {
+        n = S->capacity ? S->capacity : 4096;
+        while (n - S->size < bufsiz) {
+            if (n > (size_t)-1 / 2) {
+                return -1;
+            }
+            n *= 2;
+        }
+        if (!(p = FLATCC_REALLOC(S->buf, n))) {
+            return -1;
+        }
+        S->buf = p;
+        S->capacity = n;
+    }
+    memcpy(S->buf + S->size, buf, bufsiz);
+    S->size += bufsiz;
+    return stream_scan(S);
+}
+
+int flatcc_json_parser_stream_end(flatcc_json_parser_stream_t *S)
+{
+    int ret, incomplete = 0;
+
+    if (!S->in_value) {
+        return 0;
+    }
+    if (S->in_string) {
+        incomplete = flatcc_json_parser_error_unterminated_string;
+    } else if (S->depth > 0) {
+        incomplete = S->buf[0] == '[' ? flatcc_json_parser_error_unbalanced_array :
+                flatcc_json_parser_error_unbalanced_object;
+    }
+    ret = parse_stream_value(S, 0, S->size, incomplete);
+    S->size = 0;
+    S->scanned = 0;
+    S->in_value = 0;
+    S->in_string = 0;
+    S->escape = 0;
+    S->depth = 0;
+    return ret;
+}
+
+void flatcc_json_parser_stream_clear(flatcc_json_parser_stream_t *S)
+{
+    FLATCC_FREE(S->buf);
+    S->buf = 0;
+    S->size = 0;
+    S->capacity = 0;
+    S->scanned = 0;
+}
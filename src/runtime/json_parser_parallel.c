@@ -0,0 +1,174 @@
+/*
+ * Parallel conversion of newline delimited JSON, see
+ * `flatcc_json_parser_parallel_lines` in `flatcc/flatcc_json_parser.h`.
+ */
+#include <string.h>
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_json_parser.h"
+#include "flatcc/flatcc_builder_pool.h"
+#include "flatcc/flatcc_alloc.h"
+
+#ifndef FLATCC_JSON_PARSER_CHUNK_SIZE
+#define FLATCC_JSON_PARSER_CHUNK_SIZE (1024 * 1024)
+#endif
+
+/* Bounds the output held before it is written. */
+#ifndef FLATCC_JSON_PARSER_BATCH_SIZE
+#define FLATCC_JSON_PARSER_BATCH_SIZE 64
+#endif
+
+typedef struct lines_chunk {
+    const char *buf;
+    size_t size;
+    /* Size prefixed buffers of the chunk, capacity kept between batches. */
+    char *out;
+    size_t out_size;
+    size_t out_capacity;
+    size_t record_count;
+    size_t error_count;
+    /* Line breaks consumed by the parser. */
+    int lines;
+    int error;
+    int error_line;
+    int error_pos;
+    int ret;
+} lines_chunk_t;
+
+typedef struct lines_batch {
+    flatcc_json_parser_parallel_lines_t *P;
+    flatcc_builder_pool_t builders;
+    lines_chunk_t *chunks;
+} lines_batch_t;
+
+static int add_record(void *context, flatcc_builder_t *B, flatcc_json_parser_t *ctx)
+{
+    lines_chunk_t *c = context;
+    size_t n, size;
+    char *p;
+
+    if (ctx->error) {
+        if (!c->error_count++) {
+            c->error = ctx->error;
+            c->error_line = ctx->line;
+            c->error_pos = ctx->pos;
+        }
+        return 0;
+    }
+    size = flatcc_builder_get_buffer_size(B);
+    if (size > c->out_capacity - c->out_size) {
+        n = c->out_capacity ? c->out_capacity : 4096;
+        while (n - c->out_size < size) {
+            if (n > (size_t)-1 / 2) {
+                return -1;
+            }
+            n *= 2;
+        }
+        if (!(p = FLATCC_REALLOC(c->out, n))) {
+            return -1;
+        }
+        c->out = p;
+        c->out_capacity = n;
+    }
+    if (!flatcc_builder_copy_buffer(B, c->out + c->out_size, size)) {
+        return -1;
+    }
+    c->out_size += size;
+    ++c->record_count;
+    return 0;
+}
+
+static void parse_chunk(void *arg, size_t index)
+{
+    lines_batch_t *batch = arg;
+    lines_chunk_t *c = batch->chunks + index;
+    flatcc_json_parser_parallel_lines_t *P = batch->P;
+    flatcc_json_parser_t ctx;
+    flatcc_builder_t *B;
+
+    if (!(B = flatcc_builder_pool_acquire(&batch->builders))) {
+        c->ret = -1;
+        return;
+    }
+    c->ret = flatcc_json_parser_table_lines(B, &ctx, c->buf, c->size,
+            P->flags | flatcc_json_parser_f_with_size, P->fid, P->parser, add_record, c);
+    c->lines = ctx.line - 1;
+    flatcc_builder_pool_release(&batch->builders, B);
+}
+
+int flatcc_json_parser_parallel_lines(flatcc_json_parser_parallel_lines_t *P,
+        const char *buf, size_t bufsiz, flatcc_json_parser_write_f *write, void *context)
+{
+    lines_batch_t batch;
+    lines_chunk_t *c;
+    size_t i, n, pos = 0;
+    size_t chunk_size = P->chunk_size ? P->chunk_size : FLATCC_JSON_PARSER_CHUNK_SIZE;
+    size_t batch_size = P->batch_size ? P->batch_size : FLATCC_JSON_PARSER_BATCH_SIZE;
+    const char *p;
+    int line_base = 0, ret = 0;
+
+    P->record_count = 0;
+    P->error_count = 0;
+    P->error = 0;
+    P->error_line = 0;
+    P->error_pos = 0;
+    batch.P = P;
+    if (batch_size > (size_t)-1 / sizeof(batch.chunks[0]) ||
+            !(batch.chunks = FLATCC_ALLOC(batch_size * sizeof(batch.chunks[0])))) {
+        return -1;
+    }
+    memset(batch.chunks, 0, batch_size * sizeof(batch.chunks[0]));
+    if (flatcc_builder_pool_init(&batch.builders, 0, 0)) {
+        FLATCC_FREE(batch.chunks);
+        return -1;
+    }
+    while (!ret && pos < bufsiz) {
+        /* Chunks end after the first line break past `chunk_size`. */
+        for (n = 0; n < batch_size && pos < bufsiz; ++n) {
+            c = batch.chunks + n;
+            c->buf = buf + pos;
+            if (bufsiz - pos <= chunk_size ||
+                    !(p = memchr(buf + pos + chunk_size - 1, '\n', bufsiz - pos - chunk_size + 1))) {
+                c->size = bufsiz - pos;
+            } else {
+                c->size = (size_t)(p + 1 - c->buf);
+            }
+            pos += c->size;
+            c->out_size = 0;
+            c->record_count = 0;
+            c->error_count = 0;
+            c->error = 0;
+            c->ret = 0;
+        }
+        if (P->parallel_for && n > 1) {
+            P->parallel_for(P->pool, parse_chunk, &batch, n);
+        } else {
+            for (i = 0; i < n; ++i) {
+                parse_chunk(&batch, i);
+            }
+        }
+        for (i = 0; !ret && i < n; ++i) {
+            c = batch.chunks + i;
+            if ((ret = c->ret)) {
+                break;
+            }
+            P->record_count += c->record_count;
+            if (c->error_count && !P->error_count) {
+                P->error = c->error;
+                P->error_line = line_base + c->error_line;
+                P->error_pos = c->error_pos;
+            }
+            P->error_count += c->error_count;
+            line_base += c->lines;
+            if (c->out_size) {
+                ret = write(context, c->out, c->out_size);
+            }
+        }
+    }
+    for (i = 0; i < batch_size; ++i) {
+        FLATCC_FREE(batch.chunks[i].out);
+    }
+    FLATCC_FREE(batch.chunks);
+    flatcc_builder_pool_clear(&batch.builders);
+    return ret;
+}
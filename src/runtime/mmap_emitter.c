@@ -0,0 +1,295 @@
+/*
+ * mmap, ftruncate, etc. are not visible with -std=c11 unless
+ * requested explicitly.
+ */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdlib.h>
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_mmap_emitter.h"
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#include <unistd.h>
+#endif
+
+#if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+#define FLATCC_HAS_MMAP 1
+#else
+#define FLATCC_HAS_MMAP 0
+#endif
+
+#if FLATCC_HAS_MMAP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+
+/*
+ * Keeps the zero point, and thereby the start of the final buffer,
+ * aligned to any reasonable buffer alignment.
+ */
+#define map_align 4096u
+
+static inline size_t alignup_size(size_t x, size_t align)
+{
+    return (x + align - 1u) & ~(align - 1u);
+}
+
+static int map_file(flatcc_mmap_emitter_t *E, size_t capacity)
+{
+    void *p;
+
+    if (ftruncate(E->fd, (off_t)capacity)) {
+        return -1;
+    }
+    p = mmap(0, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, E->fd, 0);
+    if (p == MAP_FAILED) {
+        return -1;
+    }
+    E->map = p;
+    E->capacity = capacity;
+    return 0;
+}
+
+static void unmap_file(flatcc_mmap_emitter_t *E)
+{
+    if (E->map) {
+        munmap(E->map, E->capacity);
+        E->map = 0;
+    }
+}
+
+static void set_zero(flatcc_mmap_emitter_t *E)
+{
+    size_t back = alignup_size(E->capacity >> FLATCC_MMAP_EMITTER_BACK_SHIFT, map_align);
+
+    E->zero = E->capacity - back;
+    E->front_used = 0;
+    E->back_used = 0;
+    E->is_finalized = 0;
+}
+
+/*
+ * Makes room for at least `front_need` more bytes at the front and
+ * `back_need` more bytes at the back. The side that needs space
+ * gets at least as much as it already has so growth is geometric.
+ */
+static int grow(flatcc_mmap_emitter_t *E, size_t front_need, size_t back_need)
+{
+    size_t front_add = 0, back_add = 0, old_zero = E->zero;
+    size_t front_room = E->zero - E->front_used;
+    size_t back_room = E->capacity - E->zero - E->back_used;
+
+    if (front_need > front_room) {
+        front_add = front_need - front_room;
+        if (front_add < E->zero) {
+            front_add = E->zero;
+        }
+        front_add = alignup_size(front_add, map_align);
+    }
+    if (back_need > back_room) {
+        back_add = back_need - back_room;
+        if (back_add < E->capacity - E->zero) {
+            back_add = E->capacity - E->zero;
+        }
+        back_add = alignup_size(back_add, map_align);
+    }
+    if (E->capacity + front_add + back_add < E->capacity) {
+        return -1;
+    }
+    unmap_file(E);
+    if (map_file(E, E->capacity + front_add + back_add)) {
+        return -1;
+    }
+    if (front_add) {
+        E->zero += front_add;
+        memmove(E->map + E->zero - E->front_used,
+                E->map + old_zero - E->front_used, E->front_used + E->back_used);
+    }
+    return 0;
+}
+
+static int init(flatcc_mmap_emitter_t *E, size_t size_hint)
+{
+    size_hint = size_hint ? size_hint : FLATCC_MMAP_EMITTER_DEFAULT_SIZE;
+    /* Reserve an extra page for the back so the hint covers the front. */
+    if (map_file(E, alignup_size(size_hint, map_align) + map_align)) {
+        return -1;
+    }
+    set_zero(E);
+    return 0;
+}
+
+int flatcc_mmap_emitter_open(flatcc_mmap_emitter_t *E, const char *path, size_t size_hint)
+{
+    memset(E, 0, sizeof(*E));
+    if ((E->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0) {
+        E->fd = -1;
+        return -1;
+    }
+    E->owns_fd = 1;
+    if (init(E, size_hint)) {
+        flatcc_mmap_emitter_clear(E);
+        return -1;
+    }
+    return 0;
+}
+
+int flatcc_mmap_emitter_init_fd(flatcc_mmap_emitter_t *E, int fd, size_t size_hint)
+{
+    memset(E, 0, sizeof(*E));
+    E->fd = fd;
+    if (init(E, size_hint)) {
+        flatcc_mmap_emitter_clear(E);
+        return -1;
+    }
+    return 0;
+}
+
+int flatcc_mmap_emitter_reset(flatcc_mmap_emitter_t *E)
+{
+    if (E->fd < 0) {
+        return -1;
+    }
+    if (E->is_finalized) {
+        /* The file was truncated, so restore the previous capacity. */
+        unmap_file(E);
+        if (map_file(E, E->reserved)) {
+            return -1;
+        }
+    }
+    set_zero(E);
+    return 0;
+}
+
+void flatcc_mmap_emitter_clear(flatcc_mmap_emitter_t *E)
+{
+    unmap_file(E);
+    if (E->owns_fd && E->fd >= 0) {
+        close(E->fd);
+    }
+    memset(E, 0, sizeof(*E));
+    E->fd = -1;
+}
+
+int flatcc_mmap_emitter_finalize(flatcc_mmap_emitter_t *E, size_t *size_out)
+{
+    size_t size = E->front_used + E->back_used;
+
+    if (size_out) {
+        *size_out = 0;
+    }
+    if (!E->map || E->is_finalized) {
+        return -1;
+    }
+    if (E->zero != E->front_used) {
+        memmove(E->map, E->map + E->zero - E->front_used, size);
+    }
+    /* Unmap before truncating since the mapping would extend beyond the file end. */
+    E->reserved = E->capacity;
+    unmap_file(E);
+    E->capacity = 0;
+    E->zero = E->front_used;
+    E->is_finalized = 1;
+    if (ftruncate(E->fd, (off_t)size)) {
+        return -1;
+    }
+    if (size) {
+        if (map_file(E, size)) {
+            return -1;
+        }
+    }
+    if (size_out) {
+        *size_out = size;
+    }
+    return 0;
+}
+
+int flatcc_mmap_emitter(void *emit_context,
+        const flatcc_iovec_t *iov, int iov_count,
+        flatbuffers_soffset_t offset, size_t len)
+{
+    flatcc_mmap_emitter_t *E = emit_context;
+    uint8_t *p;
+
+    if (!E->map || E->is_finalized) {
+        return -1;
+    }
+    if (offset < 0) {
+        if (len > E->zero - E->front_used && grow(E, len, 0)) {
+            return -1;
+        }
+        E->front_used += len;
+        p = E->map + E->zero - E->front_used;
+    } else {
+        if (len > E->capacity - E->zero - E->back_used && grow(E, 0, len)) {
+            return -1;
+        }
+        p = E->map + E->zero + E->back_used;
+        E->back_used += len;
+    }
+    while (iov_count--) {
+        memcpy(p, iov->iov_base, iov->iov_len);
+        p += iov->iov_len;
+        ++iov;
+    }
+    return 0;
+}
+
+#else /* FLATCC_HAS_MMAP */
+
+int flatcc_mmap_emitter_open(flatcc_mmap_emitter_t *E, const char *path, size_t size_hint)
+{
+    (void)path;
+    (void)size_hint;
+    memset(E, 0, sizeof(*E));
+    E->fd = -1;
+    return -1;
+}
+
+int flatcc_mmap_emitter_init_fd(flatcc_mmap_emitter_t *E, int fd, size_t size_hint)
+{
+    (void)fd;
+    (void)size_hint;
+    memset(E, 0, sizeof(*E));
+    E->fd = -1;
+    return -1;
+}
+
+int flatcc_mmap_emitter_reset(flatcc_mmap_emitter_t *E)
+{
+    (void)E;
+    return -1;
+}
+
+void flatcc_mmap_emitter_clear(flatcc_mmap_emitter_t *E)
+{
+    memset(E, 0, sizeof(*E));
+    E->fd = -1;
+}
+
+int flatcc_mmap_emitter_finalize(flatcc_mmap_emitter_t *E, size_t *size_out)
+{
+    (void)E;
+    if (size_out) {
+        *size_out = 0;
+    }
+    return -1;
+}
+
+int flatcc_mmap_emitter(void *emit_context,
+        const flatcc_iovec_t *iov, int iov_count,
+        flatbuffers_soffset_t offset, size_t len)
+{
+    (void)emit_context;
+    (void)iov;
+    (void)iov_count;
+    (void)offset;
+    (void)len;
+    return -1;
+}
+
+#endif /* FLATCC_HAS_MMAP */
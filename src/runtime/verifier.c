@@ -4,12 +4,20 @@
  * Depends mutually on generated verifier functions for table types that
  * call into this library.
  */
+/* For clock_gettime when statistics are enabled. */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
 #include <string.h>
 
 #include "flatcc/flatcc_rtconfig.h"
+#if FLATCC_VERIFIER_STATS
+#include <time.h>
+#endif
 #include "flatcc/flatcc_flatbuffers.h"
 #include "flatcc/flatcc_verifier.h"
 #include "flatcc/flatcc_identifier.h"
+#include "flatcc/flatcc_alloc.h"
 
 /* Customization for testing. */
 #if FLATCC_DEBUG_VERIFY
@@ -28,6 +36,16 @@
 #define trace_verify(s, p) ((void)0)
 #endif
 
+#if FLATCC_USE_SSE4_2
+#if defined(__AVX2__)
+#define USE_AVX2
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#define USE_SSE4_2
+#include <nmmintrin.h>
+#endif
+#endif
+
 /* The runtime library does not use the global config file. */
 
 /* This is a guideline, not an exact measure. */
@@ -97,12 +115,114 @@ const char *flatcc_verify_error_string(int err)
  */
 #define verify_runtime(cond, reason) verify(cond, reason)
 
-#define check_result(x) if (x) { return (x); }
+/* `x` is evaluated once, otherwise failures are verified again. */
+#define check_result(x) do { int ret_ = (x); if (ret_) { return ret_; }} while (0)
 
 #define check_field(td, id, required, base) do {                            \
     int ret = get_offset_field(td, id, required, &base);                    \
     if (ret || !base) { return ret; }} while (0)
 
+/* Kinds of objects recorded in a verifier memo. */
+enum {
+    memo_table,
+    memo_table_vector,
+    memo_string_vector,
+    memo_union_vector
+};
+
+typedef void memo_fn_t(void);
+
+/*
+ * Returns from the calling verifier if the object was already verified
+ * with the same verifier function or type, otherwise records it.
+ */
+#define check_memo(memo, kind, buf, end, offset, aux, fn, type) do {        \
+    int ret;                                                                \
+    if (memo) {                                                             \
+        ret = memo_visit(memo, kind, (const uint8_t *)(buf) + (offset),     \
+            (const uint8_t *)(buf) + (end), aux, (memo_fn_t *)(fn), type);  \
+        if (ret < 0) { return flatcc_verify_error_runtime_memo_allocation_failed; } \
+        if (ret > 0) { return flatcc_verify_ok; }                           \
+    }} while (0)
+
+static inline size_t memo_hash(const void *obj)
+{
+    size_t h = (size_t)obj;
+
+    /* Objects are at least 4 byte aligned, and often close together. */
+    h ^= h >> 17;
+    h *= (size_t)0x9e3779b1u;
+    return h ^ (h >> 15);
+}
+
+static int memo_grow(flatcc_verifier_memo_t *memo)
+{
+    flatcc_verifier_memo_entry_t *entries, *e;
+    size_t i, k, n = memo->capacity ? 2 * memo->capacity : 64;
+
+    if (n < memo->capacity || !(entries = FLATCC_CALLOC(n, sizeof(entries[0])))) {
+        return -1;
+    }
+    for (k = 0; k < memo->capacity; ++k) {
+        e = memo->entries + k;
+        if (!e->obj) {
+            continue;
+        }
+        i = memo_hash(e->obj) & (n - 1);
+        while (entries[i].obj) {
+            i = (i + 1) & (n - 1);
+        }
+        entries[i] = *e;
+    }
+    FLATCC_FREE(memo->entries);
+    memo->entries = entries;
+    memo->capacity = n;
+    return 0;
+}
+
+/* Returns 1 if already recorded, 0 if recorded now, and -1 on failure. */
+static int memo_visit(flatcc_verifier_memo_t *memo, int kind,
+        const void *obj, const void *end, const void *aux, memo_fn_t *fn, const void *type)
+{
+    flatcc_verifier_memo_entry_t *e;
+    size_t i;
+
+    /* Keep the load factor at or below 0.5 for short probes. */
+    if (2 * (memo->count + 1) > memo->capacity && memo_grow(memo)) {
+        return -1;
+    }
+    i = memo_hash(obj) & (memo->capacity - 1);
+    while ((e = memo->entries + i)->obj) {
+        if (e->obj == obj && e->kind == kind && e->fn == fn && e->type == type
+                && e->end == end && e->aux == aux) {
+            return 1;
+        }
+        i = (i + 1) & (memo->capacity - 1);
+    }
+    e->obj = obj;
+    e->end = end;
+    e->aux = aux;
+    e->fn = fn;
+    e->type = type;
+    e->kind = kind;
+    ++memo->count;
+    return 0;
+}
+
+static void memo_reset(flatcc_verifier_memo_t *memo)
+{
+    if (memo->count) {
+        memset(memo->entries, 0, memo->capacity * sizeof(memo->entries[0]));
+        memo->count = 0;
+    }
+}
+
+void flatcc_verifier_memo_clear(flatcc_verifier_memo_t *memo)
+{
+    FLATCC_FREE(memo->entries);
+    flatcc_verifier_memo_init(memo);
+}
+
 static inline uoffset_t read_uoffset(const void *p, uoffset_t base)
 {
     return __flatbuffers_uoffset_read_from_pe((uint8_t *)p + base);
@@ -127,7 +247,7 @@ static inline int check_header(uoffset_t end, uoffset_t base, uoffset_t offset)
 {
     uoffset_t k = base + offset;
 
-    if (uoffset_size <= voffset_size && k + offset_size < k) {
+    if (k + offset_size < k) {
         return 0;
     }
 
@@ -139,7 +259,7 @@ static inline int check_aligned_header(uoffset_t end, uoffset_t base, uoffset_t
 {
     uoffset_t k = base + offset;
 
-    if (uoffset_size <= voffset_size && k + offset_size < k) {
+    if (k + offset_size < k) {
         return 0;
     }
     /* Alignment refers to element 0 and header must also be aligned. */
@@ -257,6 +377,79 @@ static int get_offset_field(flatcc_table_verifier_descriptor_t *td, voffset_t id
     return flatcc_verify_ok;
 }
 
+/* Skips bytes below 0x80 in blocks, and stops before the block with the first other byte. */
+static inline const uint8_t *skip_ascii(const uint8_t *p, const uint8_t *end)
+{
+    uint64_t w;
+
+#if defined(USE_AVX2)
+    while (end - p >= 32 && !_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)p))) {
+        p += 32;
+    }
+#elif defined(USE_SSE4_2)
+    while (end - p >= 16 && !_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)p))) {
+        p += 16;
+    }
+#endif
+    while (end - p >= 8) {
+        memcpy(&w, p, 8);
+        if (w & UINT64_C(0x8080808080808080)) {
+            break;
+        }
+        p += 8;
+    }
+    return p;
+}
+
+int flatcc_verify_utf8(const void *s, size_t len)
+{
+    const uint8_t *p = s, *end = p + len;
+    uint8_t c;
+
+    while ((p = skip_ascii(p, end)) < end) {
+        c = *p;
+        if (c < 0x80) {
+            ++p;
+            continue;
+        }
+        /* Continuation bytes cannot lead, and 0xc0, 0xc1 are always overlong. */
+        if (c < 0xc2) {
+            return 0;
+        }
+        if (c < 0xe0) {
+            if (end - p < 2 || (p[1] & 0xc0) != 0x80) {
+                return 0;
+            }
+            p += 2;
+            continue;
+        }
+        if (c < 0xf0) {
+            if (end - p < 3 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80) {
+                return 0;
+            }
+            /* Overlong, or UTF-16 surrogate. */
+            if ((c == 0xe0 && p[1] < 0xa0) || (c == 0xed && p[1] >= 0xa0)) {
+                return 0;
+            }
+            p += 3;
+            continue;
+        }
+        if (c < 0xf5) {
+            if (end - p < 4 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80 || (p[3] & 0xc0) != 0x80) {
+                return 0;
+            }
+            /* Overlong, or above U+10FFFF. */
+            if ((c == 0xf0 && p[1] < 0x90) || (c == 0xf4 && p[1] >= 0x90)) {
+                return 0;
+            }
+            p += 4;
+            continue;
+        }
+        return 0;
+    }
+    return 1;
+}
+
 static inline int verify_string(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset)
 {
     uoffset_t n;
@@ -267,9 +460,55 @@ static inline int verify_string(const void *buf, uoffset_t end, uoffset_t base,
     base += offset_size;
     verify(end - base > n, flatcc_verify_error_string_out_of_range);
     verify(((uint8_t *)buf + base)[n] == 0, flatcc_verify_error_string_not_zero_terminated);
+#if FLATCC_VERIFIER_UTF8
+    verify(flatcc_verify_utf8((uint8_t *)buf + base, n), flatcc_verify_error_string_not_utf8);
+#endif
     return flatcc_verify_ok;
 }
 
+#ifndef FLATCC_VERIFIER_STRING_RUN
+#define FLATCC_VERIFIER_STRING_RUN 16
+#endif
+
+/*
+ * Checks a run of at most `FLATCC_VERIFIER_STRING_RUN` strings in a
+ * vector with one branch per check instead of one per string, so the
+ * loops can be vectorized. Returns 0 if any string in the run is
+ * invalid, and the caller then finds the first invalid string with
+ * `verify_string` to report the same error as a string by string check.
+ */
+static inline int check_string_run(const void *buf, uoffset_t end, uoffset_t base, uoffset_t count)
+{
+    uoffset_t k[FLATCC_VERIFIER_STRING_RUN], n[FLATCC_VERIFIER_STRING_RUN];
+    uoffset_t i;
+    int ok = 1;
+
+    for (i = 0; i < count; ++i, base += offset_size) {
+        k[i] = base + read_uoffset(buf, base);
+        ok &= (k[i] > base) & (k[i] + offset_size > k[i]) & (k[i] + offset_size <= end) & !(k[i] & (offset_size - 1));
+    }
+    if (!ok) {
+        return 0;
+    }
+    for (i = 0; i < count; ++i) {
+        n[i] = read_uoffset(buf, k[i]);
+        k[i] += offset_size;
+        ok &= end - k[i] > n[i];
+    }
+    if (!ok) {
+        return 0;
+    }
+    for (i = 0; i < count; ++i) {
+        ok &= ((uint8_t *)buf)[k[i] + n[i]] == 0;
+    }
+#if FLATCC_VERIFIER_UTF8
+    for (i = 0; ok && i < count; ++i) {
+        ok = flatcc_verify_utf8((uint8_t *)buf + k[i], n[i]);
+    }
+#endif
+    return ok;
+}
+
 /*
  * Keep interface somwewhat similar ot flatcc_builder_start_vector.
  * `max_count` is a precomputed division to manage overflow check on vector length.
@@ -288,67 +527,191 @@ static inline int verify_vector(const void *buf, uoffset_t end, uoffset_t base,
     return flatcc_verify_ok;
 }
 
-static inline int verify_string_vector(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset)
+/*
+ * Statistics for the recursive verifier. Objects are counted once
+ * verified, and `vec` is the offset of a vector length field.
+ */
+#if FLATCC_VERIFIER_STATS
+
+static void stat_vector(flatcc_verifier_stats_t *stats, const void *buf, uoffset_t vec, size_t elem_size)
 {
-    uoffset_t i, n;
+    if (stats) {
+        ++stats->vectors;
+        stats->bytes += offset_size + (size_t)read_uoffset(buf, vec) * elem_size;
+    }
+}
+
+/* Counts `count` strings referenced from consecutive offsets at `base`. */
+static void stat_strings(flatcc_verifier_stats_t *stats, const void *buf, uoffset_t base, uoffset_t count)
+{
+    for (; stats && count > 0; --count, base += offset_size) {
+        ++stats->strings;
+        /* Length field, string, and zero terminator. */
+        stats->bytes += offset_size + (size_t)read_uoffset(buf, base + read_uoffset(buf, base)) + 1;
+    }
+}
+
+static void stat_vtable(flatcc_verifier_stats_t *stats, voffset_t vsize)
+{
+    if (stats) {
+        ++stats->vtables;
+        stats->bytes += vsize;
+    }
+}
+
+static void stat_table(flatcc_verifier_stats_t *stats, voffset_t tsize, int ttl)
+{
+    if (stats) {
+        ++stats->tables;
+        stats->bytes += tsize;
+        if (stats->max_depth < FLATCC_VERIFIER_MAX_LEVELS - ttl) {
+            stats->max_depth = FLATCC_VERIFIER_MAX_LEVELS - ttl;
+        }
+    }
+}
+
+static void stat_bytes(flatcc_verifier_stats_t *stats, size_t size)
+{
+    if (stats) {
+        stats->bytes += size;
+    }
+}
+
+#else
+
+#define stat_vector(stats, buf, vec, elem_size) ((void)(stats))
+#define stat_strings(stats, buf, base, count) ((void)(stats))
+#define stat_vtable(stats, vsize) ((void)(stats))
+#define stat_table(stats, tsize, ttl) ((void)(stats))
+#define stat_bytes(stats, size) ((void)(stats))
+
+#endif
+
+static inline int verify_string_vector(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset,
+        flatcc_verifier_memo_t *memo, flatcc_verifier_stats_t *stats)
+{
+    uoffset_t i, k, n, run;
 
     check_result(verify_vector(buf, end, base, offset, offset_size, offset_size, FLATBUFFERS_COUNT_MAX(offset_size)));
+    check_memo(memo, memo_string_vector, buf, end, base + offset, 0, 0, 0);
     base += offset;
     n = read_uoffset(buf, base);
+    stat_vector(stats, buf, base, offset_size);
     base += offset_size;
-    for (i = 0; i < n; ++i, base += offset_size) {
-        check_result(verify_string(buf, end, base, read_uoffset(buf, base)));
+    for (i = 0; i < n; i += run, base += run * offset_size) {
+        run = n - i < FLATCC_VERIFIER_STRING_RUN ? n - i : FLATCC_VERIFIER_STRING_RUN;
+        if (check_string_run(buf, end, base, run)) {
+            stat_strings(stats, buf, base, run);
+            continue;
+        }
+        for (k = 0; k < run; ++k) {
+            check_result(verify_string(buf, end, base + k * offset_size, read_uoffset(buf, base + k * offset_size)));
+            stat_strings(stats, buf, base + k * offset_size, 1);
+        }
     }
     return flatcc_verify_ok;
 }
 
-static inline int verify_table(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset,
-        int ttl, flatcc_table_verifier_f tvf)
+/* Verifies the table and vtable headers and fills in `td` except `ttl`. */
+static inline int verify_table_header(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset,
+        flatcc_table_verifier_descriptor_t *td, flatcc_verifier_memo_t *memo, flatcc_verifier_stats_t *stats)
 {
     uoffset_t vbase, vend;
-    flatcc_table_verifier_descriptor_t td;
 
-    verify((td.ttl = ttl - 1), flatcc_verify_error_max_nesting_level_reached);
     verify(check_header(end, base, offset), flatcc_verify_error_table_header_out_of_range_or_unaligned);
-    td.table = base + offset;
+    td->table = base + offset;
     /* Read vtable offset - it is signed, but we want it unsigned, assuming 2's complement works. */
-    vbase = td.table - read_uoffset(buf, td.table);
+    vbase = td->table - read_uoffset(buf, td->table);
     verify((soffset_t)vbase >= 0 && !(vbase & (voffset_size - 1)), flatcc_verify_error_vtable_offset_out_of_range_or_unaligned);
     verify(vbase + voffset_size <= end, flatcc_verify_error_vtable_header_out_of_range);
     /* Read vtable size. */
-    td.vsize = read_voffset(buf, vbase);
-    vend = vbase + td.vsize;
-    verify(vend <= end && !(td.vsize & (voffset_size - 1)), flatcc_verify_error_vtable_size_out_of_range_or_unaligned);
+    td->vsize = read_voffset(buf, vbase);
+    vend = vbase + td->vsize;
+    verify(vend <= end && !(td->vsize & (voffset_size - 1)), flatcc_verify_error_vtable_size_out_of_range_or_unaligned);
     /* Optimizes away overflow check if uoffset_t is large enough. */
     verify(uoffset_size > voffset_size || vend >= vbase, flatcc_verify_error_vtable_size_overflow);
 
-    verify(td.vsize >= 2 * voffset_size, flatcc_verify_error_vtable_header_too_small);
+    verify(td->vsize >= 2 * voffset_size, flatcc_verify_error_vtable_header_too_small);
     /* Read table size. */
-    td.tsize = read_voffset(buf, vbase + voffset_size);
-    verify(end - td.table >= td.tsize, flatcc_verify_error_table_size_out_of_range);
-    td.vtable = (uint8_t *)buf + vbase;
-    td.buf = buf;
-    td.end = end;
+    td->tsize = read_voffset(buf, vbase + voffset_size);
+    verify(end - td->table >= td->tsize, flatcc_verify_error_table_size_out_of_range);
+    td->vtable = (uint8_t *)buf + vbase;
+    td->buf = buf;
+    td->end = end;
+    td->memo = memo;
+    td->stats = stats;
+    td->index = 0;
+    td->index_end = 0;
+    stat_vtable(stats, td->vsize);
+    return flatcc_verify_ok;
+}
+
+static inline int verify_table(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset,
+        int ttl, flatcc_table_verifier_f tvf, flatcc_verifier_memo_t *memo, flatcc_verifier_stats_t *stats)
+{
+    flatcc_table_verifier_descriptor_t td;
+
+    /* A vector may have used the last level, so `ttl` can be 0 here. */
+    verify((td.ttl = ttl - 1) > 0, flatcc_verify_error_max_nesting_level_reached);
+    check_result(verify_table_header(buf, end, base, offset, &td, memo, stats));
+    check_memo(memo, memo_table, buf, end, td.table, 0, tvf, 0);
+    stat_table(stats, td.tsize, td.ttl);
     return tvf(&td);
 }
 
-static inline int verify_table_vector(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset, int ttl, flatcc_table_verifier_f tvf)
+/* Verifies a table and records it in `ix` on success. */
+static int verify_indexed_table(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset,
+        int ttl, flatcc_table_verifier_f tvf, flatcc_table_index_t *ix, flatcc_table_index_t *ix_end)
+{
+    flatcc_table_verifier_descriptor_t td;
+    voffset_t id;
+
+    verify((td.ttl = ttl - 1) > 0, flatcc_verify_error_max_nesting_level_reached);
+    check_result(verify_table_header(buf, end, base, offset, &td, 0, 0));
+    td.index = ix;
+    td.index_end = ix_end;
+    check_result(tvf(&td));
+    ix->table = (const uint8_t *)buf + td.table;
+    for (id = 0; id < ix->field_count; ++id) {
+        ix->fields[id] = read_vt_entry(&td, id);
+    }
+    return flatcc_verify_ok;
+}
+
+/* Returns the index entry of the table in field `id` of the current table, if any. */
+static inline flatcc_table_index_t *index_child(flatcc_table_verifier_descriptor_t *td, voffset_t id)
+{
+    flatcc_table_index_t *ix;
+
+    for (ix = td->index + 1; ix < td->index_end; ++ix) {
+        if (ix->parent == td->index && ix->id == id) {
+            return ix;
+        }
+    }
+    return 0;
+}
+
+static inline int verify_table_vector(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset,
+        int ttl, flatcc_table_verifier_f tvf, flatcc_verifier_memo_t *memo, flatcc_verifier_stats_t *stats)
 {
     uoffset_t i, n;
 
     verify(ttl-- > 0, flatcc_verify_error_max_nesting_level_reached);
     check_result(verify_vector(buf, end, base, offset, offset_size, offset_size, FLATBUFFERS_COUNT_MAX(offset_size)));
+    check_memo(memo, memo_table_vector, buf, end, base + offset, 0, tvf, 0);
     base += offset;
     n = read_uoffset(buf, base);
+    stat_vector(stats, buf, base, offset_size);
     base += offset_size;
     for (i = 0; i < n; ++i, base += offset_size) {
-        check_result(verify_table(buf, end, base, read_uoffset(buf, base), ttl, tvf));
+        check_result(verify_table(buf, end, base, read_uoffset(buf, base), ttl, tvf, memo, stats));
     }
     return flatcc_verify_ok;
 }
 
 static inline int verify_union_vector(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset,
-        uoffset_t count, const utype_t *types, int ttl, flatcc_union_verifier_f uvf)
+        uoffset_t count, const utype_t *types, int ttl, flatcc_union_verifier_f uvf,
+        flatcc_verifier_memo_t *memo, flatcc_verifier_stats_t *stats)
 {
     uoffset_t i, n, elem;
     flatcc_union_verifier_descriptor_t ud;
@@ -358,11 +721,16 @@ static inline int verify_union_vector(const void *buf, uoffset_t end, uoffset_t
     base += offset;
     n = read_uoffset(buf, base);
     verify(n == count, flatcc_verify_error_union_vector_length_mismatch);
+    /* The types are part of the key since they decide how elements are verified. */
+    check_memo(memo, memo_union_vector, buf, end, base, types, uvf, 0);
+    stat_vector(stats, buf, base, offset_size);
     base += offset_size;
 
     ud.buf = buf;
     ud.end = end;
     ud.ttl = ttl;
+    ud.memo = memo;
+    ud.stats = stats;
 
     for (i = 0; i < n; ++i, base += offset_size) {
         /* Table vectors can never be null, but unions can when the type is NONE. */
@@ -393,7 +761,9 @@ int flatcc_verify_string_field(flatcc_table_verifier_descriptor_t *td,
     uoffset_t base;
 
     check_field(td, id, required, base);
-    return verify_string(td->buf, td->end, base, read_uoffset(td->buf, base));
+    check_result(verify_string(td->buf, td->end, base, read_uoffset(td->buf, base)));
+    stat_strings(td->stats, td->buf, base, 1);
+    return flatcc_verify_ok;
 }
 
 int flatcc_verify_vector_field(flatcc_table_verifier_descriptor_t *td,
@@ -402,8 +772,10 @@ int flatcc_verify_vector_field(flatcc_table_verifier_descriptor_t *td,
     uoffset_t base;
 
     check_field(td, id, required, base);
-    return verify_vector(td->buf, td->end, base, read_uoffset(td->buf, base),
-        (uoffset_t)elem_size, align, (uoffset_t)max_count);
+    check_result(verify_vector(td->buf, td->end, base, read_uoffset(td->buf, base),
+        (uoffset_t)elem_size, align, (uoffset_t)max_count));
+    stat_vector(td->stats, td->buf, base + read_uoffset(td->buf, base), elem_size);
+    return flatcc_verify_ok;
 }
 
 int flatcc_verify_string_vector_field(flatcc_table_verifier_descriptor_t *td,
@@ -412,16 +784,21 @@ int flatcc_verify_string_vector_field(flatcc_table_verifier_descriptor_t *td,
     uoffset_t base;
 
     check_field(td, id, required, base);
-    return verify_string_vector(td->buf, td->end, base, read_uoffset(td->buf, base));
+    return verify_string_vector(td->buf, td->end, base, read_uoffset(td->buf, base), td->memo, td->stats);
 }
 
 int flatcc_verify_table_field(flatcc_table_verifier_descriptor_t *td,
     voffset_t id, int required, flatcc_table_verifier_f tvf)
 {
     uoffset_t base;
+    flatcc_table_index_t *ix;
 
     check_field(td, id, required, base);
-    return verify_table(td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, tvf);
+    if (td->index && 0 != (ix = index_child(td, id))) {
+        return verify_indexed_table(td->buf, td->end, base, read_uoffset(td->buf, base),
+                td->ttl, tvf, ix, td->index_end);
+    }
+    return verify_table(td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, tvf, td->memo, td->stats);
 }
 
 int flatcc_verify_table_vector_field(flatcc_table_verifier_descriptor_t *td,
@@ -430,22 +807,26 @@ int flatcc_verify_table_vector_field(flatcc_table_verifier_descriptor_t *td,
     uoffset_t base;
 
     check_field(td, id, required, base);
-    return verify_table_vector(td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, tvf);
+    return verify_table_vector(td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, tvf, td->memo, td->stats);
 }
 
 int flatcc_verify_union_table(flatcc_union_verifier_descriptor_t *ud, flatcc_table_verifier_f *tvf)
 {
-    return verify_table(ud->buf, ud->end, ud->base, ud->offset, ud->ttl, tvf);
+    return verify_table(ud->buf, ud->end, ud->base, ud->offset, ud->ttl, tvf, ud->memo, ud->stats);
 }
 
 int flatcc_verify_union_struct(flatcc_union_verifier_descriptor_t *ud, size_t size, uint16_t align)
 {
-    return verify_struct(ud->end, ud->base, ud->offset, (uoffset_t)size, align);
+    check_result(verify_struct(ud->end, ud->base, ud->offset, (uoffset_t)size, align));
+    stat_bytes(ud->stats, size);
+    return flatcc_verify_ok;
 }
 
 int flatcc_verify_union_string(flatcc_union_verifier_descriptor_t *ud)
 {
-    return verify_string(ud->buf, ud->end, ud->base, ud->offset);
+    check_result(verify_string(ud->buf, ud->end, ud->base, ud->offset));
+    stat_strings(ud->stats, ud->buf, ud->base, 1);
+    return flatcc_verify_ok;
 }
 
 int flatcc_verify_buffer_header(const void *buf, size_t bufsiz, const char *fid)
@@ -486,7 +867,8 @@ int flatcc_verify_buffer_header_with_size(const void *buf, size_t *bufsiz, const
     verify_runtime(size_field <= *bufsiz - offset_size, flatcc_verify_error_runtime_buffer_size_less_than_size_field);
     if (fid != 0) {
         id2 = read_thash_identifier(fid);
-        id = read_thash(buf, offset_size);
+        /* The identifier follows the size field and the root offset. */
+        id = read_thash(buf, 2 * offset_size);
         verify(id2 == 0 || id == id2, flatcc_verify_error_identifier_mismatch);
     }
     *bufsiz = size_field + offset_size;
@@ -531,7 +913,7 @@ int flatcc_verify_typed_buffer_header_with_size(const void *buf, size_t *bufsiz,
     verify_runtime(size_field <= *bufsiz - offset_size, flatcc_verify_error_runtime_buffer_size_less_than_size_field);
     if (thash != 0) {
         id2 = thash;
-        id = read_thash(buf, offset_size);
+        id = read_thash(buf, 2 * offset_size);
         verify(id2 == 0 || id == id2, flatcc_verify_error_identifier_mismatch);
     }
     *bufsiz = size_field + offset_size;
@@ -565,25 +947,130 @@ int flatcc_verify_struct_as_typed_root_with_size(const void *buf, size_t bufsiz,
 int flatcc_verify_table_as_root(const void *buf, size_t bufsiz, const char *fid, flatcc_table_verifier_f *tvf)
 {
     check_result(flatcc_verify_buffer_header(buf, bufsiz, fid));
-    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf);
+    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, 0);
 }
 
 int flatcc_verify_table_as_root_with_size(const void *buf, size_t bufsiz, const char *fid, flatcc_table_verifier_f *tvf)
 {
     check_result(flatcc_verify_buffer_header_with_size(buf, &bufsiz, fid));
-    return verify_table(buf, (uoffset_t)bufsiz, uoffset_size, read_uoffset(buf, uoffset_size), FLATCC_VERIFIER_MAX_LEVELS, tvf);
+    return verify_table(buf, (uoffset_t)bufsiz, uoffset_size, read_uoffset(buf, uoffset_size), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, 0);
 }
 
 int flatcc_verify_table_as_typed_root(const void *buf, size_t bufsiz, flatbuffers_thash_t thash, flatcc_table_verifier_f *tvf)
 {
     check_result(flatcc_verify_typed_buffer_header(buf, bufsiz, thash));
-    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf);
+    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, 0);
 }
 
 int flatcc_verify_table_as_typed_root_with_size(const void *buf, size_t bufsiz, flatbuffers_thash_t thash, flatcc_table_verifier_f *tvf)
 {
     check_result(flatcc_verify_typed_buffer_header_with_size(buf, &bufsiz, thash));
-    return verify_table(buf, (uoffset_t)bufsiz, uoffset_size, read_uoffset(buf, uoffset_size), FLATCC_VERIFIER_MAX_LEVELS, tvf);
+    return verify_table(buf, (uoffset_t)bufsiz, uoffset_size, read_uoffset(buf, uoffset_size), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, 0);
+}
+
+int flatcc_verify_table_as_root_with_memo(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, flatcc_verifier_memo_t *memo)
+{
+    check_result(flatcc_verify_buffer_header(buf, bufsiz, fid));
+    memo_reset(memo);
+    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf, memo, 0);
+}
+
+int flatcc_verify_table_as_root_with_size_and_memo(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, flatcc_verifier_memo_t *memo)
+{
+    check_result(flatcc_verify_buffer_header_with_size(buf, &bufsiz, fid));
+    memo_reset(memo);
+    return verify_table(buf, (uoffset_t)bufsiz, uoffset_size, read_uoffset(buf, uoffset_size), FLATCC_VERIFIER_MAX_LEVELS, tvf, memo, 0);
+}
+
+#if FLATCC_VERIFIER_STATS
+/*
+ * Wall clock seconds from an arbitrary start. `clock` is the last resort
+ * because it measures processor time of the whole process, which includes
+ * other threads.
+ */
+static double stats_time(void)
+{
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+        return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+    }
+#elif defined(TIME_UTC)
+    struct timespec ts;
+
+    if (timespec_get(&ts, TIME_UTC) == TIME_UTC) {
+        return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+    }
+#endif
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+#endif
+
+static int verify_with_stats(const void *buf, uoffset_t end, uoffset_t base,
+        flatcc_table_verifier_f *tvf, flatcc_verifier_stats_t *stats)
+{
+#if FLATCC_VERIFIER_STATS
+    double t = stats_time();
+    int ret;
+
+    ret = verify_table(buf, end, base, read_uoffset(buf, base), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, stats);
+    stats->seconds = stats_time() - t;
+    return ret;
+#else
+    (void)stats;
+    return verify_table(buf, end, base, read_uoffset(buf, base), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, 0);
+#endif
+}
+
+int flatcc_verify_table_as_root_with_stats(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, flatcc_verifier_stats_t *stats)
+{
+    flatcc_verifier_stats_init(stats);
+    check_result(flatcc_verify_buffer_header(buf, bufsiz, fid));
+    return verify_with_stats(buf, (uoffset_t)bufsiz, 0, tvf, stats);
+}
+
+int flatcc_verify_table_as_root_with_size_and_stats(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, flatcc_verifier_stats_t *stats)
+{
+    flatcc_verifier_stats_init(stats);
+    check_result(flatcc_verify_buffer_header_with_size(buf, &bufsiz, fid));
+    return verify_with_stats(buf, (uoffset_t)bufsiz, uoffset_size, tvf, stats);
+}
+
+static int verify_with_index(const void *buf, uoffset_t end, uoffset_t base,
+        flatcc_table_verifier_f *tvf, flatcc_table_index_t *index, size_t count)
+{
+    size_t i;
+
+    if (count == 0) {
+        return verify_table(buf, end, base, read_uoffset(buf, base), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, 0);
+    }
+    for (i = 0; i < count; ++i) {
+        index[i].table = 0;
+        if (index[i].field_count) {
+            memset(index[i].fields, 0, index[i].field_count * sizeof(voffset_t));
+        }
+    }
+    return verify_indexed_table(buf, end, base, read_uoffset(buf, base), FLATCC_VERIFIER_MAX_LEVELS,
+            tvf, index, index + count);
+}
+
+int flatcc_verify_table_as_root_with_index(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, flatcc_table_index_t *index, size_t count)
+{
+    check_result(flatcc_verify_buffer_header(buf, bufsiz, fid));
+    return verify_with_index(buf, (uoffset_t)bufsiz, 0, tvf, index, count);
+}
+
+int flatcc_verify_table_as_root_with_size_and_index(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, flatcc_table_index_t *index, size_t count)
+{
+    check_result(flatcc_verify_buffer_header_with_size(buf, &bufsiz, fid));
+    return verify_with_index(buf, (uoffset_t)bufsiz, uoffset_size, tvf, index, count);
 }
 
 int flatcc_verify_struct_as_nested_root(flatcc_table_verifier_descriptor_t *td,
@@ -621,7 +1108,7 @@ int flatcc_verify_table_as_nested_root(flatcc_table_verifier_descriptor_t *td,
      * might not be what is desired anyway. User can do it later.
      */
     check_result(flatcc_verify_buffer_header(buf, bufsiz, fid));
-    return verify_table(buf, bufsiz, 0, read_uoffset(buf, 0), td->ttl, tvf);
+    return verify_table(buf, bufsiz, 0, read_uoffset(buf, 0), td->ttl, tvf, td->memo, td->stats);
 }
 
 int flatcc_verify_union_field(flatcc_table_verifier_descriptor_t *td,
@@ -652,6 +1139,8 @@ int flatcc_verify_union_field(flatcc_table_verifier_descriptor_t *td,
     ud.buf = td->buf;
     ud.end = td->end;
     ud.ttl = td->ttl;
+    ud.memo = td->memo;
+    ud.stats = td->stats;
     ud.base = base;
     ud.offset = read_uoffset(td->buf, base);
     ud.type = *type;
@@ -683,5 +1172,560 @@ int flatcc_verify_union_vector_field(flatcc_table_verifier_descriptor_t *td,
 
     check_field(td, id, required, base);
     return verify_union_vector(td->buf, td->end, base, read_uoffset(td->buf, base),
-            count, types, td->ttl, uvf);
+            count, types, td->ttl, uvf, td->memo, td->stats);
+}
+
+/*
+ * Iterative verifier.
+ *
+ * Each work item is a run of offset slots in a table field or vector
+ * together with the type of the objects they reference. Tables are
+ * verified as slots are taken from the top item, and their table,
+ * table vector, and union fields push new items rather than recursing.
+ */
+
+#ifndef FLATCC_VERIFIER_STACK_INIT_SIZE
+#define FLATCC_VERIFIER_STACK_INIT_SIZE 32
+#endif
+
+/* Vectors longer than this are split into chunks of this many elements. */
+#ifndef FLATCC_VERIFIER_PARALLEL_CHUNK_SIZE
+#define FLATCC_VERIFIER_PARALLEL_CHUNK_SIZE 4096
+#endif
+
+typedef struct verifier_item verifier_item_t;
+
+struct verifier_item {
+    const void *buf;
+    uoffset_t end;
+    /* Next offset slot and number of slots left. */
+    uoffset_t base;
+    uoffset_t count;
+    /* Table items only. Items that are neither table nor union are strings. */
+    const flatcc_verifier_table_type_t *table_type;
+    /* Union items only, with the type of the next slot. */
+    const flatcc_verifier_union_type_t *union_type;
+    const utype_t *types;
+    int is_vector;
+};
+
+/* Large vectors set aside for parallel verification. */
+typedef struct verifier_deferred {
+    verifier_item_t *items;
+    size_t count;
+    size_t capacity;
+    size_t chunk_count;
+} verifier_deferred_t;
+
+typedef struct verifier_stack {
+    verifier_item_t *items;
+    size_t count;
+    size_t capacity;
+    flatcc_verifier_memo_t *memo;
+    verifier_deferred_t *deferred;
+    /* Lazy verification only checks the table itself, see `verify_lazy`. */
+    int shallow;
+    verifier_item_t init[FLATCC_VERIFIER_STACK_INIT_SIZE];
+} verifier_stack_t;
+
+static void init_stack(verifier_stack_t *S, flatcc_verifier_memo_t *memo, verifier_deferred_t *deferred)
+{
+    S->items = S->init;
+    S->count = 0;
+    S->capacity = FLATCC_VERIFIER_STACK_INIT_SIZE;
+    S->memo = memo;
+    S->deferred = deferred;
+    S->shallow = 0;
+}
+
+static void clear_stack(verifier_stack_t *S)
+{
+    if (S->items != S->init) {
+        FLATCC_FREE(S->items);
+    }
+}
+
+static void init_item(verifier_item_t *item, const void *buf, uoffset_t end,
+        uoffset_t base, uoffset_t count)
+{
+    item->buf = buf;
+    item->end = end;
+    item->base = base;
+    item->count = count;
+    item->table_type = 0;
+    item->union_type = 0;
+    item->types = 0;
+    item->is_vector = 0;
+}
+
+static verifier_item_t *push_item(verifier_stack_t *S, const void *buf, uoffset_t end,
+        uoffset_t base, uoffset_t count)
+{
+    verifier_item_t *items, *item;
+    size_t n = 2 * S->capacity;
+
+    if (S->count == S->capacity) {
+        if (S->items == S->init) {
+            if ((items = FLATCC_ALLOC(n * sizeof(items[0])))) {
+                memcpy(items, S->init, sizeof(S->init));
+            }
+        } else {
+            items = FLATCC_REALLOC(S->items, n * sizeof(items[0]));
+        }
+        if (!items) {
+            return 0;
+        }
+        S->items = items;
+        S->capacity = n;
+    }
+    item = S->items + S->count++;
+    init_item(item, buf, end, base, count);
+    return item;
+}
+
+#define get_table_type(x) ((x)->table_type ? (x)->table_type() : (x)->table_type_ptr)
+#define get_union_type(x) ((x)->union_type ? (x)->union_type() : (x)->union_type_ptr)
+
+/* Pushes the elements of a vector, or defers them if the vector is large. */
+static verifier_item_t *push_vector(verifier_stack_t *S, const void *buf, uoffset_t end,
+        uoffset_t base, uoffset_t count)
+{
+    verifier_deferred_t *D = S->deferred;
+    verifier_item_t *items, *item;
+    size_t n;
+
+    if (!D || count <= FLATCC_VERIFIER_PARALLEL_CHUNK_SIZE) {
+        return push_item(S, buf, end, base, count);
+    }
+    if (D->count == D->capacity) {
+        n = D->capacity ? 2 * D->capacity : 16;
+        if (!(items = FLATCC_REALLOC(D->items, n * sizeof(items[0])))) {
+            return 0;
+        }
+        D->items = items;
+        D->capacity = n;
+    }
+    D->chunk_count += (count + FLATCC_VERIFIER_PARALLEL_CHUNK_SIZE - 1) / FLATCC_VERIFIER_PARALLEL_CHUNK_SIZE;
+    item = D->items + D->count++;
+    init_item(item, buf, end, base, count);
+    return item;
+}
+
+/* Like `check_memo`, but skips to the next field. */
+#define skip_memo(memo, kind, buf, end, offset, aux, type)                  \
+    if (memo) {                                                             \
+        ret = memo_visit(memo, kind, (const uint8_t *)(buf) + (offset),     \
+            (const uint8_t *)(buf) + (end), aux, 0, type);                  \
+        if (ret < 0) { return flatcc_verify_error_runtime_memo_allocation_failed; } \
+        if (ret > 0) { continue; }                                          \
+    }
+
+#define check_push(item) \
+    if (!(item)) { return flatcc_verify_error_runtime_stack_allocation_failed; }
+
+static int verify_table_fields(verifier_stack_t *S, const void *buf, uoffset_t end,
+        uoffset_t base, uoffset_t offset, const flatcc_verifier_table_type_t *type,
+        flatcc_verifier_memo_t *memo)
+{
+    flatcc_table_verifier_descriptor_t td;
+    const flatcc_verifier_field_t *f, *f_end;
+    verifier_item_t *item;
+    const uint8_t *p;
+    const utype_t *types = 0;
+    voffset_t vte_type;
+    uoffset_t k, n, count = 0;
+    int ret;
+
+    check_result(verify_table_header(buf, end, base, offset, &td, memo, 0));
+    /* Not used, there is no nesting limit. */
+    td.ttl = FLATCC_VERIFIER_MAX_LEVELS;
+    check_memo(memo, memo_table, buf, end, td.table, 0, 0, type);
+    for (f = type->fields, f_end = f + type->field_count; f != f_end; ++f) {
+        switch (f->op) {
+        case flatcc_verifier_op_field:
+            check_result(verify_field(&td, f->id, 0, f->size, f->align));
+            continue;
+        case flatcc_verifier_op_nested_struct:
+            check_result(flatcc_verify_struct_as_nested_root(&td, f->id, f->required, 0, f->size, f->align));
+            continue;
+        case flatcc_verifier_op_nested_table:
+            check_result(flatcc_verify_vector_field(&td, f->id, f->required, f->align, 1, FLATBUFFERS_COUNT_MAX(1)));
+            if (0 == (p = get_field_ptr(&td, f->id))) {
+                continue;
+            }
+            p += read_uoffset(p, 0);
+            n = read_uoffset(p, 0);
+            p += offset_size;
+            check_result(flatcc_verify_buffer_header(p, n, 0));
+            check_push(item = push_item(S, p, n, 0, 1));
+            item->table_type = get_table_type(f);
+            continue;
+        case flatcc_verifier_op_union:
+            if (0 == (vte_type = read_vt_entry(&td, f->id - 1))) {
+                verify(read_vt_entry(&td, f->id) == 0, flatcc_verify_error_union_cannot_have_a_table_without_a_type);
+                verify(!f->required, flatcc_verify_error_type_field_absent_from_required_union_field);
+                continue;
+            }
+            check_result(verify_field(&td, f->id - 1, 0, 1, 1));
+            types = (const utype_t *)((const uint8_t *)buf + td.table + vte_type);
+            verify(*types || read_vt_entry(&td, f->id) == 0, flatcc_verify_error_union_type_NONE_cannot_have_a_value);
+            if (*types == 0) {
+                continue;
+            }
+            check_result(get_offset_field(&td, f->id, f->required, &k));
+            if (k) {
+                check_push(item = push_item(S, buf, end, k, 1));
+                item->union_type = get_union_type(f);
+                item->types = types;
+            }
+            continue;
+        case flatcc_verifier_op_union_vector:
+            if (0 == read_vt_entry(&td, f->id - 1) && 0 == read_vt_entry(&td, f->id)) {
+                verify(!f->required, flatcc_verify_error_type_field_absent_from_required_union_vector_field);
+            }
+            check_result(flatcc_verify_vector_field(&td, f->id - 1, f->required,
+                        utype_size, utype_size, FLATBUFFERS_COUNT_MAX(utype_size)));
+            if (0 == (p = get_field_ptr(&td, f->id - 1))) {
+                continue;
+            }
+            p += read_uoffset(p, 0);
+            count = read_uoffset(p, 0);
+            types = (const utype_t *)(p + offset_size);
+            break;
+        default:
+            break;
+        }
+        /* The remaining fields are offsets. */
+        check_result(get_offset_field(&td, f->id, f->required, &k));
+        if (!k) {
+            continue;
+        }
+        offset = read_uoffset(buf, k);
+        switch (f->op) {
+        case flatcc_verifier_op_string:
+            check_result(verify_string(buf, end, k, offset));
+            break;
+        case flatcc_verifier_op_vector:
+            check_result(verify_vector(buf, end, k, offset, f->size, f->align, f->max_count));
+            break;
+        case flatcc_verifier_op_string_vector:
+            if (!S->deferred && !S->shallow) {
+                check_result(verify_string_vector(buf, end, k, offset, memo, 0));
+                break;
+            }
+            check_result(verify_vector(buf, end, k, offset, offset_size, offset_size, FLATBUFFERS_COUNT_MAX(offset_size)));
+            k += offset;
+            if ((n = read_uoffset(buf, k))) {
+                check_push(push_vector(S, buf, end, k + offset_size, n));
+            }
+            break;
+        case flatcc_verifier_op_table:
+            check_push(item = push_item(S, buf, end, k, 1));
+            item->table_type = get_table_type(f);
+            break;
+        case flatcc_verifier_op_table_vector:
+            check_result(verify_vector(buf, end, k, offset, offset_size, offset_size, FLATBUFFERS_COUNT_MAX(offset_size)));
+            k += offset;
+            skip_memo(memo, memo_table_vector, buf, end, k, 0, get_table_type(f));
+            if ((n = read_uoffset(buf, k))) {
+                check_push(item = push_vector(S, buf, end, k + offset_size, n));
+                item->table_type = get_table_type(f);
+            }
+            break;
+        case flatcc_verifier_op_union_vector:
+            check_result(verify_vector(buf, end, k, offset, offset_size, offset_size, FLATBUFFERS_COUNT_MAX(offset_size)));
+            k += offset;
+            n = read_uoffset(buf, k);
+            verify(n == count, flatcc_verify_error_union_vector_length_mismatch);
+            skip_memo(memo, memo_union_vector, buf, end, k, types, get_union_type(f));
+            if (n) {
+                check_push(item = push_vector(S, buf, end, k + offset_size, n));
+                item->union_type = get_union_type(f);
+                item->types = types;
+                item->is_vector = 1;
+            }
+            break;
+        default:
+            return flatcc_verify_error_not_supported;
+        }
+    }
+    return flatcc_verify_ok;
+}
+
+/* Verifies the object referenced by the next slot of the top item. */
+static int verify_next_slot(verifier_stack_t *S)
+{
+    verifier_item_t *item = S->items + S->count - 1;
+    const flatcc_verifier_union_member_t *member = 0;
+    const flatcc_verifier_table_type_t *type = item->table_type;
+    const flatcc_verifier_union_type_t *union_type = item->union_type;
+    const void *buf = item->buf;
+    uoffset_t end = item->end, base = item->base, offset;
+    utype_t utype = 0;
+    int is_vector = item->is_vector;
+
+    if (union_type) {
+        utype = *item->types++;
+        member = utype < union_type->member_count ? union_type->members + utype : 0;
+    }
+    item->base += offset_size;
+    if (--item->count == 0) {
+        --S->count;
+    }
+    offset = read_uoffset(buf, base);
+    if (!type && !union_type) {
+        return verify_string(buf, end, base, offset);
+    }
+    if (!type) {
+        if (is_vector) {
+            /* Table vectors can never be null, but unions can when the type is NONE. */
+            if (offset == 0) {
+                verify(utype == 0, flatcc_verify_error_union_element_absent_without_type_NONE);
+                return flatcc_verify_ok;
+            }
+            verify(utype != 0, flatcc_verify_error_union_element_present_with_type_NONE);
+        }
+        /* Unknown types are accepted for forward compatibility. */
+        if (!member) {
+            return flatcc_verify_ok;
+        }
+        switch (member->op) {
+        case flatcc_verifier_op_table:
+            type = get_table_type(member);
+            break;
+        case flatcc_verifier_op_struct:
+            return verify_struct(end, base, offset, member->size, member->align);
+        case flatcc_verifier_op_string:
+            return verify_string(buf, end, base, offset);
+        default:
+            return flatcc_verify_ok;
+        }
+    }
+    return verify_table_fields(S, buf, end, base, offset, type, S->memo);
+}
+
+static int run_stack(verifier_stack_t *S)
+{
+    int ret = flatcc_verify_ok;
+
+    while (!ret && S->count) {
+        ret = verify_next_slot(S);
+    }
+    return ret;
+}
+
+static int verify_iterative(const void *buf, uoffset_t end, uoffset_t base,
+        const flatcc_verifier_table_type_t *type, flatcc_verifier_memo_t *memo)
+{
+    verifier_stack_t S;
+    int ret;
+
+    init_stack(&S, memo, 0);
+    if (memo) {
+        memo_reset(memo);
+    }
+    ret = verify_table_fields(&S, buf, end, base, read_uoffset(buf, base), type, memo);
+    if (!ret) {
+        ret = run_stack(&S);
+    }
+    clear_stack(&S);
+    return ret;
+}
+
+int flatcc_verify_table_as_root_iterative(const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verifier_table_type_t *type, flatcc_verifier_memo_t *memo)
+{
+    check_result(flatcc_verify_buffer_header(buf, bufsiz, fid));
+    return verify_iterative(buf, (uoffset_t)bufsiz, 0, type, memo);
+}
+
+int flatcc_verify_table_as_root_with_size_iterative(const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verifier_table_type_t *type, flatcc_verifier_memo_t *memo)
+{
+    check_result(flatcc_verify_buffer_header_with_size(buf, &bufsiz, fid));
+    return verify_iterative(buf, (uoffset_t)bufsiz, uoffset_size, type, memo);
+}
+
+typedef struct verifier_chunk {
+    verifier_item_t item;
+    int ret;
+} verifier_chunk_t;
+
+static void verify_chunk(void *arg, size_t index)
+{
+    verifier_chunk_t *chunk = (verifier_chunk_t *)arg + index;
+    verifier_stack_t S;
+
+    init_stack(&S, 0, 0);
+    S.items[0] = chunk->item;
+    S.count = 1;
+    chunk->ret = run_stack(&S);
+    clear_stack(&S);
+}
+
+static int verify_parallel(const void *buf, uoffset_t end, uoffset_t base,
+        const flatcc_verifier_table_type_t *type,
+        flatcc_verifier_parallel_for_f *parallel_for, void *pool)
+{
+    verifier_stack_t S;
+    verifier_deferred_t D;
+    verifier_chunk_t *chunks = 0, *chunk;
+    verifier_item_t *item;
+    uoffset_t start;
+    size_t i, k;
+    int ret;
+
+    memset(&D, 0, sizeof(D));
+    init_stack(&S, 0, &D);
+    ret = verify_table_fields(&S, buf, end, base, read_uoffset(buf, base), type, 0);
+    if (!ret) {
+        ret = run_stack(&S);
+    }
+    clear_stack(&S);
+    if (ret || D.count == 0) {
+        goto done;
+    }
+    if (!(chunks = FLATCC_ALLOC(D.chunk_count * sizeof(chunks[0])))) {
+        ret = flatcc_verify_error_runtime_stack_allocation_failed;
+        goto done;
+    }
+    for (i = 0, chunk = chunks; i < D.count; ++i) {
+        item = D.items + i;
+        for (start = 0; start < item->count; start += FLATCC_VERIFIER_PARALLEL_CHUNK_SIZE, ++chunk) {
+            chunk->item = *item;
+            chunk->item.base += start * offset_size;
+            chunk->item.count = item->count - start;
+            if (chunk->item.count > FLATCC_VERIFIER_PARALLEL_CHUNK_SIZE) {
+                chunk->item.count = FLATCC_VERIFIER_PARALLEL_CHUNK_SIZE;
+            }
+            if (item->types) {
+                chunk->item.types += start;
+            }
+            chunk->ret = flatcc_verify_ok;
+        }
+    }
+    if (parallel_for) {
+        parallel_for(pool, verify_chunk, chunks, D.chunk_count);
+    } else {
+        for (k = 0; k < D.chunk_count; ++k) {
+            verify_chunk(chunks, k);
+        }
+    }
+    /* The first failing chunk, regardless of which finished first. */
+    for (k = 0; k < D.chunk_count && !ret; ++k) {
+        ret = chunks[k].ret;
+    }
+done:
+    FLATCC_FREE(chunks);
+    FLATCC_FREE(D.items);
+    return ret;
+}
+
+int flatcc_verify_table_as_root_parallel(const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verifier_table_type_t *type,
+        flatcc_verifier_parallel_for_f *parallel_for, void *pool)
+{
+    check_result(flatcc_verify_buffer_header(buf, bufsiz, fid));
+    return verify_parallel(buf, (uoffset_t)bufsiz, 0, type, parallel_for, pool);
+}
+
+int flatcc_verify_table_as_root_with_size_parallel(const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verifier_table_type_t *type,
+        flatcc_verifier_parallel_for_f *parallel_for, void *pool)
+{
+    check_result(flatcc_verify_buffer_header_with_size(buf, &bufsiz, fid));
+    return verify_parallel(buf, (uoffset_t)bufsiz, uoffset_size, type, parallel_for, pool);
+}
+
+/*
+ * Verifies a table without the objects it references: those are pushed
+ * as usual, but the stack is then discarded.
+ */
+static int verify_lazy(flatcc_lazy_verifier_t *L, uoffset_t base, uoffset_t offset,
+        const flatcc_verifier_table_type_t *type)
+{
+    verifier_stack_t S;
+
+    init_stack(&S, 0, 0);
+    S.shallow = 1;
+    L->error = verify_table_fields(&S, L->buf, L->end, base, offset, type, 0);
+    clear_stack(&S);
+    return L->error;
+}
+
+/* Position of `p` in the buffer, or 0 which is never a valid object position. */
+static uoffset_t lazy_position(flatcc_lazy_verifier_t *L, const void *p)
+{
+    uintptr_t b = (uintptr_t)L->buf, q = (uintptr_t)p;
+
+    return q > b && q - b < L->end ? (uoffset_t)(q - b) : 0;
+}
+
+static int lazy_verify_as_root(flatcc_lazy_verifier_t *L, const void *buf, uoffset_t end, uoffset_t base,
+        const flatcc_verifier_table_type_t *type)
+{
+    L->buf = buf;
+    L->end = end;
+    memo_reset(&L->memo);
+    return verify_lazy(L, base, read_uoffset(buf, base), type);
+}
+
+int flatcc_lazy_verify_as_root(flatcc_lazy_verifier_t *L, const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verifier_table_type_t *type)
+{
+    if ((L->error = flatcc_verify_buffer_header(buf, bufsiz, fid))) {
+        return L->error;
+    }
+    return lazy_verify_as_root(L, buf, (uoffset_t)bufsiz, 0, type);
+}
+
+int flatcc_lazy_verify_as_root_with_size(flatcc_lazy_verifier_t *L, const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verifier_table_type_t *type)
+{
+    if ((L->error = flatcc_verify_buffer_header_with_size(buf, &bufsiz, fid))) {
+        return L->error;
+    }
+    return lazy_verify_as_root(L, buf, (uoffset_t)bufsiz, uoffset_size, type);
+}
+
+int flatcc_lazy_verify_table(flatcc_lazy_verifier_t *L, const void *table,
+        const flatcc_verifier_table_type_t *type)
+{
+    uoffset_t k;
+
+    if (L->error || !table) {
+        return L->error;
+    }
+    if (!(k = lazy_position(L, table))) {
+        return L->error = flatcc_verify_error_table_header_out_of_range_or_unaligned;
+    }
+    switch (memo_visit(&L->memo, memo_table, table, 0, 0, 0, type)) {
+    case 0:
+        return verify_lazy(L, 0, k, type);
+    case 1:
+        return flatcc_verify_ok;
+    default:
+        return L->error = flatcc_verify_error_runtime_memo_allocation_failed;
+    }
+}
+
+int flatcc_lazy_verify_string(flatcc_lazy_verifier_t *L, const char *s)
+{
+    uoffset_t k;
+
+    if (L->error || !s) {
+        return L->error;
+    }
+    if ((k = lazy_position(L, s)) <= offset_size) {
+        return L->error = flatcc_verify_error_string_header_out_of_range_or_unaligned;
+    }
+    return L->error = verify_string(L->buf, L->end, 0, k - offset_size);
+}
+
+int flatcc_lazy_verify_struct(flatcc_lazy_verifier_t *L, const void *p, size_t size, uint16_t align)
+{
+    if (L->error || !p) {
+        return L->error;
+    }
+    return L->error = verify_struct(L->end, 0, lazy_position(L, p), (uoffset_t)size, align);
 }
@@ -0,0 +1,168 @@
+/*
+ * Verification of back-to-back size prefixed buffers, see
+ * `flatcc_verifier_stream_t` in `flatcc/flatcc_verifier.h`.
+ */
+#include <string.h>
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_flatbuffers.h"
+#include "flatcc/flatcc_verifier.h"
+#include "flatcc/flatcc_alloc.h"
+
+#define uoffset_t flatbuffers_uoffset_t
+#define offset_size sizeof(uoffset_t)
+
+/* Buffers are framed in batches so results need not be kept for a whole range. */
+#ifndef FLATCC_VERIFIER_STREAM_BATCH_SIZE
+#define FLATCC_VERIFIER_STREAM_BATCH_SIZE 1024
+#endif
+
+typedef struct stream_frame {
+    /* Offset of the size field, and size including the size field. */
+    size_t offset;
+    size_t size;
+    int error;
+} stream_frame_t;
+
+typedef struct stream_batch {
+    flatcc_verifier_stream_t *S;
+    const uint8_t *buf;
+    stream_frame_t *frames;
+} stream_batch_t;
+
+/* The size field need not be aligned, so it is copied. */
+static inline size_t read_size_field(const uint8_t *p)
+{
+    uoffset_t size;
+
+    memcpy(&size, p, offset_size);
+    return (size_t)__flatbuffers_uoffset_cast_from_pe(size);
+}
+
+static void verify_frame(void *arg, size_t index)
+{
+    stream_batch_t *batch = arg;
+    stream_frame_t *frame = batch->frames + index;
+
+    frame->error = flatcc_verify_table_as_root_with_size(batch->buf + frame->offset,
+            frame->size, batch->S->fid, batch->S->tvf);
+}
+
+/* Ensures room for `need` elements. */
+static int reserve(void **p, size_t *capacity, size_t need, size_t elem_size)
+{
+    void *q;
+    size_t n = *capacity ? *capacity : 64;
+
+    if (need <= *capacity) {
+        return 0;
+    }
+    while (n < need) {
+        n *= 2;
+    }
+    if (n > (size_t)-1 / elem_size || !(q = FLATCC_REALLOC(*p, n * elem_size))) {
+        return -1;
+    }
+    *p = q;
+    *capacity = n;
+    return 0;
+}
+
+/* Ensures room for `n` more results of either kind. */
+static int reserve_results(flatcc_verifier_stream_t *S, size_t n)
+{
+    if (reserve((void **)&S->records, &S->record_capacity, S->record_count + n, sizeof(S->records[0])) ||
+            reserve((void **)&S->errors, &S->error_capacity, S->error_count + n, sizeof(S->errors[0]))) {
+        return -1;
+    }
+    return 0;
+}
+
+static void add_result(flatcc_verifier_stream_t *S, size_t offset, int error)
+{
+    if (error) {
+        S->errors[S->error_count].offset = offset;
+        S->errors[S->error_count].error = error;
+        ++S->error_count;
+    } else {
+        S->records[S->record_count++] = offset;
+    }
+}
+
+void flatcc_verifier_stream_clear(flatcc_verifier_stream_t *S)
+{
+    FLATCC_FREE(S->records);
+    FLATCC_FREE(S->errors);
+    S->offset = 0;
+    S->records = 0;
+    S->record_count = 0;
+    S->errors = 0;
+    S->error_count = 0;
+    S->record_capacity = 0;
+    S->error_capacity = 0;
+}
+
+int flatcc_verify_stream_chunk(flatcc_verifier_stream_t *S,
+        const void *buf, size_t bufsiz, size_t *consumed)
+{
+    stream_frame_t frames[FLATCC_VERIFIER_STREAM_BATCH_SIZE];
+    stream_batch_t batch;
+    size_t i, n, size, pos = 0;
+
+    batch.S = S;
+    batch.buf = buf;
+    batch.frames = frames;
+    *consumed = 0;
+    for (;;) {
+        /* Frames a batch from the size fields only. */
+        for (n = 0; n < FLATCC_VERIFIER_STREAM_BATCH_SIZE && bufsiz - pos >= offset_size; ++n) {
+            size = read_size_field(batch.buf + pos);
+            if (size > bufsiz - pos - offset_size) {
+                break;
+            }
+            frames[n].offset = pos;
+            frames[n].size = size + offset_size;
+            pos += frames[n].size;
+        }
+        if (n == 0) {
+            return flatcc_verify_ok;
+        }
+        if (reserve_results(S, n)) {
+            return flatcc_verify_error_runtime_stream_allocation_failed;
+        }
+        if (S->parallel_for && n > 1) {
+            S->parallel_for(S->pool, verify_frame, &batch, n);
+        } else {
+            for (i = 0; i < n; ++i) {
+                verify_frame(&batch, i);
+            }
+        }
+        for (i = 0; i < n; ++i) {
+            add_result(S, S->offset + frames[i].offset - *consumed, frames[i].error);
+        }
+        /* Only complete batches are consumed, so a failed call can be repeated from `consumed`. */
+        S->offset += pos - *consumed;
+        *consumed = pos;
+    }
+}
+
+int flatcc_verify_stream(flatcc_verifier_stream_t *S, const void *buf, size_t bufsiz)
+{
+    size_t consumed;
+    int ret;
+
+    if ((ret = flatcc_verify_stream_chunk(S, buf, bufsiz, &consumed))) {
+        return ret;
+    }
+    if (consumed == bufsiz) {
+        return flatcc_verify_ok;
+    }
+    ret = bufsiz - consumed < offset_size ? flatcc_verify_error_buffer_header_too_small
+            : flatcc_verify_error_runtime_buffer_size_less_than_size_field;
+    if (reserve_results(S, 1)) {
+        return flatcc_verify_error_runtime_stream_allocation_failed;
+    }
+    add_result(S, S->offset, ret);
+    S->offset += bufsiz - consumed;
+    return flatcc_verify_ok;
+}
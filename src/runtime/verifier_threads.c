@@ -0,0 +1,161 @@
+/*
+ * Posix threads are not visible with -std=c11 unless requested
+ * explicitly.
+ */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_verifier.h"
+
+#ifndef FLATCC_VERIFIER_MAX_THREADS
+#define FLATCC_VERIFIER_MAX_THREADS 64
+#endif
+
+#if FLATCC_USE_THREADS
+
+#if defined(_WIN32)
+
+#include <windows.h>
+
+typedef SRWLOCK task_lock_t;
+typedef HANDLE task_thread_t;
+
+static inline int init_lock(task_lock_t *lock) { InitializeSRWLock(lock); return 0; }
+static inline void destroy_lock(task_lock_t *lock) { (void)lock; }
+static inline void lock(task_lock_t *lock) { AcquireSRWLockExclusive(lock); }
+static inline void unlock(task_lock_t *lock) { ReleaseSRWLockExclusive(lock); }
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_mutex_t task_lock_t;
+typedef pthread_t task_thread_t;
+
+static inline int init_lock(task_lock_t *lock) { return pthread_mutex_init(lock, 0) ? -1 : 0; }
+static inline void destroy_lock(task_lock_t *lock) { pthread_mutex_destroy(lock); }
+static inline void lock(task_lock_t *lock) { pthread_mutex_lock(lock); }
+static inline void unlock(task_lock_t *lock) { pthread_mutex_unlock(lock); }
+
+#endif
+
+typedef struct task_queue {
+    task_lock_t lock;
+    flatcc_verifier_task_f *task;
+    void *arg;
+    size_t next;
+    size_t count;
+} task_queue_t;
+
+/* Takes the next index until all are taken. */
+static void run_tasks(task_queue_t *Q)
+{
+    size_t index;
+
+    for (;;) {
+        lock(&Q->lock);
+        index = Q->next < Q->count ? Q->next++ : Q->count;
+        unlock(&Q->lock);
+        if (index == Q->count) {
+            return;
+        }
+        Q->task(Q->arg, index);
+    }
+}
+
+#if defined(_WIN32)
+
+static DWORD WINAPI thread_main(LPVOID arg)
+{
+    run_tasks(arg);
+    return 0;
+}
+
+static inline int start_thread(task_thread_t *t, task_queue_t *Q)
+{
+    return (*t = CreateThread(0, 0, thread_main, Q, 0, 0)) ? 0 : -1;
+}
+
+static inline void join_thread(task_thread_t t)
+{
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
+
+#else
+
+static void *thread_main(void *arg)
+{
+    run_tasks(arg);
+    return 0;
+}
+
+static inline int start_thread(task_thread_t *t, task_queue_t *Q)
+{
+    return pthread_create(t, 0, thread_main, Q) ? -1 : 0;
+}
+
+static inline void join_thread(task_thread_t t)
+{
+    pthread_join(t, 0);
+}
+
+#endif
+
+void flatcc_verifier_parallel_for_threads(void *pool,
+        flatcc_verifier_task_f *task, void *arg, size_t count)
+{
+    flatcc_verifier_threads_t *T = pool;
+    task_thread_t threads[FLATCC_VERIFIER_MAX_THREADS];
+    task_queue_t Q;
+    size_t i, n = T && T->thread_count > 1 ? (size_t)T->thread_count - 1 : 0;
+
+    if (n > FLATCC_VERIFIER_MAX_THREADS) {
+        n = FLATCC_VERIFIER_MAX_THREADS;
+    }
+    if (count && n > count - 1) {
+        n = count - 1;
+    }
+    Q.task = task;
+    Q.arg = arg;
+    Q.next = 0;
+    Q.count = count;
+    if (n == 0 || init_lock(&Q.lock)) {
+        goto serial;
+    }
+    /* Threads that fail to start leave more work for the others. */
+    for (i = 0; i < n; ++i) {
+        if (start_thread(&threads[i], &Q)) {
+            break;
+        }
+    }
+    n = i;
+    run_tasks(&Q);
+    for (i = 0; i < n; ++i) {
+        join_thread(threads[i]);
+    }
+    destroy_lock(&Q.lock);
+    return;
+
+serial:
+    for (i = 0; i < count; ++i) {
+        task(arg, i);
+    }
+}
+
+#else /* FLATCC_USE_THREADS */
+
+void flatcc_verifier_parallel_for_threads(void *pool,
+        flatcc_verifier_task_f *task, void *arg, size_t count)
+{
+    size_t i;
+
+    (void)pool;
+    for (i = 0; i < count; ++i) {
+        task(arg, i);
+    }
+}
+
+#endif /* FLATCC_USE_THREADS */
@@ -0,0 +1,116 @@
+/*
+ * Shared vtable dictionary, see `flatcc/flatcc_vtable_dict.h`.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_flatbuffers.h"
+#include "flatcc/flatcc_vtable_dict.h"
+#include "flatcc/flatcc_alloc.h"
+
+#define voffset_t flatbuffers_voffset_t
+#define write_voffset __flatbuffers_voffset_write_to_pe
+
+/* Ensures room for `need` more bytes in `data`, or another entry. */
+static int reserve(void **p, size_t *size, size_t used, size_t need)
+{
+    void *q;
+    size_t n = *size ? *size : 64;
+
+    if (used + need <= *size) {
+        return 0;
+    }
+    while (n < used + need) {
+        n *= 2;
+    }
+    if (!(q = FLATCC_REALLOC(*p, n))) {
+        return -1;
+    }
+    *p = q;
+    *size = n;
+    return 0;
+}
+
+void flatcc_vtable_dict_clear(flatcc_vtable_dict_t *D)
+{
+    FLATCC_FREE(D->entries);
+    FLATCC_FREE(D->data);
+    FLATCC_FREE(D->slots);
+    flatcc_vtable_dict_init(D);
+}
+
+int flatcc_vtable_dict_add(flatcc_vtable_dict_t *D,
+        const voffset_t *vt, voffset_t vt_size, uint32_t vt_hash)
+{
+    flatcc_vtable_dict_entry_t *e;
+    voffset_t *vt_pe;
+    size_t i, n = vt_size;
+
+    if (D->slots || vt_size < 2 * sizeof(voffset_t) || vt_size % sizeof(voffset_t) || vt[0] != vt_size) {
+        return -1;
+    }
+    /* Indices are stored as uint32 + 1 in slots. */
+    if (D->count >= UINT32_MAX / 2) {
+        return -1;
+    }
+    if (!flatbuffers_is_native_pe()) {
+        n *= 2;
+    }
+    if (reserve((void **)&D->data, &D->data_size, D->data_len, n)) {
+        return -1;
+    }
+    n = sizeof(*e);
+    if (reserve((void **)&D->entries, &D->entries_size, D->count * n, n)) {
+        return -1;
+    }
+    e = D->entries + D->count++;
+    e->hash = vt_hash;
+    e->size = vt_size;
+    e->vt = D->data_len;
+    memcpy(D->data + D->data_len, vt, vt_size);
+    D->data_len += vt_size;
+    if (flatbuffers_is_native_pe()) {
+        e->vt_pe = e->vt;
+    } else {
+        e->vt_pe = D->data_len;
+        vt_pe = (voffset_t *)(D->data + D->data_len);
+        for (i = 0; i < vt_size / sizeof(voffset_t); ++i) {
+            write_voffset(&vt_pe[i], vt[i]);
+        }
+        D->data_len += vt_size;
+    }
+    return 0;
+}
+
+int flatcc_vtable_dict_freeze(flatcc_vtable_dict_t *D)
+{
+    flatcc_vtable_dict_entry_t *e;
+    size_t i, k, n = 8;
+
+    if (D->slots) {
+        return 0;
+    }
+    /* Keep the load factor at or below 0.5 for short probes. */
+    while (n < 2 * D->count) {
+        n *= 2;
+    }
+    if (!(D->slots = FLATCC_CALLOC(n, sizeof(D->slots[0])))) {
+        return -1;
+    }
+    D->slot_mask = n - 1;
+    for (k = 0; k < D->count; ++k) {
+        e = D->entries + k;
+        if (flatcc_vtable_dict_find(D, (const voffset_t *)(D->data + e->vt), e->size, e->hash) >= 0) {
+            /* Duplicate, never found by lookup. */
+            continue;
+        }
+        i = (size_t)(e->hash ^ (e->hash >> 16)) & D->slot_mask;
+        while (D->slots[i]) {
+            i = (i + 1) & D->slot_mask;
+        }
+        D->slots[i] = (uint32_t)(k + 1);
+    }
+    return 0;
+}
@@ -14,3 +14,5 @@ echo "building and benchmarking flatcc generated C"
 benchflatcc/run.sh
 echo "building and benchmarking flatcc json generated C"
 benchflatccjson/run.sh
+echo "building and benchmarking flatcc verifiers"
+benchverify/run.sh
@@ -0,0 +1,272 @@
+/*
+ * Verifier throughput on valid and adversarial buffers of several
+ * sizes, reported in MB/s and tables/s. Table counts are the number of
+ * tables each verifier visits, so a shared table counts once per
+ * reference unless a memo is used.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flatbench_builder.h"
+#include "flatbench_verifier.h"
+#include "monster_test_builder.h"
+#include "monster_test_verifier.h"
+#include "flatcc/support/elapsed.h"
+
+#ifdef NDEBUG
+#define COMPILE_TYPE "(optimized)"
+#else
+#define COMPILE_TYPE "(debug)"
+#endif
+
+#undef ns
+#define ns(x) FLATBUFFERS_WRAP_NAMESPACE(MyGame_Example, x)
+#define C(x) FLATBUFFERS_WRAP_NAMESPACE(benchfb_FooBarContainer, x)
+#define FooBar(x) FLATBUFFERS_WRAP_NAMESPACE(benchfb_FooBar, x)
+#define Enum(x) FLATBUFFERS_WRAP_NAMESPACE(benchfb_Enum, x)
+
+/* Each case is repeated for at least this long. */
+#ifndef BENCH_SECONDS
+#define BENCH_SECONDS 0.25
+#endif
+
+typedef int verify_f(const void *buf, size_t size);
+
+static flatcc_verifier_memo_t memo;
+static flatcc_verifier_threads_t threads = { 4 };
+
+static int verify_flatbench(const void *buf, size_t size)
+{
+    return C(verify_as_root(buf, size));
+}
+
+static int verify_recursive(const void *buf, size_t size)
+{
+    return ns(Monster_verify_as_root(buf, size));
+}
+
+static int verify_memo(const void *buf, size_t size)
+{
+    return ns(Monster_verify_as_root_with_memo(buf, size, &memo));
+}
+
+static int verify_iterative(const void *buf, size_t size)
+{
+    return ns(Monster_verify_as_root_iterative(buf, size));
+}
+
+static int verify_parallel(const void *buf, size_t size)
+{
+    return ns(Monster_verify_as_root_parallel(buf, size, flatcc_verifier_parallel_for_threads, &threads));
+}
+
+/* Returns -1 if the result is not `expect`, where 0 expects a valid buffer. */
+static int bench(const char *name, verify_f *verify, const void *buf, size_t size,
+        double tables, int expect)
+{
+    double t1, t2;
+    long i, batch = 1, rep = 0;
+    int ret;
+
+    if ((ret = verify(buf, size)) != expect) {
+        printf("%s: expected %s, got: %s\n", name,
+                flatcc_verify_error_string(expect), flatcc_verify_error_string(ret));
+        return -1;
+    }
+    t1 = elapsed_realtime();
+    do {
+        for (i = 0; i < batch; ++i) {
+            ret |= verify(buf, size);
+        }
+        rep += batch;
+        batch *= 2;
+        t2 = elapsed_realtime();
+    } while (t2 - t1 < BENCH_SECONDS);
+    printf("%-44s %10lu bytes %10.1f MB/s %14.0f tables/s\n", name, (unsigned long)size,
+            (double)rep * (double)size / 1e6 / (t2 - t1), (double)rep * tables / (t2 - t1));
+    return ret == expect ? 0 : -1;
+}
+
+static void *finalize(flatcc_builder_t *B, size_t *size)
+{
+    return flatcc_builder_finalize_aligned_buffer(B, size);
+}
+
+/* A container with `n` FooBar tables as in the flatbench benchmark. */
+static void *build_flatbench(flatcc_builder_t *B, int n, size_t *size)
+{
+    int i;
+
+    flatcc_builder_reset(B);
+    C(start_as_root(B));
+    C(list_start(B));
+    for (i = 0; i < n; ++i) {
+        C(list_push_start(B));
+        FooBar(sibling_create(B, 0xABADCAFEABADCAFE + (uint64_t)i, (int16_t)(10000 + i), (int8_t)('@' + i),
+                (uint32_t)(1000000 + i), 123456 + i, 3.14159f + (float)i, (uint16_t)(10000 + i)));
+        FooBar(name_create_str(B, "Hello, World!"));
+        FooBar(rating_add(B, 3.1415432432445543543 + i));
+        FooBar(postfix_add(B, (uint8_t)('!' + i)));
+        C(list_push_end(B));
+    }
+    C(list_end(B));
+    C(location_create_str(B, "https://www.example.com/myurl/"));
+    C(fruit_add(B, Enum(Bananas)));
+    C(initialized_add(B, 1));
+    C(end_as_root(B));
+    return finalize(B, size);
+}
+
+/* A monster with `n` distinct named monsters in a vector. */
+static void *build_vector(flatcc_builder_t *B, int n, size_t *size)
+{
+    int i;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "root"));
+    ns(Monster_testarrayoftables_start(B));
+    for (i = 0; i < n; ++i) {
+        ns(Monster_testarrayoftables_push_start(B));
+        ns(Monster_name_create_str(B, "monster"));
+        ns(Monster_hp_add(B, (int16_t)i));
+        ns(Monster_testarrayoftables_push_end(B));
+    }
+    ns(Monster_testarrayoftables_end(B));
+    ns(Monster_end_as_root(B));
+    return finalize(B, size);
+}
+
+/*
+ * A chain of `depth` monsters linked by their enemy field. When
+ * `shared`, each monster also lists the next in its table vector, so
+ * every monster is reached twice from the one above.
+ */
+static void *build_chain(flatcc_builder_t *B, int depth, int shared, size_t *size)
+{
+    flatbuffers_string_ref_t name;
+    ns(Monster_ref_t) next = 0;
+    int i;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    name = flatbuffers_string_create_str(B, "monster");
+    for (i = 1; i < depth; ++i) {
+        ns(Monster_start(B));
+        ns(Monster_name_add(B, name));
+        if (next) {
+            ns(Monster_enemy_add(B, next));
+            if (shared) {
+                ns(Monster_testarrayoftables_create(B, &next, 1));
+            }
+        }
+        next = ns(Monster_end(B));
+    }
+    ns(Monster_name_add(B, name));
+    ns(Monster_enemy_add(B, next));
+    if (shared) {
+        ns(Monster_testarrayoftables_create(B, &next, 1));
+    }
+    ns(Monster_end_as_root(B));
+    return finalize(B, size);
+}
+
+/* A monster with a vector of `n` references to the same monster. */
+static void *build_repeated(flatcc_builder_t *B, int n, size_t *size)
+{
+    ns(Monster_ref_t) ref;
+    int i;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_start(B));
+    ns(Monster_name_create_str(B, "shared"));
+    ref = ns(Monster_end(B));
+    ns(Monster_name_create_str(B, "root"));
+    ns(Monster_testarrayoftables_start(B));
+    for (i = 0; i < n; ++i) {
+        ns(Monster_testarrayoftables_push(B, ref));
+    }
+    ns(Monster_testarrayoftables_end(B));
+    ns(Monster_end_as_root(B));
+    return finalize(B, size);
+}
+
+int main(int argc, char *argv[])
+{
+    static const int flatbench_counts[] = { 3, 1000, 100000 };
+    static const int vector_counts[] = { 10, 1000, 100000 };
+    flatcc_builder_t builder, *B = &builder;
+    char name[100];
+    void *buf;
+    size_t size, k;
+    int depth, ret = 0;
+
+    (void)argc;
+    (void)argv;
+    flatcc_builder_init(B);
+    flatcc_verifier_memo_init(&memo);
+    printf("----\nverifier benchmark " COMPILE_TYPE "\n");
+
+    for (k = 0; k < sizeof(flatbench_counts) / sizeof(flatbench_counts[0]); ++k) {
+        buf = build_flatbench(B, flatbench_counts[k], &size);
+        sprintf(name, "flatbench, %d foobars", flatbench_counts[k]);
+        ret |= bench(name, verify_flatbench, buf, size, flatbench_counts[k] + 1, 0);
+        flatcc_builder_aligned_free(buf);
+    }
+    for (k = 0; k < sizeof(vector_counts) / sizeof(vector_counts[0]); ++k) {
+        buf = build_vector(B, vector_counts[k], &size);
+        sprintf(name, "monster vector, %d tables", vector_counts[k]);
+        ret |= bench(name, verify_recursive, buf, size, vector_counts[k] + 1, 0);
+        sprintf(name, "monster vector, %d tables, iterative", vector_counts[k]);
+        ret |= bench(name, verify_iterative, buf, size, vector_counts[k] + 1, 0);
+        sprintf(name, "monster vector, %d tables, parallel", vector_counts[k]);
+        ret |= bench(name, verify_parallel, buf, size, vector_counts[k] + 1, 0);
+        flatcc_builder_aligned_free(buf);
+    }
+
+    /* Adversarial: deep nesting. */
+    buf = build_chain(B, 90, 0, &size);
+    ret |= bench("deep chain, 90 levels", verify_recursive, buf, size, 90, 0);
+    flatcc_builder_aligned_free(buf);
+    buf = build_chain(B, 200, 0, &size);
+    ret |= bench("deep chain, 200 levels, rejected", verify_recursive, buf, size, 100,
+            flatcc_verify_error_max_nesting_level_reached);
+    flatcc_builder_aligned_free(buf);
+    buf = build_chain(B, 100000, 0, &size);
+    ret |= bench("deep chain, 100000 levels, iterative", verify_iterative, buf, size, 100000, 0);
+    flatcc_builder_aligned_free(buf);
+
+    /* Adversarial: maximal sharing, exponential without a memo. */
+    depth = 16;
+    buf = build_chain(B, depth, 1, &size);
+    ret |= bench("shared chain, 16 levels", verify_recursive, buf, size, (double)((1L << depth) - 1), 0);
+    ret |= bench("shared chain, 16 levels, memo", verify_memo, buf, size, depth, 0);
+    flatcc_builder_aligned_free(buf);
+    buf = build_chain(B, 40, 1, &size);
+    ret |= bench("shared chain, 40 levels, memo", verify_memo, buf, size, 40, 0);
+    flatcc_builder_aligned_free(buf);
+
+    /* Adversarial: huge vector counts. */
+    buf = build_repeated(B, 1000000, &size);
+    ret |= bench("1M references to one table", verify_recursive, buf, size, 1000001, 0);
+    ret |= bench("1M references to one table, memo", verify_memo, buf, size, 2, 0);
+    ret |= bench("1M references to one table, parallel", verify_parallel, buf, size, 1000001, 0);
+    flatcc_builder_aligned_free(buf);
+    buf = build_vector(B, 10, &size);
+    /* The vector length field follows the first offset to it. */
+    *(flatbuffers_uoffset_t *)((uint8_t *)ns(Monster_testarrayoftables(ns(Monster_as_root(buf)))) -
+            sizeof(flatbuffers_uoffset_t)) = 0x3fffffff;
+    ret |= bench("vector count beyond buffer, rejected", verify_recursive, buf, size, 1,
+            flatcc_verify_error_vector_out_of_range);
+    flatcc_builder_aligned_free(buf);
+
+    printf("----\n");
+    flatcc_verifier_memo_clear(&memo);
+    flatcc_builder_clear(B);
+    if (ret) {
+        printf("BENCHMARK FAILED\n");
+    }
+    return ret ? -1 : 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * libFuzzer harness for the monster verifiers, see run.sh.
+ *
+ * Every input is verified by the recursive, memoizing and iterative
+ * verifiers, which must agree on whether it is valid. Only the
+ * recursive verifier limits nesting, so inputs it rejects for nesting
+ * are not compared. A valid buffer is also read to make sanitizers
+ * catch fields the verifiers failed to check.
+ *
+ * With `FUZZ_STANDALONE`, `main` runs the harness on each file given,
+ * for example to replay a crash without libFuzzer.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "monster_test_reader.h"
+#include "monster_test_verifier.h"
+
+#undef ns
+#define ns(x) FLATBUFFERS_WRAP_NAMESPACE(MyGame_Example, x)
+
+static flatcc_verifier_memo_t memo;
+
+static size_t read_monster(ns(Monster_table_t) mon)
+{
+    ns(Monster_vec_t) mons = ns(Monster_testarrayoftables(mon));
+    flatbuffers_string_vec_t strings = ns(Monster_testarrayofstring(mon));
+    size_t i, n = strlen(ns(Monster_name(mon)));
+
+    for (i = 0; i < ns(Monster_vec_len(mons)); ++i) {
+        n += strlen(ns(Monster_name(ns(Monster_vec_at(mons, i)))));
+    }
+    for (i = 0; i < flatbuffers_string_vec_len(strings); ++i) {
+        n += strlen(flatbuffers_string_vec_at(strings, i));
+    }
+    if (ns(Monster_enemy(mon))) {
+        n += strlen(ns(Monster_name(ns(Monster_enemy(mon)))));
+    }
+    return n + flatbuffers_uint8_vec_len(ns(Monster_inventory(mon)));
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    void *buf;
+    int ret, ret_memo, ret_iter;
+
+    /* Verifiers require a buffer aligned to its largest scalar. */
+    if (!(buf = aligned_alloc(16, (size + 16) & ~(size_t)15))) {
+        return 0;
+    }
+    memcpy(buf, data, size);
+    ret = ns(Monster_verify_as_root(buf, size));
+    ret_memo = ns(Monster_verify_as_root_with_memo(buf, size, &memo));
+    ret_iter = ns(Monster_verify_as_root_iterative(buf, size));
+    if (ret != flatcc_verify_error_max_nesting_level_reached &&
+            ((ret == 0) != (ret_memo == 0) || (ret == 0) != (ret_iter == 0))) {
+        fprintf(stderr, "verifiers disagree: recursive: %s, memo: %s, iterative: %s\n",
+                flatcc_verify_error_string(ret), flatcc_verify_error_string(ret_memo),
+                flatcc_verify_error_string(ret_iter));
+        abort();
+    }
+    if (ret == 0 && read_monster(ns(Monster_as_root(buf))) == (size_t)-1) {
+        abort();
+    }
+    aligned_free(buf);
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+
+int main(int argc, char *argv[])
+{
+    FILE *fp;
+    uint8_t *data;
+    long size;
+    int i;
+
+    for (i = 1; i < argc; ++i) {
+        if (!(fp = fopen(argv[i], "rb"))) {
+            fprintf(stderr, "cannot open %s\n", argv[i]);
+            return -1;
+        }
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        data = malloc(size > 0 ? (size_t)size : 1);
+        if (!data || fread(data, 1, (size_t)size, fp) != (size_t)size) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return -1;
+        }
+        fclose(fp);
+        LLVMFuzzerTestOneInput(data, (size_t)size);
+        free(data);
+        printf("%s: ok\n", argv[i]);
+    }
+    flatcc_verifier_memo_clear(&memo);
+    return 0;
+}
+
+#endif
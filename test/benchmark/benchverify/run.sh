@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+
+set -e
+cd `dirname $0`/../../..
+ROOT=`pwd`
+TMP=build/tmp/test/benchmark/benchverify
+${ROOT}/scripts/build.sh
+mkdir -p ${TMP}
+rm -rf ${TMP}/*
+bin/flatcc -a -o ${TMP} test/benchmark/schema/flatbench.fbs
+bin/flatcc -a -o ${TMP} test/monster_test/monster_test.fbs
+
+CC=${CC:-cc}
+cp -r test/benchmark/benchverify/* ${TMP}
+cd ${TMP}
+$CC -g -std=c11 -I ${ROOT}/include benchverify.c \
+    ${ROOT}/lib/libflatccrt_d.a -lpthread -o benchverify_d
+$CC -O3 -DNDEBUG -std=c11 -I ${ROOT}/include benchverify.c \
+    ${ROOT}/lib/libflatccrt.a -lpthread -o benchverify
+$CC -g -std=c11 -DFUZZ_STANDALONE -I ${ROOT}/include fuzzverify.c \
+    ${ROOT}/lib/libflatccrt_d.a -lpthread -o fuzzverify_replay
+echo "running verifier benchmark for C (debug)"
+./benchverify_d
+echo "running verifier benchmark for C (optimized)"
+./benchverify
+
+# libFuzzer needs clang, e.g.: FUZZ_CC=clang test/benchmark/benchverify/run.sh
+# and then: build/tmp/test/benchmark/benchverify/fuzzverify corpus/
+if [ -n "${FUZZ_CC}" ]; then
+    ${FUZZ_CC} -g -O1 -std=c11 -fsanitize=fuzzer,address,undefined -I ${ROOT}/include \
+        fuzzverify.c ${ROOT}/src/runtime/verifier.c ${ROOT}/src/runtime/verifier_threads.c \
+        -lpthread -o fuzzverify
+    echo "built libFuzzer harness ${TMP}/fuzzverify"
+fi
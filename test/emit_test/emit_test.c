@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <assert.h>
 #include "emit_test_builder.h"
+#include "flatcc/flatcc_mmap_emitter.h"
 #include "flatcc/support/hexdump.h"
 #include "flatcc/portable/pparsefp.h"
 
@@ -125,6 +126,315 @@ int emit_test(void)
     return 0;
 }
 
+static int count_pages(flatcc_emitter_t *E)
+{
+    flatcc_emitter_page_t *p = E->front;
+    int n = 0;
+
+    if (p) {
+        do {
+            ++n;
+            p = p->next;
+        } while (p != E->front);
+    }
+    return n;
+}
+
+static int build_large(flatcc_builder_t *B, const float *data, size_t count)
+{
+    size_t i;
+
+    flatcc_builder_start_buffer(B, 0, 0, 0);
+    main_start(B);
+    main_samples_start(B);
+    for (i = 0; i < count; ++i) {
+        flatbuffers_float_vec_push(B, &data[i]);
+    }
+    main_samples_end(B);
+    main_time_add(B, 42);
+    return 0 == flatcc_builder_end_buffer(B, main_end(B));
+}
+
+/*
+ * Large buffers should use few, geometrically growing pages and the
+ * copied buffer must be correct across pages of different size.
+ */
+int page_growth_test(void)
+{
+    const size_t count = 1000000;
+    flatcc_emitter_t *E;
+    flatcc_builder_t builder, *B;
+    float *data;
+    uint8_t *buf = 0;
+    size_t i, k, size;
+    main_table_t mt;
+    flatbuffers_float_vec_t samples;
+    flatcc_iovec_t *iov = 0;
+    int iov_count;
+    int ret = -1;
+
+    B = &builder;
+    data = malloc(count * sizeof(float));
+    for (i = 0; i < count; ++i) {
+        data[i] = (float)i;
+    }
+    flatcc_builder_init(B);
+    E = flatcc_builder_get_emit_context(B);
+    if (build_large(B, data, count)) {
+        goto done;
+    }
+
+    /* About 4MB in 3KB pages would be more than a thousand pages. */
+    if (count_pages(E) > 20) {
+        printf("too many emitter pages: %d\n", count_pages(E));
+        goto done;
+    }
+    buf = flatcc_builder_finalize_buffer(B, &size);
+    if (!buf) {
+        goto done;
+    }
+    mt = main_as_root(buf);
+    samples = main_samples(mt);
+    if (main_time(mt) != 42 || flatbuffers_float_vec_len(samples) != count) {
+        goto done;
+    }
+    for (i = 0; i < count; ++i) {
+        if (flatbuffers_float_vec_at(samples, i) != data[i]) {
+            goto done;
+        }
+    }
+    /* The segments must cover the buffer exactly, in order. */
+    iov_count = flatcc_builder_get_buffer_iov(B, 0, 0);
+    if (iov_count < 2 || iov_count > 20) {
+        goto done;
+    }
+    iov = malloc(sizeof(flatcc_iovec_t) * (size_t)iov_count);
+    if (flatcc_builder_get_buffer_iov(B, iov, iov_count) != iov_count) {
+        goto done;
+    }
+    for (i = 0, k = 0; i < (size_t)iov_count; ++i) {
+        if (iov[i].iov_len == 0 || k + iov[i].iov_len > size ||
+                memcmp(buf + k, iov[i].iov_base, iov[i].iov_len)) {
+            goto done;
+        }
+        k += iov[i].iov_len;
+    }
+    if (k != size) {
+        goto done;
+    }
+    free(iov);
+    iov = 0;
+    /*
+     * Small buffers after a reset should still fit the first small page,
+     * and the reset heuristic should gradually release the large pages.
+     */
+    for (i = 0; i < 50; ++i) {
+        flatcc_builder_reset(B);
+        main_create_as_root(B, 43, 1, flatbuffers_float_vec_create(B, data, 4));
+        if (!flatcc_builder_get_direct_buffer(B, 0) || flatcc_builder_get_buffer_iov(B, 0, 0) != 1) {
+            goto done;
+        }
+    }
+    if (E->capacity > FLATCC_EMITTER_PAGE_SIZE) {
+        printf("emitter did not shrink after reset: %d\n", (int)E->capacity);
+        goto done;
+    }
+    ret = 0;
+done:
+    if (ret) {
+        printf("page growth test failed\n");
+    }
+    free(iov);
+    flatcc_builder_free(buf);
+    flatcc_builder_clear(B);
+    free(data);
+    return ret;
+}
+
+typedef struct stream_sink stream_sink_t;
+struct stream_sink {
+    uint8_t *base;
+    /* Position of offset 0 in base. */
+    size_t zero;
+    size_t size;
+    flatbuffers_soffset_t start, end;
+    flatbuffers_soffset_t last;
+    int build_chunks;
+    int done;
+};
+
+static int stream_flush(void *flush_context, const void *data, size_t len,
+        flatbuffers_soffset_t offset)
+{
+    stream_sink_t *S = flush_context;
+
+    if ((offset < 0 && (size_t)-offset > S->zero) ||
+            (offset >= 0 && S->zero + (size_t)offset + len > S->size)) {
+        return -1;
+    }
+    if (!S->done) {
+        /* Chunks during build arrive back to front without gaps. */
+        if (S->build_chunks && offset + (flatbuffers_soffset_t)len != S->last) {
+            return -1;
+        }
+        S->last = offset;
+        ++S->build_chunks;
+    }
+    memcpy(S->base + S->zero + offset, data, len);
+    if (offset < S->start) {
+        S->start = offset;
+    }
+    if (offset + (flatbuffers_soffset_t)len > S->end) {
+        S->end = offset + (flatbuffers_soffset_t)len;
+    }
+    return 0;
+}
+
+/*
+ * Streams a large buffer through a sink while keeping only a few
+ * emitter pages resident, and checks the reassembled result.
+ */
+int stream_test(int clustering)
+{
+    const size_t count = 500000;
+    flatcc_emitter_t *E;
+    flatcc_builder_t builder, *B;
+    stream_sink_t sink;
+    float *data;
+    uint8_t *buf = 0;
+    size_t i, size;
+    int ret = -1;
+
+    B = &builder;
+    memset(&sink, 0, sizeof(sink));
+    data = malloc(count * sizeof(float));
+    for (i = 0; i < count; ++i) {
+        data[i] = (float)i;
+    }
+    /* Reference buffer without streaming. */
+    flatcc_builder_init(B);
+    flatcc_builder_set_vtable_clustering(B, clustering);
+    build_large(B, data, count);
+    buf = flatcc_builder_finalize_buffer(B, &size);
+    flatcc_builder_clear(B);
+
+    sink.size = 2 * size + 1024;
+    sink.zero = size + 512;
+    sink.base = calloc(1, sink.size);
+
+    flatcc_builder_init(B);
+    flatcc_builder_set_vtable_clustering(B, clustering);
+    E = flatcc_builder_get_emit_context(B);
+    flatcc_emitter_set_flush(E, stream_flush, &sink);
+    if (build_large(B, data, count)) {
+        goto done;
+    }
+    if (E->capacity > 4 * FLATCC_EMITTER_PAGE_SIZE || sink.build_chunks < 100) {
+        printf("streaming emitter kept too much memory: %d\n", (int)E->capacity);
+        goto done;
+    }
+    sink.done = 1;
+    if (flatcc_emitter_flush(E)) {
+        goto done;
+    }
+    if ((size_t)(sink.end - sink.start) != size ||
+            memcmp(buf, sink.base + sink.zero + sink.start, size)) {
+        goto done;
+    }
+    if (main_time(main_as_root(sink.base + sink.zero + sink.start)) != 42) {
+        goto done;
+    }
+    ret = 0;
+done:
+    if (ret) {
+        printf("stream test failed\n");
+    }
+    flatcc_builder_clear(B);
+    flatcc_builder_free(buf);
+    free(sink.base);
+    free(data);
+    return ret;
+}
+
+/*
+ * Builds a buffer much larger than the initial file capacity so the
+ * mapping must grow at both ends, then checks the finalized file.
+ */
+int mmap_emit_test(void)
+{
+    const char *path = "emit_test_mmap.tmp";
+    const size_t count = 100000;
+    flatcc_mmap_emitter_t E;
+    flatcc_builder_t builder, *B;
+    float *data;
+    uint8_t *buf, *file_buf;
+    size_t i, size, file_size;
+    main_table_t mt;
+    flatbuffers_float_vec_t samples;
+    FILE *fp;
+    int ret = -1;
+
+    B = &builder;
+    if (flatcc_mmap_emitter_open(&E, path, 1024)) {
+        /* Not supported on this platform. */
+        printf("mmap emitter not available, skipping test\n");
+        return 0;
+    }
+    data = malloc(count * sizeof(float));
+    for (i = 0; i < count; ++i) {
+        data[i] = (float)i;
+    }
+    flatcc_builder_custom_init(B, flatcc_mmap_emitter, &E, 0, 0);
+    main_create_as_root(B, 42, 1, flatbuffers_float_vec_create(B, data, count));
+
+    buf = flatcc_mmap_emitter_get_direct_buffer(&E, &size);
+    if (!buf || size != flatcc_builder_get_buffer_size(B)) {
+        goto done;
+    }
+    if (flatcc_mmap_emitter_finalize(&E, &file_size) || file_size != size) {
+        goto done;
+    }
+    buf = flatcc_mmap_emitter_get_direct_buffer(&E, &size);
+    if (!buf || size != file_size) {
+        goto done;
+    }
+    mt = main_as_root(buf);
+    samples = main_samples(mt);
+    if (main_time(mt) != 42 || flatbuffers_float_vec_len(samples) != count ||
+            flatbuffers_float_vec_at(samples, count - 1) != (float)(count - 1)) {
+        goto done;
+    }
+    /* The file must now hold exactly the buffer. */
+    fp = fopen(path, "rb");
+    if (!fp) {
+        goto done;
+    }
+    file_buf = malloc(size + 1);
+    if (fread(file_buf, 1, size + 1, fp) == size && 0 == memcmp(file_buf, buf, size)) {
+        ret = 0;
+    }
+    free(file_buf);
+    fclose(fp);
+
+    /* The emitter can be reused for another buffer in the same file. */
+    flatcc_builder_reset(B);
+    if (ret == 0 && (flatcc_mmap_emitter_reset(&E) ||
+            !main_create_as_root(B, 43, 2, flatbuffers_float_vec_create(B, data, 4)) ||
+            flatcc_mmap_emitter_finalize(&E, &size) ||
+            main_time(main_as_root(flatcc_mmap_emitter_get_direct_buffer(&E, 0))) != 43)) {
+        ret = -1;
+    }
+done:
+    if (ret) {
+        printf("mmap emitter test failed\n");
+    }
+    flatcc_builder_clear(B);
+    flatcc_mmap_emitter_clear(&E);
+    free(data);
+    remove(path);
+    return ret;
+}
+
 int main(int argc, char *argv[])
 {
     int ret = 0;
@@ -134,5 +444,9 @@ int main(int argc, char *argv[])
 
     ret |= debug_test();
     ret |= emit_test();
+    ret |= page_growth_test();
+    ret |= stream_test(0);
+    ret |= stream_test(1);
+    ret |= mmap_emit_test();
     return ret;
 }
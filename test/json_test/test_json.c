@@ -45,6 +45,52 @@ static const struct test_scope Movie = {
     nsf(Movie_verify_table)
 };
 
+/*
+ * Parses again with a character class index and requires the same
+ * result, error location, and line count as `ctx` parsing into `B`.
+ */
+static int test_json_index(const struct test_scope *scope, char *json,
+        flatcc_json_parser_flags_t parse_flags, int err, flatcc_builder_t *B,
+        flatcc_json_parser_t *ctx, int line)
+{
+    flatcc_builder_t builder;
+    flatcc_json_parser_t parser_ctx;
+    void *expect = 0, *buf = 0;
+    size_t size = 0;
+    int ret = -1;
+
+    flatcc_builder_init(&builder);
+    if (err != flatcc_json_parser_table_as_root(&builder, &parser_ctx, json, strlen(json),
+            parse_flags | flatcc_json_parser_f_with_index, scope->identifier, scope->parser)) {
+        fprintf(stderr, "%d: json test: indexed parse result differs\n", line);
+        goto done;
+    }
+    if (parser_ctx.line != ctx->line || parser_ctx.pos != ctx->pos ||
+            parser_ctx.error_loc != ctx->error_loc || parser_ctx.line_start != ctx->line_start) {
+        fprintf(stderr, "%d: json test: indexed parse at line %d, pos %d, expected line %d, pos %d\n",
+                line, parser_ctx.line, parser_ctx.pos, ctx->line, ctx->pos);
+        goto done;
+    }
+    if (!err) {
+        size = flatcc_builder_get_buffer_size(B);
+        expect = malloc(size);
+        buf = malloc(size);
+        if (!expect || !buf || size != flatcc_builder_get_buffer_size(&builder) ||
+                !flatcc_builder_copy_buffer(B, expect, size) ||
+                !flatcc_builder_copy_buffer(&builder, buf, size) ||
+                memcmp(expect, buf, size)) {
+            fprintf(stderr, "%d: json test: indexed parse built a different buffer\n", line);
+            goto done;
+        }
+    }
+    ret = 0;
+done:
+    free(expect);
+    free(buf);
+    flatcc_builder_clear(&builder);
+    return ret;
+}
+
 int test_json(const struct test_scope *scope, char *json,
         char *expect, int expect_err,
         flatcc_json_parser_flags_t parse_flags, flatcc_json_printer_flags_t print_flags, int line)
@@ -88,6 +134,9 @@ int test_json(const struct test_scope *scope, char *json,
         fprintf(stderr, "^\n");
         goto failed;
     }
+    if (test_json_index(scope, json, parse_flags, err, B, &parser_ctx, line)) {
+        goto failed;
+    }
     if (expect_err) {
         ret = 0;
         goto done;
@@ -582,6 +631,207 @@ int fixed_array_tests(void)
  * covered in the printer and parser tests using the golden data
  * set.
  */
+/*
+ * Space, strings, and errors around the 64 byte blocks of the index.
+ * Every test also runs with the index, this covers the block edges.
+ */
+int index_tests(void)
+{
+    BEGIN_TEST(Monster);
+
+    TEST(   "{                                                              \"name\": \"Monster\" }",
+            "{\"name\":\"Monster\"}");
+    TEST(   "{ \"name\": \"A long monster name that does not fit in a single block of the index at all\" }",
+            "{\"name\":\"A long monster name that does not fit in a single block of the index at all\"}");
+    TEST(   "{ \"name\": \"A long monster name with an \\\"escape\\\" beyond the first block \\t\\\\ of the index\" }",
+            "{\"name\":\"A long monster name with an \\\"escape\\\" beyond the first block \\t\\\\ of the index\"}");
+    /* CR LF split between the first two blocks. */
+    TEST(   "{ \"name\": \"Monster\",                                           \r\n\r\r\n\n  \"hp\": 10 }",
+            "{\"hp\":10,\"name\":\"Monster\"}");
+    /* Errors must be reported at the same line and position. */
+    TEST_ERROR( "{\n\n    \"name\": \"Monster\",\r\n                                                            \"hp\": 10,\r  \x01 }",
+            flatcc_json_parser_error_unexpected_character );
+    TEST_ERROR( "{\n    \"name\": \"A long monster name that does not fit in a single block\n of the index\" }",
+            flatcc_json_parser_error_invalid_character );
+    TEST_ERROR( "{\n    \"name\": \"A long monster name that does not fit in a single block of the index",
+            flatcc_json_parser_error_unterminated_string );
+
+    END_TEST();
+}
+
+/*
+ * Strings with escapes are decoded in one pass, and special characters
+ * are found 16 or 8 bytes at a time, so runs and escapes are placed on
+ * both sides of those widths.
+ */
+int string_escape_tests(void)
+{
+    BEGIN_TEST(Monster);
+
+    TEST(   "{ \"name\": \"C:\\\\Program Files\\\\flatcc\\\\include\\\\flatcc\\\\reflection\\\\flatbuffers_common_reader.h\" }",
+            "{\"name\":\"C:\\\\Program Files\\\\flatcc\\\\include\\\\flatcc\\\\reflection\\\\flatbuffers_common_reader.h\"}");
+    TEST(   "{ \"name\": \"{\\\"name\\\":\\\"Monster\\\",\\\"testarrayofstring\\\":[\\\"a\\\",\\\"b\\\\\\\\c\\\"]}\" }",
+            "{\"name\":\"{\\\"name\\\":\\\"Monster\\\",\\\"testarrayofstring\\\":[\\\"a\\\",\\\"b\\\\\\\\c\\\"]}\"}");
+    TEST(   "{ \"name\": \"\\n0123456789abcde\\n0123456789abcdef\\n0123456789abcdefg\\n01234567\\n012345678\\n\" }",
+            "{\"name\":\"\\n0123456789abcde\\n0123456789abcdef\\n0123456789abcdefg\\n01234567\\n012345678\\n\"}");
+    /* Decoding shrinks the string, and a long run follows the escapes. */
+    TEST(   "{ \"name\": \"\\u0041\\u0042\\u0043\\u0044\\u0045\\u0046\\u0047\\u0048\\x49\\x4a\\ud83d\\ude00 and a long run without escapes\" }",
+            "{\"name\":\"ABCDEFGHIJ\xf0\x9f\x98\x80 and a long run without escapes\"}");
+    TEST(   "{ \"name\": \"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\" }",
+            "{\"name\":\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\\\"\"}");
+    /* All control characters are rejected, not only those the SSE 4.2 needle listed. */
+    TEST_ERROR( "{ \"name\": \"0123456789abcdef0123456789\x1b\" }",
+            flatcc_json_parser_error_invalid_character );
+    TEST_ERROR( "{ \"name\": \"01234567\x01\" }",
+            flatcc_json_parser_error_invalid_character );
+    TEST_ERROR( "{ \"name\": \"0123\x1f\" }",
+            flatcc_json_parser_error_invalid_character );
+    TEST_ERROR( "{ \"name\": \"\\\\0123456789abcdef0123456789\x7f\x10\" }",
+            flatcc_json_parser_error_invalid_character );
+    TEST_ERROR( "{ \"name\": \"\\t0123456789abcdef\\q0123456789\" }",
+            flatcc_json_parser_error_invalid_escape );
+    TEST_ERROR( "{ \"name\": \"\\t0123456789abcdef\\\"0123456789",
+            flatcc_json_parser_error_unterminated_string );
+
+    END_TEST();
+}
+
+struct lines_result {
+    int count;
+    int hp_sum;
+    int stop_at;
+    int errors;
+    int error_lines[4];
+    /* Size prefixed buffers written back to back. */
+    size_t stream_size;
+    char stream[1024];
+};
+
+static int lines_record(void *context, flatcc_builder_t *B, flatcc_json_parser_t *ctx)
+{
+    struct lines_result *r = context;
+    void *buf;
+    size_t size;
+
+    if (ctx->error) {
+        r->error_lines[r->errors++ % 4] = ctx->line;
+        return 0;
+    }
+    if (!(buf = flatcc_builder_get_direct_buffer(B, &size)) ||
+            size > sizeof(r->stream) - r->stream_size) {
+        return -1;
+    }
+    memcpy(r->stream + r->stream_size, buf, size);
+    r->stream_size += size;
+    if (ns(Monster_verify_as_root_with_size(buf, size))) {
+        return -1;
+    }
+    r->hp_sum += ns(Monster_hp(ns(Monster_as_root((uint8_t *)buf + sizeof(flatbuffers_uoffset_t)))));
+    return ++r->count == r->stop_at ? 2 : 0;
+}
+
+int json_lines_tests(void)
+{
+    const char *json =
+        "{ \"name\": \"one\", \"hp\": 1 }\n"
+        "\n"
+        "   { \"name\": \"two\",\r\n  \"hp\": 2 }\r\n"
+        "{ \"name\": \"bad\", \"hp\": [] }\n"
+        "{ \"name\": \"three\", \"hp\": 3 } { \"name\": \"four\" }\n"
+        "{ \"name\": \"five\", \"hp\": 5 }\n"
+        "{ \"name\":\n \"six\", \"hp\": 6 } { \"name\": \"seven\", \"hp\": 7 }";
+    flatcc_json_parser_flags_t flags = flatcc_json_parser_f_with_size;
+    flatcc_builder_t builder, *B = &builder;
+    flatcc_json_parser_t ctx;
+    flatcc_verifier_stream_t S;
+    struct lines_result r;
+    int ret = -1;
+
+    flatcc_builder_init(B);
+    memset(&r, 0, sizeof(r));
+    if (ns(Monster_parse_json_lines(B, &ctx, json, strlen(json), flags, ns(Monster_file_identifier),
+            lines_record, &r))) {
+        fprintf(stderr, "json lines test: parse failed\n");
+        goto done;
+    }
+    /* A record on the same line as the previous record fails, even if that spans lines. */
+    if (r.count != 5 || r.hp_sum != 17 || r.errors != 3 ||
+            r.error_lines[0] != 5 || r.error_lines[1] != 6 || r.error_lines[2] != 9 || ctx.line != 9) {
+        fprintf(stderr, "json lines test: unexpected records: %d, errors: %d\n", r.count, r.errors);
+        goto done;
+    }
+    ns(Monster_verifier_stream_init(&S));
+    if (flatcc_verify_stream(&S, r.stream, r.stream_size) || S.record_count != 5 || S.error_count != 0) {
+        fprintf(stderr, "json lines test: output stream not valid\n");
+        flatcc_verifier_stream_clear(&S);
+        goto done;
+    }
+    flatcc_verifier_stream_clear(&S);
+    memset(&r, 0, sizeof(r));
+    r.stop_at = 2;
+    if (2 != ns(Monster_parse_json_lines(B, &ctx, json, strlen(json), flags | flatcc_json_parser_f_with_index,
+            ns(Monster_file_identifier), lines_record, &r)) || r.count != 2 || r.hp_sum != 3) {
+        fprintf(stderr, "json lines test: record did not stop parsing\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_clear(B);
+    return ret;
+}
+
+/* The same records must result regardless of how input is chunked. */
+int json_stream_tests(void)
+{
+    const char *json =
+        "{ \"name\": \"one\", \"hp\": 1 }\n"
+        "\n"
+        "   { \"name\": \"two\",\r\n  \"hp\": 2 }\r\n"
+        "{ \"name\": \"bad\", \"hp\": [] }\n"
+        "{ \"name\": \"th\\\"ree}\\\\\", \"hp\": 3 }{ \"name\": \"four\", \"hp\": [4][0] } { \"testarrayofstring\": [\"]\"], \"name\": \"five\", \"hp\": 5 }\n"
+        "{ \"name\": \"six\", \"hp\": 6 ";
+    flatcc_json_parser_flags_t flags = flatcc_json_parser_f_with_size;
+    flatcc_builder_t builder, *B = &builder;
+    flatcc_json_parser_stream_t S;
+    struct lines_result r, expect;
+    size_t n, k, size = strlen(json);
+    int ret = 0;
+
+    flatcc_builder_init(B);
+    for (n = 1; n <= size; n = n < 16 ? n + 1 : size) {
+        memset(&r, 0, sizeof(r));
+        flatcc_json_parser_stream_init(&S, B, flags, ns(Monster_file_identifier),
+                ns(Monster_parse_json_table), lines_record, &r);
+        for (k = 0; k < size; k += n) {
+            if (flatcc_json_parser_stream_feed(&S, json + k, size - k < n ? size - k : n)) {
+                break;
+            }
+        }
+        if (k < size || flatcc_json_parser_stream_end(&S)) {
+            fprintf(stderr, "json stream test: parse failed with chunk size %d\n", (int)n);
+            ret = -1;
+        }
+        flatcc_json_parser_stream_clear(&S);
+        if (n == 1) {
+            expect = r;
+        }
+        /* "four" fails on the trailing index, "six" is incomplete. */
+        if (r.count != 4 || r.hp_sum != 11 || r.errors != 3 || r.error_lines[0] != 5 ||
+                r.error_lines[1] != 6 || r.error_lines[2] != 7 ||
+                S.record_count != 4 || S.error_count != 3 ||
+                r.stream_size != expect.stream_size || memcmp(r.stream, expect.stream, r.stream_size)) {
+            fprintf(stderr, "json stream test: unexpected result with chunk size %d: %d records, %d errors\n",
+                    (int)n, r.count, r.errors);
+            ret = -1;
+        }
+        if (n == size) {
+            break;
+        }
+    }
+    flatcc_builder_clear(B);
+    return ret;
+}
+
 int main(void)
 {
     BEGIN_TEST(Monster);
@@ -592,6 +842,10 @@ int main(void)
     ret |= fixed_array_tests();
     ret |= base64_tests();
     ret |= mixed_type_union_tests();
+    ret |= index_tests();
+    ret |= string_escape_tests();
+    ret |= json_lines_tests();
+    ret |= json_stream_tests();
 
     /* Allow trailing comma. */
     TEST(   "{ \"name\": \"Monster\", }",
@@ -3,6 +3,9 @@
 #include "monster_test_builder.h"
 #include "monster_test_verifier.h"
 
+#include "flatcc/flatcc_arena.h"
+#include "flatcc/flatcc_builder_pool.h"
+#include "flatcc/flatcc_rtconfig.h"
 #include "flatcc/support/hexdump.h"
 #include "flatcc/support/elapsed.h"
 #include "flatcc/portable/pparsefp.h"
@@ -892,6 +895,10 @@ int test_monster(flatcc_builder_t *B)
         printf("Monster buffer failed to verify, got: %s\n", flatcc_verify_error_string(ret));
         return -1;
     }
+    if ((ret = ns(Monster_verify_as_root_iterative(buffer, size)))) {
+        printf("Monster buffer failed to verify iteratively, got: %s\n", flatcc_verify_error_string(ret));
+        return -1;
+    }
     ret = verify_monster(buffer);
 
     flatcc_builder_aligned_free(buffer);
@@ -924,12 +931,431 @@ int test_monster_with_size(flatcc_builder_t *B)
         printf("Monster buffer with size prefix failed to verify, got: %s\n", flatcc_verify_error_string(ret));
         return -1;
     }
+    /* The identifier follows the root offset, after the size prefix. */
+    if ((ret = flatcc_verify_table_as_root_with_size_iterative(frame, size, 0,
+            ns(Monster_table_verifier_type()), 0))) {
+        printf("Monster buffer with size prefix failed to verify iteratively, got: %s\n", flatcc_verify_error_string(ret));
+        return -1;
+    }
     ret = verify_monster(buffer);
 
     flatcc_builder_aligned_free(frame);
     return ret;
 }
 
+/*
+ * Builds the monster repeatedly with all builder stacks and emitter
+ * pages taken from a fixed memory block, which also verifies that no
+ * allocation escapes the arena once the builder is warm.
+ */
+int test_arena_monster(void)
+{
+    static uint8_t mem[256 * 1024];
+    flatcc_arena_t arena;
+    flatcc_builder_t builder, *B;
+    void *buffer;
+    size_t size;
+    int i, ret = -1;
+
+    B = &builder;
+    flatcc_arena_init(&arena, mem, sizeof(mem));
+    flatcc_arena_set_limit(&arena, sizeof(mem));
+    flatcc_builder_custom_init(B, 0, 0, flatcc_arena_alloc, &arena);
+    flatcc_emitter_set_alloc(flatcc_builder_get_emit_context(B),
+            flatcc_arena_emitter_alloc, &arena);
+    for (i = 0; i < 3; ++i) {
+        flatcc_builder_reset(B);
+        if (gen_monster(B, 0)) {
+            goto done;
+        }
+        buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+        if (!buffer) {
+            goto done;
+        }
+        if (ns(Monster_verify_as_root(buffer, size)) || verify_monster(buffer)) {
+            printf("arena built monster buffer failed to verify\n");
+            flatcc_builder_aligned_free(buffer);
+            goto done;
+        }
+        flatcc_builder_aligned_free(buffer);
+    }
+    if (arena.regions != &arena.first || arena.regions->next) {
+        printf("arena allocated outside the provided memory\n");
+        goto done;
+    }
+    /* Blocks released by clear are reused after an O(1) reset. */
+    flatcc_builder_clear(B);
+    flatcc_arena_reset(&arena);
+    flatcc_builder_custom_init(B, 0, 0, flatcc_arena_alloc, &arena);
+    flatcc_emitter_set_alloc(flatcc_builder_get_emit_context(B),
+            flatcc_arena_emitter_alloc, &arena);
+    if (gen_monster(B, 0)) {
+        goto done;
+    }
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+    ret = !buffer || verify_monster(buffer);
+    flatcc_builder_aligned_free(buffer);
+done:
+    flatcc_builder_clear(B);
+    flatcc_arena_clear(&arena);
+    return ret;
+}
+
+/* The pool must detach flush functions, so this is never called. */
+static int pool_test_flush(void *flush_context, const void *data, size_t len, flatbuffers_soffset_t offset)
+{
+    (void)flush_context; (void)data; (void)len; (void)offset;
+    return -1;
+}
+
+int test_builder_pool(void)
+{
+    static uint8_t mem[256 * 1024];
+    flatcc_arena_t arena;
+    flatcc_builder_pool_t pool;
+    flatcc_builder_t builder, *B, *B1, *B2;
+    flatcc_emitter_t *E;
+    flatcc_vtable_dict_t dict;
+    void *expected = 0, *buffer;
+    size_t expected_size, size;
+    int i, ret = -1;
+
+    B = &builder;
+    flatcc_builder_init(B);
+    if (gen_monster(B, 0) || !(expected = flatcc_builder_finalize_aligned_buffer(B, &expected_size))) {
+        flatcc_builder_clear(B);
+        return -1;
+    }
+    flatcc_builder_clear(B);
+    flatcc_vtable_dict_init(&dict);
+    flatcc_arena_init(&arena, mem, sizeof(mem));
+    flatcc_builder_pool_init(&pool, 0, 0);
+    B1 = 0;
+    for (i = 0; i < 3; ++i) {
+        if (!(B = flatcc_builder_pool_acquire(&pool))) {
+            goto done;
+        }
+        if (B1 && B != B1) {
+            printf("builder pool did not reuse the idle builder\n");
+            flatcc_builder_pool_release(&pool, B);
+            goto done;
+        }
+        B1 = B;
+        if (i > 0 && B->vb_end == 0) {
+            printf("builder pool did not retain the vtable cache\n");
+            flatcc_builder_pool_release(&pool, B);
+            goto done;
+        }
+        if (gen_monster(B, 0) || !(buffer = flatcc_builder_finalize_aligned_buffer(B, &size))) {
+            flatcc_builder_pool_release(&pool, B);
+            goto done;
+        }
+        flatcc_builder_pool_release(&pool, B);
+        /* Retained vtables must not change the buffer. */
+        if (size != expected_size || memcmp(buffer, expected, size)) {
+            printf("pooled builder produced a different monster buffer\n");
+            flatcc_builder_aligned_free(buffer);
+            goto done;
+        }
+        flatcc_builder_aligned_free(buffer);
+    }
+    /* Settings do not pass to the next user, also when the builder is trimmed on release. */
+    for (i = 0; i < 2; ++i) {
+        if (!(B = flatcc_builder_pool_acquire(&pool))) {
+            goto done;
+        }
+        /* Emitter pages come from the arena and must be returned to it. */
+        E = flatcc_builder_get_emit_context(B);
+        flatcc_emitter_clear(E);
+        flatcc_emitter_set_alloc(E, flatcc_arena_emitter_alloc, &arena);
+        flatcc_emitter_set_page_size(E, 1024, 1024);
+        if (gen_monster(B, 0)) {
+            flatcc_builder_pool_release(&pool, B);
+            goto done;
+        }
+        flatcc_builder_set_max_level(B, 3);
+        flatcc_builder_set_vtable_clustering(B, 0);
+        flatcc_builder_set_vtable_cache_limit(B, 1);
+        if (flatcc_vtable_dict_freeze(&dict) || flatcc_builder_set_vtable_dict(B, &dict)) {
+            flatcc_builder_pool_release(&pool, B);
+            goto done;
+        }
+        flatcc_emitter_set_flush(E, pool_test_flush, 0);
+        pool.trim_size = i == 0 ? FLATCC_BUILDER_POOL_TRIM_SIZE : 1;
+        flatcc_builder_pool_release(&pool, B);
+        B = flatcc_builder_pool_acquire(&pool);
+        flatcc_builder_pool_release(&pool, B);
+        if (B->max_level != 0 || B->disable_vt_clustering || B->vt_dict ||
+                B->vb_flush_limit != FLATCC_BUILDER_POOL_VTABLE_CACHE_LIMIT || !B->retain_vtable_cache) {
+            printf("pooled builder kept the settings of the previous user\n");
+            goto done;
+        }
+        if (E->flush || E->alloc || E->page_size || E->page_size_limit) {
+            printf("pooled builder kept the emitter settings of the previous user\n");
+            goto done;
+        }
+    }
+    pool.trim_size = FLATCC_BUILDER_POOL_TRIM_SIZE;
+    B1 = flatcc_builder_pool_acquire(&pool);
+    B2 = flatcc_builder_pool_acquire(&pool);
+    if (!B1 || !B2 || B1 == B2) {
+        goto done;
+    }
+    flatcc_builder_pool_release(&pool, B1);
+    flatcc_builder_pool_release(&pool, B2);
+    /* Both builders were needed in this period, but not in the next. */
+    if (flatcc_builder_pool_trim(&pool) != 0 || flatcc_builder_pool_trim(&pool) != 2) {
+        printf("builder pool trimmed unexpectedly\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_pool_clear(&pool);
+    flatcc_builder_aligned_free(expected);
+    flatcc_vtable_dict_clear(&dict);
+    flatcc_arena_clear(&arena);
+    return ret;
+}
+
+int test_vtable_dict(void)
+{
+    flatcc_vtable_dict_t dict;
+    flatcc_builder_t builder1, builder2, *B1, *B2;
+    void *expected = 0, *buffer;
+    size_t expected_size, size;
+    int i, ret = -1;
+
+    B1 = &builder1;
+    B2 = &builder2;
+    flatcc_vtable_dict_init(&dict);
+    flatcc_builder_init(B1);
+    flatcc_builder_init(B2);
+    flatcc_builder_set_vtable_cache_retention(B1, 1);
+    if (gen_monster(B1, 0) || !(expected = flatcc_builder_finalize_aligned_buffer(B1, &expected_size))) {
+        goto done;
+    }
+    if (flatcc_builder_set_vtable_dict(B2, &dict) != -1) {
+        printf("vtable dictionary attached before freeze\n");
+        goto done;
+    }
+    if (flatcc_builder_export_vtable_cache(B1, &dict) || flatcc_vtable_dict_freeze(&dict)
+            || flatcc_builder_set_vtable_dict(B2, &dict)) {
+        goto done;
+    }
+    for (i = 0; i < 2; ++i) {
+        flatcc_builder_reset(B2);
+        if (gen_monster(B2, 0) || !(buffer = flatcc_builder_finalize_aligned_buffer(B2, &size))) {
+            goto done;
+        }
+        if (size != expected_size || memcmp(buffer, expected, size)) {
+            printf("vtable dictionary changed the monster buffer\n");
+            flatcc_builder_aligned_free(buffer);
+            goto done;
+        }
+        flatcc_builder_aligned_free(buffer);
+    }
+    /* Dictionary vtables are emitted through the vr buffer. */
+    if (!B2->buffers[flatcc_builder_alloc_vr].iov_base) {
+        printf("vtable dictionary was not used\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_clear(B1);
+    flatcc_builder_clear(B2);
+    flatcc_vtable_dict_clear(&dict);
+    flatcc_builder_aligned_free(expected);
+    return ret;
+}
+
+int test_create_fixed(flatcc_builder_t *B)
+{
+    ns(FixedStat_table_t) stat;
+    ns(FixedStat_ref_t) ref, ref2;
+    ns(Test_t) test = { 7, -3 };
+    ns(Test_struct_t) t;
+    flatbuffers_string_ref_t id;
+    void *buffer;
+    size_t size;
+    int ret = -1;
+
+    flatcc_builder_reset(B);
+    flatcc_builder_start_buffer(B, ns(FixedStat_identifier), 0, 0);
+    id = flatbuffers_string_create_str(B, "fixed");
+    if (ns(FixedStat_create_fixed(B, 0, 1, 2, &test, ns(Color_Red)))) {
+        printf("fixed table accepted missing required string\n");
+        return -1;
+    }
+    /* The second table must reuse the vtable of the first. */
+    ref2 = ns(FixedStat_create_fixed(B, id, 1, 2, &test, ns(Color_Red)));
+    ref = ns(FixedStat_create_fixed(B, id, -42, 0, &test, ns(Color_Blue)));
+    if (!ref || !ref2 || !flatcc_builder_end_buffer(B, ref)) {
+        printf("fixed table construction failed\n");
+        return -1;
+    }
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+    hexdump("fixed table", buffer, size, stderr);
+    if ((ret = ns(FixedStat_verify_as_root(buffer, size)))) {
+        printf("fixed table failed to verify, got: %s\n", flatcc_verify_error_string(ret));
+        ret = -1;
+        goto done;
+    }
+    ret = -1;
+    stat = ns(FixedStat_as_root(buffer));
+    t = ns(FixedStat_test(stat));
+    /* Fixed fields are stored even when they hold the default value. */
+    if (strcmp(ns(FixedStat_id(stat)), "fixed") || ns(FixedStat_val(stat)) != -42
+            || !ns(FixedStat_count_is_present(stat)) || ns(FixedStat_count(stat)) != 0
+            || !ns(FixedStat_color_is_present(stat)) || ns(FixedStat_color(stat)) != ns(Color_Blue)
+            || ns(FixedStat_note_is_present(stat)) || !t
+            || ns(Test_a(t)) != 7 || ns(Test_b(t)) != -3) {
+        printf("fixed table not valid\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+int test_create_rows(flatcc_builder_t *B)
+{
+    ns(Monster_row_t) rows[4];
+    uint32_t present[4][ns(Monster_row_present_words)];
+    ns(Monster_vec_ref_t) vec;
+    ns(Monster_table_t) mon, sub;
+    ns(Monster_vec_t) mv;
+    const char *names[4] = { "a", "b", "c", "d" };
+    void *buffer;
+    size_t size, i;
+    int ret;
+
+    flatcc_builder_reset(B);
+    memset(rows, 0, sizeof(rows));
+    memset(present, 0, sizeof(present));
+    ns(Monster_start_as_root(B));
+    for (i = 0; i < 4; ++i) {
+        rows[i].name = flatbuffers_string_create_str(B, names[i]);
+        rows[i].hp = (int16_t)(10 * i);
+        rows[i].color = ns(Color_Red);
+        /* id 3: name, id 2: hp, id 6: color. */
+        flatcc_builder_row_set_present(present[i], 3);
+        flatcc_builder_row_set_present(present[i], 2);
+        /* The last two rows share a second shape. */
+        if (i >= 2) {
+            flatcc_builder_row_set_present(present[i], 6);
+        }
+    }
+    vec = ns(Monster_vec_create_rows(B, rows, present[0], 4));
+    if (!vec) {
+        printf("row vector construction failed\n");
+        return -1;
+    }
+    ns(Monster_testarrayoftables_add(B, vec));
+    ns(Monster_name_create_str(B, "MyMonster"));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+    if ((ret = ns(Monster_verify_as_root(buffer, size)))) {
+        printf("row vector failed to verify, got: %s\n", flatcc_verify_error_string(ret));
+        flatcc_builder_aligned_free(buffer);
+        return -1;
+    }
+    ret = -1;
+    mon = ns(Monster_as_root(buffer));
+    mv = ns(Monster_testarrayoftables(mon));
+    if (ns(Monster_vec_len(mv)) != 4) {
+        printf("row vector has wrong length\n");
+        goto done;
+    }
+    for (i = 0; i < 4; ++i) {
+        sub = ns(Monster_vec_at(mv, i));
+        /* Present fields are stored even when equal to default. */
+        if (strcmp(ns(Monster_name(sub)), names[i]) || ns(Monster_hp(sub)) != (int16_t)(10 * i)
+                || !ns(Monster_hp_is_present(sub)) || ns(Monster_mana_is_present(sub))
+                || ns(Monster_color_is_present(sub)) != (i >= 2)
+                || ns(Monster_color(sub)) != (i >= 2 ? ns(Color_Red) : ns(Color_Blue))) {
+            printf("row table %d not valid\n", (int)i);
+            goto done;
+        }
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+static int gen_rollback_monster(flatcc_builder_t *B, int rollback)
+{
+    static char big[20000];
+    flatcc_builder_checkpoint_t cp;
+    flatbuffers_string_ref_t name;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_inventory_start(B));
+    ns(Monster_inventory_push_create(B, 1));
+    if (rollback) {
+        flatcc_builder_checkpoint(B, &cp);
+        ns(Monster_inventory_push_create(B, 2));
+        ns(Monster_inventory_push_create(B, 3));
+        if (flatcc_builder_rollback(B, &cp)) {
+            return -1;
+        }
+    }
+    ns(Monster_inventory_push_create(B, 4));
+    ns(Monster_inventory_end(B));
+    if (rollback) {
+        flatcc_builder_checkpoint(B, &cp);
+        ns(Monster_hp_add(B, 10));
+        name = flatbuffers_string_create_str(B, "discarded");
+        /* The vtable is emitted after the checkpoint, but cached. */
+        ns(Monster_testempty_add(B, ns(Stat_create(B, name, 1, 0))));
+        ns(Monster_testarrayofstring_start(B));
+        ns(Monster_testarrayofstring_push_create_str(B, "discarded"));
+        /* Spans several emitter pages. */
+        ns(Monster_testarrayofstring_push_create(B, big, sizeof(big)));
+        ns(Monster_testarrayofstring_end(B));
+        if (flatcc_builder_rollback(B, &cp)) {
+            return -1;
+        }
+    }
+    name = flatbuffers_string_create_str(B, "kept");
+    ns(Monster_testempty_add(B, ns(Stat_create(B, name, 2, 0))));
+    ns(Monster_name_create_str(B, "MyMonster"));
+    ns(Monster_hp_add(B, 80));
+    ns(Monster_end_as_root(B));
+    return 0;
+}
+
+int test_rollback(flatcc_builder_t *B)
+{
+    void *buffer = 0, *expected = 0;
+    size_t size, expected_size;
+    int ret = -1;
+
+    if (gen_rollback_monster(B, 0) || !(expected = flatcc_builder_finalize_aligned_buffer(B, &expected_size))) {
+        goto done;
+    }
+    if (gen_rollback_monster(B, 1)) {
+        printf("rollback failed\n");
+        goto done;
+    }
+    if (!(buffer = flatcc_builder_finalize_aligned_buffer(B, &size))) {
+        goto done;
+    }
+    if (size != expected_size || memcmp(buffer, expected, size)) {
+        hexdump("expected", expected, expected_size, stderr);
+        hexdump("rolled back", buffer, size, stderr);
+        printf("rolled back buffer differs\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    flatcc_builder_aligned_free(expected);
+    return ret;
+}
+
 int test_cloned_monster(flatcc_builder_t *B)
 {
     void *buffer;
@@ -986,6 +1412,573 @@ int test_cloned_monster(flatcc_builder_t *B)
     return ret;
 }
 
+/*
+ * Each level references the level below twice, so verifying without
+ * a memo would visit 2^40 tables.
+ */
+int test_verify_with_memo(flatcc_builder_t *B)
+{
+    flatcc_verifier_memo_t memo;
+    ns(Monster_ref_t) ref;
+    flatbuffers_string_vec_ref_t strings;
+    ns(Monster_table_t) mon;
+    void *buffer;
+    size_t size;
+    int i, depth = 0, ret = -1;
+
+    flatcc_verifier_memo_init(&memo);
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    flatbuffers_string_vec_start(B);
+    flatbuffers_string_vec_push(B, flatbuffers_string_create_str(B, "shared"));
+    strings = flatbuffers_string_vec_end(B);
+    ns(Monster_start(B));
+    ns(Monster_name_create_str(B, "leaf"));
+    ref = ns(Monster_end(B));
+    for (i = 0; i < 40; ++i) {
+        ns(Monster_start(B));
+        ns(Monster_name_create_str(B, "node"));
+        ns(Monster_testarrayofstring_add(B, strings));
+        ns(Monster_testarrayoftables_start(B));
+        ns(Monster_testarrayoftables_push(B, ref));
+        ns(Monster_testarrayoftables_push(B, ref));
+        ns(Monster_testarrayoftables_end(B));
+        ref = ns(Monster_end(B));
+    }
+    ns(Monster_name_create_str(B, "root"));
+    ns(Monster_testarrayoftables_start(B));
+    ns(Monster_testarrayoftables_push(B, ref));
+    ns(Monster_testarrayoftables_push(B, ref));
+    ns(Monster_testarrayoftables_end(B));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+
+    /* Verify twice to check that the memo is reset between buffers. */
+    for (i = 0; i < 2; ++i) {
+        if ((ret = ns(Monster_verify_as_root_with_memo(buffer, size, &memo)))) {
+            printf("memoized verify failed, got: %s\n", flatcc_verify_error_string(ret));
+            goto done;
+        }
+    }
+    ret = -1;
+    mon = ns(Monster_as_root(buffer));
+    for (depth = 0; ns(Monster_testarrayoftables_is_present(mon)); ++depth) {
+        mon = ns(Monster_vec_at(ns(Monster_testarrayoftables(mon)), 1));
+    }
+    if (depth != 41 || strcmp(ns(Monster_name(mon)), "leaf")) {
+        printf("unexpected memoized monster depth %d\n", depth);
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_verifier_memo_clear(&memo);
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+/* Nested beyond the recursive verifiers max nesting level. */
+int test_verify_iterative(flatcc_builder_t *B)
+{
+    flatcc_verifier_memo_t memo;
+    ns(Monster_ref_t) ref;
+    void *buffer;
+    size_t size;
+    int i, ret = -1;
+
+    flatcc_verifier_memo_init(&memo);
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_start(B));
+    ns(Monster_name_create_str(B, "leaf"));
+    ref = ns(Monster_end(B));
+    for (i = 0; i < 1000; ++i) {
+        ns(Monster_start(B));
+        ns(Monster_name_create_str(B, "node"));
+        if (i % 2) {
+            ns(Monster_enemy_add(B, ref));
+        } else {
+            ns(Monster_testarrayoftables_start(B));
+            ns(Monster_testarrayoftables_push(B, ref));
+            ns(Monster_testarrayoftables_end(B));
+        }
+        ref = ns(Monster_end(B));
+    }
+    ns(Monster_name_create_str(B, "root"));
+    ns(Monster_enemy_add(B, ref));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+
+    if (flatcc_verify_ok == ns(Monster_verify_as_root(buffer, size))) {
+        printf("deep monster should exceed the max nesting level\n");
+        goto done;
+    }
+    if ((ret = flatcc_verify_table_as_root_iterative(buffer, size, ns(Monster_identifier),
+            ns(Monster_table_verifier_type()), &memo))) {
+        printf("deep monster failed to verify iteratively, got: %s\n", flatcc_verify_error_string(ret));
+        goto done;
+    }
+    ret = -1;
+    if (flatcc_verify_ok == ns(Monster_verify_as_root_iterative(buffer, size - 8))) {
+        printf("truncated deep monster should not verify\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_verifier_memo_clear(&memo);
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+/*
+ * Both vectors point to the same vector of Stat tables. Stat verifies,
+ * but the elements do not have the required Monster name, so the memo
+ * must not let the second field pass as already verified.
+ */
+int test_verify_iterative_shared_vector(flatcc_builder_t *B)
+{
+    flatcc_verifier_memo_t memo;
+    ns(Stat_vec_ref_t) stats;
+    void *buffer;
+    size_t size;
+    int ret = -1;
+
+    flatcc_verifier_memo_init(&memo);
+    flatcc_builder_reset(B);
+    ns(SharedVectors_start_as_root(B));
+    ns(Stat_vec_start(B));
+    ns(Stat_vec_push_start(B));
+    ns(Stat_val_add(B, 42));
+    ns(Stat_vec_push_end(B));
+    stats = ns(Stat_vec_end(B));
+    ns(SharedVectors_stats_add(B, stats));
+    ns(SharedVectors_monsters_add(B, (ns(Monster_vec_ref_t))stats));
+    ns(SharedVectors_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+
+    if (flatcc_verify_ok == ns(SharedVectors_verify_as_root(buffer, size))) {
+        printf("shared vector should not verify as a vector of monsters\n");
+        goto done;
+    }
+    if (flatcc_verify_ok == flatcc_verify_table_as_root_iterative(buffer, size, 0,
+            ns(SharedVectors_table_verifier_type()), &memo)) {
+        printf("shared vector should not verify iteratively with a memo\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_verifier_memo_clear(&memo);
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+/* Large enough to be split into several chunks. */
+int test_verify_parallel(flatcc_builder_t *B)
+{
+    flatcc_verifier_threads_t threads = { 4 };
+    ns(Monster_table_t) mon;
+    flatbuffers_string_t str;
+    void *buffer;
+    size_t size;
+    char name[20];
+    int i, n = 10000, ret = -1;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "root"));
+    ns(Monster_testarrayofstring_start(B));
+    for (i = 0; i < n; ++i) {
+        sprintf(name, "string%d", i);
+        ns(Monster_testarrayofstring_push_create_str(B, name));
+    }
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_testarrayoftables_start(B));
+    for (i = 0; i < n; ++i) {
+        sprintf(name, "monster%d", i);
+        ns(Monster_testarrayoftables_push_start(B));
+        ns(Monster_name_create_str(B, name));
+        ns(Monster_hp_add(B, (int16_t)i));
+        ns(Monster_testarrayoftables_push_end(B));
+    }
+    ns(Monster_testarrayoftables_end(B));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+
+    if ((ret = ns(Monster_verify_as_root_parallel(buffer, size, flatcc_verifier_parallel_for_threads, &threads)))) {
+        printf("large monster failed to verify in parallel, got: %s\n", flatcc_verify_error_string(ret));
+        goto done;
+    }
+    if ((ret = ns(Monster_verify_as_root_parallel(buffer, size, 0, 0)))) {
+        printf("large monster failed to verify in chunks, got: %s\n", flatcc_verify_error_string(ret));
+        goto done;
+    }
+    ret = -1;
+    if (flatcc_verify_ok == ns(Monster_verify_as_root_parallel(buffer, size - 8, flatcc_verifier_parallel_for_threads, &threads))) {
+        printf("truncated large monster should not verify\n");
+        goto done;
+    }
+    /* Break strings in two different chunks, the first must be reported. */
+    mon = ns(Monster_as_root(buffer));
+    str = flatbuffers_string_vec_at(ns(Monster_testarrayofstring(mon)), (size_t)n - 1);
+    ((flatbuffers_uoffset_t *)str)[-1] = 0xffffff;
+    str = flatbuffers_string_vec_at(ns(Monster_testarrayofstring(mon)), 5000);
+    ((flatbuffers_uoffset_t *)str)[-1] -= 1;
+    for (i = 0; i < 10; ++i) {
+        ret = ns(Monster_verify_as_root_parallel(buffer, size, flatcc_verifier_parallel_for_threads, &threads));
+        if (ret != flatcc_verify_error_string_not_zero_terminated) {
+            printf("broken large monster should fail on the first broken string, got: %s\n", flatcc_verify_error_string(ret));
+            ret = -1;
+            goto done;
+        }
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+/* Only the tables and strings the reader asks for are verified. */
+int test_verify_lazy(flatcc_builder_t *B)
+{
+    flatcc_lazy_verifier_t L;
+    ns(Monster_table_t) mon, enemy;
+    ns(Monster_vec_t) mons;
+    flatbuffers_string_vec_t strings;
+    void *buffer;
+    size_t size, i;
+    int ret = -1;
+
+    flatcc_lazy_verifier_init(&L);
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "root"));
+    ns(Monster_enemy_start(B));
+    ns(Monster_name_create_str(B, "enemy"));
+    ns(Monster_enemy_end(B));
+    ns(Monster_testarrayoftables_start(B));
+    ns(Monster_testarrayoftables_push_start(B));
+    ns(Monster_name_create_str(B, "first"));
+    ns(Monster_testarrayoftables_push_end(B));
+    ns(Monster_testarrayoftables_push_start(B));
+    ns(Monster_name_create_str(B, "second"));
+    ns(Monster_testarrayoftables_push_end(B));
+    ns(Monster_testarrayoftables_end(B));
+    ns(Monster_testarrayofstring_start(B));
+    ns(Monster_testarrayofstring_push_create_str(B, "one"));
+    ns(Monster_testarrayofstring_push_create_str(B, "two"));
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+
+    mon = ns(Monster_as_root(buffer));
+    enemy = ns(Monster_enemy(mon));
+    mons = ns(Monster_testarrayoftables(mon));
+    strings = ns(Monster_testarrayofstring(mon));
+    if ((ret = ns(Monster_lazy_verify_as_root(&L, buffer, size)))) {
+        printf("lazy verify of root failed, got: %s\n", flatcc_verify_error_string(ret));
+        goto done;
+    }
+    for (i = 0; i < 2; ++i) {
+        ret |= ns(Monster_lazy_verify(&L, enemy));
+        ret |= ns(Monster_lazy_verify(&L, ns(Monster_vec_at(mons, i))));
+        ret |= flatcc_lazy_verify_string(&L, flatbuffers_string_vec_at(strings, i));
+        ret |= ns(Stat_lazy_verify(&L, ns(Monster_testempty(mon))));
+    }
+    if (ret) {
+        printf("lazy verify of valid tables or strings failed\n");
+        goto done;
+    }
+
+    /* A broken enemy is only noticed when the reader asks for it. */
+    *(flatbuffers_soffset_t *)enemy = (flatbuffers_soffset_t)(-(int32_t)size);
+    ret = -1;
+    if (ns(Monster_verify_as_root(buffer, size)) == flatcc_verify_ok) {
+        printf("monster with broken enemy should not verify\n");
+        goto done;
+    }
+    if (ns(Monster_lazy_verify_as_root(&L, buffer, size)) ||
+            ns(Monster_lazy_verify(&L, ns(Monster_vec_at(mons, 0))))) {
+        printf("lazy verify should not check the broken enemy up front\n");
+        goto done;
+    }
+    if (ns(Monster_lazy_verify(&L, enemy)) != flatcc_verify_error_vtable_header_out_of_range) {
+        printf("lazy verify of broken enemy should fail\n");
+        goto done;
+    }
+    if (ns(Monster_lazy_verify(&L, ns(Monster_vec_at(mons, 1)))) == flatcc_verify_ok) {
+        printf("lazy verify should keep failing after an error\n");
+        goto done;
+    }
+    ((flatbuffers_uoffset_t *)flatbuffers_string_vec_at(strings, 1))[-1] = (flatbuffers_uoffset_t)size;
+    if (ns(Monster_lazy_verify_as_root(&L, buffer, size)) ||
+            flatcc_lazy_verify_string(&L, flatbuffers_string_vec_at(strings, 0)) ||
+            flatcc_lazy_verify_string(&L, flatbuffers_string_vec_at(strings, 1)) != flatcc_verify_error_string_out_of_range) {
+        printf("lazy verify of broken string should fail\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_lazy_verifier_clear(&L);
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+int test_verify_stats(flatcc_builder_t *B)
+{
+    flatcc_verifier_stats_t stats;
+    flatbuffers_uoffset_t *strings, offset;
+    void *buffer;
+    size_t size;
+    int ret = -1;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "root"));
+    ns(Monster_enemy_start(B));
+    ns(Monster_name_create_str(B, "enemy"));
+    ns(Monster_enemy_end(B));
+    ns(Monster_testarrayoftables_start(B));
+    ns(Monster_testarrayoftables_push_start(B));
+    ns(Monster_name_create_str(B, "first"));
+    ns(Monster_testarrayoftables_push_end(B));
+    ns(Monster_testarrayoftables_push_start(B));
+    ns(Monster_name_create_str(B, "second"));
+    ns(Monster_testarrayoftables_push_end(B));
+    ns(Monster_testarrayoftables_end(B));
+    ns(Monster_testarrayofstring_start(B));
+    ns(Monster_testarrayofstring_push_create_str(B, "one"));
+    ns(Monster_testarrayofstring_push_create_str(B, "two"));
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+
+    if ((ret = ns(Monster_verify_as_root_with_stats(buffer, size, &stats)))) {
+        printf("verify with stats failed, got: %s\n", flatcc_verify_error_string(ret));
+        goto done;
+    }
+    ret = -1;
+#if FLATCC_VERIFIER_STATS
+    /* Tables in a vector are one level below the vector. */
+    if (stats.tables != 4 || stats.vtables != 4 || stats.vectors != 2 ||
+            stats.strings != 6 || stats.max_depth != 3 || stats.bytes == 0 || stats.seconds < 0) {
+        printf("unexpected verifier stats: %d tables, %d vtables, %d vectors, %d strings, %d bytes, depth %d\n",
+                (int)stats.tables, (int)stats.vtables, (int)stats.vectors,
+                (int)stats.strings, (int)stats.bytes, stats.max_depth);
+        goto done;
+    }
+#else
+    if (stats.tables || stats.vtables || stats.vectors || stats.strings || stats.bytes || stats.max_depth) {
+        printf("verifier stats should be zero when not enabled\n");
+        goto done;
+    }
+#endif
+    /* Strings are only counted once verified, so a bad element must not be followed. */
+    strings = (flatbuffers_uoffset_t *)ns(Monster_testarrayofstring(ns(Monster_as_root(buffer))));
+    offset = strings[1];
+    strings[1] = (flatbuffers_uoffset_t)0x7ffffff0;
+    if (ns(Monster_verify_as_root_with_stats(buffer, size, &stats)) == flatcc_verify_ok) {
+        printf("verify with stats of broken string vector element should fail\n");
+        goto done;
+    }
+    strings[1] = offset;
+    ((flatbuffers_uoffset_t *)ns(Monster_name(ns(Monster_as_root(buffer)))))[-1] = (flatbuffers_uoffset_t)size;
+    if (ns(Monster_verify_as_root_with_stats(buffer, size, &stats)) != flatcc_verify_error_string_out_of_range) {
+        printf("verify with stats of broken name should fail\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+int test_verify_index(flatcc_builder_t *B)
+{
+    flatbuffers_voffset_t fields[3][ns(Monster_field_count)];
+    flatcc_table_index_t index[3];
+    ns(Monster_table_t) mon;
+    void *buffer;
+    size_t size, i;
+    int ret = -1;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "root"));
+    ns(Monster_hp_add(B, 80));
+    ns(Monster_pos_create(B, 1, 2, 3, 0, 0, 0, 0));
+    ns(Monster_enemy_start(B));
+    ns(Monster_name_create_str(B, "enemy"));
+    ns(Monster_hp_add(B, 20));
+    ns(Monster_enemy_end(B));
+    ns(Monster_testarrayofstring_start(B));
+    ns(Monster_testarrayofstring_push_create_str(B, "one"));
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+
+    for (i = 0; i < 3; ++i) {
+        index[i].fields = fields[i];
+        index[i].field_count = ns(Monster_field_count);
+        index[i].parent = i ? &index[i - 1] : 0;
+        index[i].id = ns(Monster_enemy_field_id);
+    }
+    if ((ret = ns(Monster_verify_as_root_with_index(buffer, size, index, 3)))) {
+        printf("verify with index failed, got: %s\n", flatcc_verify_error_string(ret));
+        goto done;
+    }
+    ret = -1;
+    mon = ns(Monster_as_root(buffer));
+    if (index[0].table != mon || index[1].table != ns(Monster_enemy(mon)) || index[2].table != 0) {
+        printf("verify with index recorded the wrong tables\n");
+        goto done;
+    }
+    if (strcmp(ns(Monster_name_indexed(&index[0])), "root") ||
+            ns(Monster_hp_indexed(&index[0])) != 80 ||
+            ns(Vec3_x(ns(Monster_pos_indexed(&index[0])))) != 1 ||
+            flatbuffers_string_vec_len(ns(Monster_testarrayofstring_indexed(&index[0]))) != 1 ||
+            ns(Monster_enemy_indexed(&index[0])) != index[1].table ||
+            strcmp(ns(Monster_name_indexed(&index[1])), "enemy") ||
+            ns(Monster_hp_indexed(&index[1])) != 20 ||
+            ns(Monster_pos_indexed(&index[1])) != 0 ||
+            ns(Monster_mana_indexed(&index[1])) != 150) {
+        printf("indexed reads do not match the buffer\n");
+        goto done;
+    }
+    ((flatbuffers_uoffset_t *)ns(Monster_name(ns(Monster_enemy(mon)))))[-1] = (flatbuffers_uoffset_t)size;
+    if (ns(Monster_verify_as_root_with_index(buffer, size, index, 3)) != flatcc_verify_error_string_out_of_range) {
+        printf("verify with index of broken enemy name should fail\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+int test_verify_stream(flatcc_builder_t *B)
+{
+    flatcc_verifier_stream_t S;
+    flatcc_verifier_threads_t threads = { 4 };
+    void *buffer;
+    uint8_t *stream = 0;
+    size_t size, consumed, len = 0, off[3];
+    int i, pass, ret = -1;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root_with_size(B));
+    ns(Monster_name_create_str(B, "record"));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+    if ((ret = ns(Monster_verify_as_root_with_size(buffer, size)))) {
+        printf("size prefixed monster failed to verify with identifier, got: %s\n", flatcc_verify_error_string(ret));
+        goto done;
+    }
+    ret = -1;
+    /* Three records with a broken string in the middle, then a truncated record. */
+    if (!(stream = flatcc_builder_aligned_alloc(16, 3 * size + 8))) {
+        goto done;
+    }
+    for (i = 0; i < 3; ++i) {
+        off[i] = len;
+        memcpy(stream + len, buffer, size);
+        len += size;
+    }
+    memcpy(stream + len, buffer, 8);
+    len += 8;
+    ((flatbuffers_uoffset_t *)ns(Monster_name(ns(Monster_as_root(stream + off[1] + sizeof(flatbuffers_uoffset_t))))))[-1] =
+        (flatbuffers_uoffset_t)size;
+
+    ns(Monster_verifier_stream_init(&S));
+    for (pass = 0; pass < 2; ++pass) {
+        if (pass == 0) {
+            ret = flatcc_verify_stream(&S, stream, len);
+        } else {
+            /* In two chunks, splitting the second record, and in parallel. */
+            S.parallel_for = flatcc_verifier_parallel_for_threads;
+            S.pool = &threads;
+            ret = flatcc_verify_stream_chunk(&S, stream, size + size / 2, &consumed);
+            ret |= consumed != size;
+            ret |= flatcc_verify_stream(&S, stream + consumed, len - consumed);
+        }
+        if (ret || S.offset != len || S.record_count != 2 || S.error_count != 2 ||
+                S.records[0] != off[0] || S.records[1] != off[2] ||
+                S.errors[0].offset != off[1] || S.errors[0].error != flatcc_verify_error_string_out_of_range ||
+                S.errors[1].offset != len - 8 ||
+                S.errors[1].error != flatcc_verify_error_runtime_buffer_size_less_than_size_field) {
+            printf("unexpected stream verification result in pass %d\n", pass);
+            ret = -1;
+            break;
+        }
+        flatcc_verifier_stream_clear(&S);
+    }
+    flatcc_verifier_stream_clear(&S);
+done:
+    flatcc_builder_aligned_free(stream);
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+int test_verify_strings(flatcc_builder_t *B)
+{
+    static const struct { const char *s; int valid; } utf8[] = {
+        { "", 1 }, { "plain ascii text that spans several blocks of 32 bytes", 1 },
+        { "\xc3\xa6\xc3\xb8\xc3\xa5", 1 }, { "\xe2\x82\xac", 1 }, { "\xf0\x9f\x98\x80", 1 },
+        { "\xf4\x8f\xbf\xbf", 1 }, { "\xed\x9f\xbf", 1 },
+        { "\x80", 0 }, { "\xc0\xaf", 0 }, { "\xc1\xbf", 0 }, { "\xc3", 0 },
+        { "\xe0\x9f\xbf", 0 }, { "\xed\xa0\x80", 0 }, { "\xe2\x82", 0 },
+        { "\xf0\x8f\xbf\xbf", 0 }, { "\xf4\x90\x80\x80", 0 }, { "\xf5\x80\x80\x80", 0 },
+        { "a long ascii prefix before the invalid byte at the end \xff", 0 },
+    };
+    ns(Monster_table_t) mon;
+    flatbuffers_string_t str;
+    void *buffer;
+    size_t size;
+    char name[20];
+    int i, ret = -1;
+
+    for (i = 0; i < (int)(sizeof(utf8) / sizeof(utf8[0])); ++i) {
+        if (flatcc_verify_utf8(utf8[i].s, strlen(utf8[i].s)) != utf8[i].valid) {
+            printf("unexpected UTF-8 verification of string %d\n", i);
+            return -1;
+        }
+    }
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "\xc3\x28"));
+    ns(Monster_testarrayofstring_start(B));
+    for (i = 0; i < 40; ++i) {
+        sprintf(name, "string%d", i);
+        ns(Monster_testarrayofstring_push_create_str(B, name));
+    }
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+
+    ret = ns(Monster_verify_as_root(buffer, size));
+    if (ret != (FLATCC_VERIFIER_UTF8 ? flatcc_verify_error_string_not_utf8 : flatcc_verify_ok)) {
+        printf("unexpected verification of monster with invalid UTF-8 name, got: %s\n", flatcc_verify_error_string(ret));
+        ret = -1;
+        goto done;
+    }
+    /* The first broken string in a vector is reported, also when strings are checked in runs. */
+    mon = ns(Monster_as_root(buffer));
+    ((char *)ns(Monster_name(mon)))[0] = 'x';
+    str = flatbuffers_string_vec_at(ns(Monster_testarrayofstring(mon)), 30);
+    ((flatbuffers_uoffset_t *)str)[-1] = 0xffffff;
+    str = flatbuffers_string_vec_at(ns(Monster_testarrayofstring(mon)), 20);
+    ((flatbuffers_uoffset_t *)str)[-1] -= 1;
+    ret = ns(Monster_verify_as_root(buffer, size));
+    if (ret != flatcc_verify_error_string_not_zero_terminated) {
+        printf("broken string vector should fail on the first broken string, got: %s\n", flatcc_verify_error_string(ret));
+        ret = -1;
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
 int test_string(flatcc_builder_t *B)
 {
     ns(Monster_table_t) mon;
@@ -1706,6 +2699,10 @@ int verify_union_vector(void *buffer, size_t size)
         printf("Monster buffer with union vector failed to verify, got: %s\n", flatcc_verify_error_string(ret));
         goto failed;
     }
+    if ((ret = ns(Monster_verify_as_root_iterative(buffer, size)))) {
+        printf("Monster buffer with union vector failed to verify iteratively, got: %s\n", flatcc_verify_error_string(ret));
+        goto failed;
+    }
 
     mon = ns(Monster_as_root(buffer));
     if (ns(Monster_test_type(mon)) != ns(Any_Alt)) {
@@ -2354,6 +3351,7 @@ int test_nested_buffer(flatcc_builder_t *B)
 {
     void *buffer;
     size_t size;
+    int ret;
     ns(Monster_table_t) mon, nested;
 
     flatcc_builder_reset(B);
@@ -2373,6 +3371,10 @@ int test_nested_buffer(flatcc_builder_t *B)
 
     buffer = flatcc_builder_get_direct_buffer(B, &size);
     hexdump("nested flatbuffer", buffer, size, stderr);
+    if ((ret = ns(Monster_verify_as_root_iterative(buffer, size)))) {
+        printf("nested flatbuffer failed to verify iteratively, got: %s\n", flatcc_verify_error_string(ret));
+        return -1;
+    }
 
     mon = ns(Monster_as_root(buffer));
     if (strcmp(ns(Monster_name(mon)), "MyMonster")) {
@@ -2873,12 +3875,102 @@ int main(int argc, char *argv[])
         return -1;
     }
 #endif
+#if 1
+    if (test_arena_monster()) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_builder_pool()) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_vtable_dict()) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_create_fixed(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_create_rows(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_rollback(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
 #if 1
     if (test_cloned_monster(B)) {
         printf("TEST FAILED\n");
         return -1;
     }
 #endif
+#if 1
+    if (test_verify_with_memo(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_verify_iterative(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_verify_iterative_shared_vector(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_verify_parallel(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_verify_strings(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_verify_lazy(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_verify_stats(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_verify_index(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_verify_stream(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
 #if 1
     if (verify_include(B)) {
         printf("TEST FAILED\n");
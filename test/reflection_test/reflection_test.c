@@ -1,6 +1,9 @@
 #include "flatcc/support/readfile.h"
 #include "flatcc/reflection/reflection_reader.h"
+#include "flatcc/flatcc_bfbs_verifier.h"
 #include "flatcc/portable/pcrt.h"
+#include "monster_test_builder.h"
+#include "monster_test_verifier.h"
 
 /* -DFLATCC_PORTABLE may help if inttypes.h is missing. */
 #ifndef PRId64
@@ -172,6 +175,113 @@ done:
     return ret;
 }
 
+#undef ns
+#define ns(x) FLATBUFFERS_WRAP_NAMESPACE(MyGame_Example, x)
+
+/*
+ * The binary schema verifier must agree with the generated verifier,
+ * also on the error reported for any corruption of a single byte.
+ */
+int test_bfbs_verifier(const char *monster_bfbs)
+{
+    flatcc_builder_t builder, *B = &builder;
+    flatcc_bfbs_verifier_t V;
+    ns(Monster_ref_t) ref;
+    void *bfbs = 0, *buffer = 0, *nested;
+    uint8_t *p, c;
+    size_t bfbs_size, size, nested_size, i;
+    int ret = -1, ret2;
+
+    memset(&V, 0, sizeof(V));
+    flatcc_builder_init(B);
+    bfbs = readfile(monster_bfbs, 100000, &bfbs_size);
+    if (!bfbs || flatcc_bfbs_verifier_init(&V, bfbs, bfbs_size)) {
+        printf("failed to compile binary schema\n");
+        goto done;
+    }
+    /* The schema is not needed after compilation. */
+    free(bfbs);
+    bfbs = 0;
+
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "nested"));
+    ns(Monster_end_as_root(B));
+    nested = flatcc_builder_finalize_aligned_buffer(B, &nested_size);
+    flatcc_builder_reset(B);
+
+    ns(Monster_start_as_root(B));
+    ns(Monster_start(B));
+    ns(Monster_name_create_str(B, "member"));
+    ref = ns(Monster_end(B));
+    ns(Monster_test_Monster_add(B, ref));
+    ns(Monster_pos_create(B, 1, 2, 3, 0, ns(Color_Red), 1, 2));
+    ns(Monster_name_create_str(B, "root"));
+    ns(Monster_inventory_create(B, (const uint8_t *)"\1\2\3", 3));
+    ns(Monster_test4_start(B));
+    ns(Monster_test4_push_create(B, 1, 2));
+    ns(Monster_test4_push_create(B, 3, 4));
+    ns(Monster_test4_end(B));
+    ns(Monster_testarrayofstring_start(B));
+    ns(Monster_testarrayofstring_push_create_str(B, "one"));
+    ns(Monster_testarrayofstring_push_create_str(B, "two"));
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_testarrayoftables_start(B));
+    ns(Monster_testarrayoftables_push_start(B));
+    ns(Monster_name_create_str(B, "element"));
+    ns(Monster_testarrayoftables_push_end(B));
+    ns(Monster_testarrayoftables_end(B));
+    ns(Monster_enemy_start(B));
+    ns(Monster_name_create_str(B, "enemy"));
+    ns(Monster_enemy_end(B));
+    ns(Monster_testnestedflatbuffer_create(B, nested, nested_size));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+    flatcc_builder_aligned_free(nested);
+
+    if ((ret2 = flatcc_bfbs_verify_as_root(&V, buffer, size, 0))) {
+        printf("binary schema verifier failed on root type: %s\n", flatcc_verify_error_string(ret2));
+        goto done;
+    }
+    if ((ret2 = flatcc_bfbs_verify_as_root(&V, buffer, size, "MyGame.Example.Monster"))) {
+        printf("binary schema verifier failed on named type: %s\n", flatcc_verify_error_string(ret2));
+        goto done;
+    }
+    if (flatcc_bfbs_verify_as_root(&V, buffer, size, "MyGame.Example.Nothing") !=
+            flatcc_verify_error_runtime_schema_type_not_found) {
+        printf("binary schema verifier should not find unknown type\n");
+        goto done;
+    }
+    if (flatcc_bfbs_verifier_table_type(&V, "MyGame.Example.Vec3")) {
+        printf("binary schema verifier should not return struct as table\n");
+        goto done;
+    }
+    if (flatcc_bfbs_verify_as_root(&V, buffer, size / 2, 0) == flatcc_verify_ok) {
+        printf("binary schema verifier accepted truncated buffer\n");
+        goto done;
+    }
+    p = buffer;
+    for (i = 0; i < size; ++i) {
+        c = p[i];
+        p[i] = (uint8_t)(c ^ 0x41);
+        ret2 = flatcc_bfbs_verify_as_root(&V, buffer, size, 0);
+        if (ret2 != ns(Monster_verify_as_root_iterative(buffer, size))) {
+            printf("binary schema verifier disagrees with generated verifier at offset %d: %s\n",
+                    (int)i, flatcc_verify_error_string(ret2));
+            goto done;
+        }
+        p[i] = c;
+    }
+    ret = 0;
+done:
+    if (bfbs) {
+        free(bfbs);
+    }
+    flatcc_bfbs_verifier_clear(&V);
+    flatcc_builder_aligned_free(buffer);
+    flatcc_builder_clear(B);
+    return ret;
+}
+
 /* We take arguments so test can run without copying sources. */
 #define usage \
 "wrong number of arguments:\n" \
@@ -192,5 +302,8 @@ int main(int argc, char *argv[])
         filename = argv[1];
     }
 
-    return test_schema(filename);
+    if (test_schema(filename)) {
+        return -1;
+    }
+    return test_bfbs_verifier(filename);
 }